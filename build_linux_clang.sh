@@ -1,2 +1,4 @@
 #!/bin/bash
-clang -O3 -o ofd entry_point.c
\ No newline at end of file
+clang -O3 -pthread -o ofd entry_point.c
+clang -O3 -pthread -o highlighter_benchmark highlighter_benchmark.c
+clang -O3 -pthread -o markdown_benchmark markdown_benchmark.c
\ No newline at end of file
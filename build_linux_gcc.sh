@@ -1,2 +1,4 @@
 #!/bin/bash
-gcc -O3 -o ofd entry_point.c
\ No newline at end of file
+gcc -O3 -pthread -o ofd entry_point.c
+gcc -O3 -pthread -o highlighter_benchmark highlighter_benchmark.c
+gcc -O3 -pthread -o markdown_benchmark markdown_benchmark.c
\ No newline at end of file
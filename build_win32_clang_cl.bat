@@ -1,2 +1,4 @@
 @echo off
-clang-cl /O2 /TC /Feofd.exe entry_point.c
\ No newline at end of file
+clang-cl /O2 /TC /Feofd.exe entry_point.c
+clang-cl /O2 /TC /Fehighlighter_benchmark.exe highlighter_benchmark.c
+clang-cl /O2 /TC /Femarkdown_benchmark.exe markdown_benchmark.c
\ No newline at end of file
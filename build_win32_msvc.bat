@@ -1,3 +1,5 @@
 @echo off
 cl /O2 /TC /Feofd.exe entry_point.c
+cl /O2 /TC /Fehighlighter_benchmark.exe highlighter_benchmark.c
+cl /O2 /TC /Femarkdown_benchmark.exe markdown_benchmark.c
 del *.obj > NUL 2> NUL
\ No newline at end of file
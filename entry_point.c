@@ -15,6 +15,7 @@
 #include "stb_sprintf.h"
 
 #define ofd_sprintf stbsp_sprintf
+#define OFD_ALLOCATION_STATS // Allocations show up in -stats, they are only counted while stats are on.
 #define OFD_IMPLEMENTATION
 #include "ofd.h"
 
@@ -41,6 +42,15 @@ typedef uint32_t u32;
 #include <sys/types.h>
 #include <dirent.h>
 #include <unistd.h>
+
+#ifdef __linux__
+#define OFD_OS_LINUX // -watch uses inotify.
+
+#include <sys/inotify.h>
+#include <poll.h>
+#include <signal.h>
+#include <errno.h>
+#endif // __linux__
 #endif // OFD_OS_WINDOWS
 
 
@@ -391,6 +401,8 @@ Ofd_Array ofd_os_list_markdown_files(char* directory_path)
         
         ofd_put_last_file_in_the_right_place(&files);
     }
+    
+    closedir(directory);
     #endif
     
     
@@ -417,6 +429,198 @@ ofd_b8 ofd_os_file_exists(char* filepath)
 }
 
 
+void ofd_print_stats(Ofd_Stats* stats)
+{
+    ofd_end_stats();
+    
+    Ofd_Array report;
+    ofd_array_init(&report, 1);
+    ofd_write_stats_report(stats, 10, &report);
+    printf("\n%s\n", report.data);
+    
+    ofd_free_array(&report);
+    ofd_free_stats(stats);
+}
+
+
+#ifdef OFD_OS_LINUX
+static volatile sig_atomic_t ofd_watch_was_interrupted = 0;
+
+void ofd_interrupt_watch(int signal_number)
+{
+    ofd_watch_was_interrupted = 1;
+}
+
+int ofd_os_watch_directory_of(int inotify_descriptor, char* filepath, char** filename)
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: we watch the directory a file is in rather than the file itself because editors often save a file by writing a new one
+    // and renaming it over the old one, which would end a watch on the old file. This returns the watch descriptor, which is the
+    // same for every file of a directory, and the name the file has in the events of that directory.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    char directory_path[2048];
+    
+    char* last_slash = strrchr(filepath, '/');
+    if(last_slash)
+    {
+        int directory_path_count = ofd_max(ofd_cast(last_slash - filepath, int), 1); // A file in '/' keeps its slash.
+        memcpy(directory_path, filepath, directory_path_count);
+        directory_path[directory_path_count] = 0;
+        
+        *filename = last_slash + 1;
+    }
+    else
+    {
+        strcpy(directory_path, ".");
+        *filename = filepath;
+    }
+    
+    int watch_descriptor = inotify_add_watch(inotify_descriptor, directory_path, IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE);
+    if(watch_descriptor < 0) printf("Failed to watch directory '%s'.\n", directory_path);
+    
+    return watch_descriptor;
+}
+
+ofd_b8 ofd_update_documentation_from_directory(Ofd_Documentation* documentation, char* directory_path, char* html_filepath, char* theme_filepath, char* logo_path, char* icon_path, char* title, ofd_b8 files_changed, ofd_b8 print_stats)
+{
+    Ofd_Array files = ofd_os_list_markdown_files(directory_path); // Files may have been added, renamed or deleted.
+    
+    Ofd_Array md_files;
+    ofd_array_init_with_space(&md_files, sizeof(char*), ofd_max(files.count, 1));
+    for(int i = 0; i < files.count; i++)
+    {
+        char** filepath = ofd_array_add_fast(&md_files);
+        *filepath = ofd_cast(files.data, Ofd_File*)[i].filepath_memory;
+    }
+    
+    ofd_b8 status = ofd_false;
+    if(md_files.count)
+    {
+        Ofd_Stats stats; // The stats point to the filepaths, they must be printed before the files are listed again.
+        if(print_stats) ofd_begin_stats(&stats);
+        
+        ofd_f64 start_time = ofd_get_wall_time();
+        status = ofd_update_documentation(documentation, ofd_cast(md_files.data, char**), md_files.count, html_filepath, theme_filepath, logo_path, icon_path, title, files_changed);
+        
+        if(print_stats) ofd_print_stats(&stats);
+        
+        if(status) printf("Generated '%s' in %.1fms.\n", html_filepath, (ofd_get_wall_time() - start_time) * 1000.0);
+        else       printf("Failed to generate '%s'.\n", html_filepath);
+    }
+    else printf("There are no markdown files in '%s'.\n", directory_path);
+    
+    ofd_free_array(&md_files);
+    ofd_free_array(&files);
+    
+    return status;
+}
+
+ofd_b8 ofd_watch_documentation(char* directory_path, char* config_filepath, char* html_filepath, char* theme_filepath, char* logo_path, char* icon_path, char* title, ofd_b8 print_stats, ofd_b8* restart)
+{
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: this regenerates the documentation every time a markdown file of directory_path, the theme file or the configuration file
+    // changes, until the program is interrupted. Parsed files stay in the file cache so only the files that changed are parsed again,
+    // and a theme change alone only regenerates the styles (see ofd_update_documentation()). The configuration file decides about
+    // everything else (output, theme, languages...) so when it changes *restart is set and the caller starts over.
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    *restart = ofd_false;
+    
+    int inotify_descriptor = inotify_init1(IN_CLOEXEC);
+    if(inotify_descriptor < 0)
+    {
+        printf("Failed to start watching for changes.\n");
+        return ofd_false;
+    }
+    
+    int directory_watch = inotify_add_watch(inotify_descriptor, directory_path, IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE);
+    if(directory_watch < 0) printf("Failed to watch directory '%s'.\n", directory_path);
+    
+    char* theme_filename  = NULL;
+    char* config_filename = NULL;
+    int theme_watch       = theme_filepath?  ofd_os_watch_directory_of(inotify_descriptor, theme_filepath,  &theme_filename)  : -1;
+    int config_watch      = config_filepath? ofd_os_watch_directory_of(inotify_descriptor, config_filepath, &config_filename) : -1;
+    
+    signal(SIGINT,  ofd_interrupt_watch);
+    signal(SIGTERM, ofd_interrupt_watch);
+    
+    
+    Ofd_Documentation documentation = {0};
+    ofd_b8 status = ofd_update_documentation_from_directory(&documentation, directory_path, html_filepath, theme_filepath, logo_path, icon_path, title, ofd_true, print_stats);
+    
+    printf("Watching '%s' for changes, press Ctrl+C to stop.\n", directory_path);
+    
+    ofd_b8 files_changed = ofd_false;
+    ofd_b8 theme_changed = ofd_false;
+    while(!ofd_watch_was_interrupted)
+    {
+        struct pollfd poll_info = {inotify_descriptor, POLLIN, 0};
+        int timeout = (files_changed || theme_changed)? 50 : -1; // Changes often come in bursts, we wait for the last one.
+        
+        int num_ready = poll(&poll_info, 1, timeout);
+        if(num_ready < 0)
+        {
+            if(errno == EINTR) continue;
+            break;
+        }
+        
+        if(num_ready == 0)
+        {
+            status = ofd_update_documentation_from_directory(&documentation, directory_path, html_filepath, theme_filepath, logo_path, icon_path, title, files_changed, print_stats);
+            
+            files_changed = ofd_false;
+            theme_changed = ofd_false;
+            continue;
+        }
+        
+        
+        // Read events. START
+        char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+        
+        int events_size = read(inotify_descriptor, events, sizeof(events));
+        if(events_size <= 0) continue;
+        
+        char* event_data = events;
+        while(event_data < events + events_size)
+        {
+            struct inotify_event* event = ofd_cast(event_data, struct inotify_event*);
+            event_data += sizeof(struct inotify_event) + event->len;
+            
+            if(event->mask & IN_Q_OVERFLOW)
+            { // Events were lost, anything could have changed.
+                files_changed = ofd_true;
+                continue;
+            }
+            
+            if(!event->len) continue;
+            Ofd_String filename = Ofd_String_(event->name);
+            
+            if(event->wd == config_watch && strcmp(event->name, config_filename) == 0) *restart = ofd_true;
+            if(event->wd == theme_watch  && strcmp(event->name, theme_filename)  == 0) theme_changed = ofd_true;
+            
+            if(event->wd == directory_watch && filename.count > 3)
+            { // Only markdown files matter, the output file and its temporary file are ignored even if they are in this directory.
+                Ofd_String extension = {filename.data + filename.count - 3, 3};
+                if(ofd_string_matches(extension, ".md")) files_changed = ofd_true;
+            }
+        }
+        // Read events. END
+        
+        if(*restart) break;
+    }
+    
+    ofd_free_documentation(&documentation);
+    close(inotify_descriptor);
+    
+    signal(SIGINT,  SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    
+    return status;
+}
+#endif // OFD_OS_LINUX
+
+
 int main(int num_arguments, char** arguments)
 {
     const char* HELP_MESSAGE =
@@ -429,6 +633,13 @@ int main(int num_arguments, char** arguments)
         "-i, -icon   <path>:   specifies a path to an icon.\n"
         "-title      <title>:  specifies a title.\n"
         "-c, -config <file>:   specifies a project configuration file.\n"
+        "-cache <directory>:   keeps highlighted code blocks and parsed markdown files in this directory so that the next runs only redo what changed.\n"
+        "-cache_size <MB>:     specifies the maximum size of each cache. The defaults are 64MB for code blocks and 256MB for files.\n"
+        "-stats:               prints the time spent in every phase, a few counts and the slowest files once done.\n"
+        "-counters:            like -stats, and adds CPU cycles, instructions, branch misses and cache misses per phase (Linux only).\n"
+        "-trace <file>:        records a timeline of the run to this file, open it in Perfetto or chrome://tracing. Not with -watch.\n"
+        "-watch:               keeps running with -d and regenerates the documentation whenever a markdown file, the theme or the configuration\n"
+        "                      changes, only parsing the files that changed (Linux only).\n"
         "\n"
         "-d, -dir <directory>: specifies a directory to build documentation from.\n"
         "                      ofd takes all .md files in the directory as input.\n"
@@ -447,6 +658,12 @@ int main(int num_arguments, char** arguments)
         char* config_filepath   = NULL;
         char* directory_path    = NULL;
         char* title             = NULL;
+        char* cache_path        = NULL;
+        int   cache_size        = 0; // 0 for the default size of each cache.
+        ofd_b8 print_stats      = ofd_false;
+        ofd_b8 count_hardware   = ofd_false;
+        char* trace_filepath    = NULL;
+        ofd_b8 watch            = ofd_false;
         
         Ofd_Array md_files;
         ofd_array_init(&md_files, sizeof(char*));
@@ -603,6 +820,97 @@ int main(int num_arguments, char** arguments)
                 arg_index += 2;
                 continue;
             }
+            else if(strcmp(argument, "-cache") == 0)
+            {
+                // Retrieve a cache directory. START
+                if(cache_path)
+                {
+                    printf("It looks like you already specified the cache directory to be '%s'.", cache_path);
+                    return -1;
+                }
+                
+                if(arg_index == num_arguments - 1)
+                {
+                    printf("It looks like you forgot to specify a cache directory after the '%s' switch.\n", argument);
+                    return -1;
+                }
+                
+                cache_path = arguments[arg_index + 1];
+                // Retrieve a cache directory. END
+                
+                arg_index += 2;
+                continue;
+            }
+            else if(strcmp(argument, "-cache_size") == 0)
+            {
+                // Retrieve a cache size. START
+                if(arg_index == num_arguments - 1)
+                {
+                    printf("It looks like you forgot to specify a cache size after the '%s' switch.\n", argument);
+                    return -1;
+                }
+                
+                int size_in_mb = atoi(arguments[arg_index + 1]);
+                if(size_in_mb <= 0 || size_in_mb > 2047)
+                {
+                    printf("The cache size must be a number of megabytes between 1 and 2047, not '%s'.\n", arguments[arg_index + 1]);
+                    return -1;
+                }
+                
+                cache_size = size_in_mb * 1024 * 1024;
+                // Retrieve a cache size. END
+                
+                arg_index += 2;
+                continue;
+            }
+            else if(strcmp(argument, "-trace") == 0)
+            {
+                // Retrieve a trace filepath. START
+                if(trace_filepath)
+                {
+                    printf("It looks like you already specified the trace file to be '%s'.", trace_filepath);
+                    return -1;
+                }
+                
+                if(arg_index == num_arguments - 1)
+                {
+                    printf("It looks like you forgot to specify a trace file after the '%s' switch.\n", argument);
+                    return -1;
+                }
+                
+                trace_filepath = arguments[arg_index + 1];
+                // Retrieve a trace filepath. END
+                
+                arg_index += 2;
+                continue;
+            }
+            else if(strcmp(argument, "-stats") == 0)
+            {
+                print_stats = ofd_true;
+                
+                arg_index++;
+                continue;
+            }
+            else if(strcmp(argument, "-counters") == 0)
+            {
+                print_stats    = ofd_true;
+                count_hardware = ofd_true;
+                
+                arg_index++;
+                continue;
+            }
+            else if(strcmp(argument, "-watch") == 0)
+            {
+                #ifndef OFD_OS_LINUX
+                printf("The '%s' switch is only available on Linux for now.\n", argument);
+                return -1;
+                #endif
+                
+                watch = ofd_true;
+                
+                arg_index++;
+                continue;
+            }
             else if(strcmp(argument, "-h") == 0 || strcmp(argument, "-help") == 0)
             { // Display a help message.
                 printf("%s", HELP_MESSAGE);
@@ -660,7 +968,7 @@ int main(int num_arguments, char** arguments)
         if(config_filepath)
         {
             // Parse the configuration file. START
-            Ofd_String config_data;
+            Ofd_String config_data; // Read rather than mapped, -watch reloads it right after it was edited.
             ofd_b8 status = ofd_read_whole_file(config_filepath, &config_data);
             if(!status) return 0;
             
@@ -739,20 +1047,126 @@ int main(int num_arguments, char** arguments)
             }
             
             
-            ofd_free(config_data.data);
+            // Load language definitions. START
+            char* c     = config.language_filepaths.data;
+            char* limit = config.language_filepaths.data + config.language_filepaths.count;
+            while(ofd_true)
+            {
+                Ofd_String language_filepath = ofd_get_next_filepath(&c, limit);
+                if(!language_filepath.count) break;
+                
+                if(directory_path_count)
+                {
+                    char c_string[2048];
+                    ofd_to_c_string(language_filepath, c_string);
+                    stbsp_sprintf(tmp_buffer, "%s/%s", directory_path, c_string);
+                }
+                else ofd_to_c_string(language_filepath, tmp_buffer);
+                
+                if(!ofd_load_language_definition(tmp_buffer, error_message))
+                {
+                    printf("Failed to load language definition '%s' with the following error:\n%s", tmp_buffer, error_message);
+                    return -1;
+                }
+            }
+            // Load language definitions. END
+            
+            
+            ofd_release_whole_file(&config_data, ofd_false);
             // Parse the configuration file. END
         }
         
         if(!html_filepath) html_filepath = "result.html";
         
         
-        if(!md_files.count)
+        if(!md_files.count && !watch)
         {
             printf("Did you forget to specify markdown files to make documentation from?\n");
             return -1;
         }
         
-        ofd_b8 status = ofd_generate_documentation(ofd_cast(md_files.data, char**), md_files.count, html_filepath, theme_filepath, logo_path, icon_path, title);
+        if(watch && !directory_path[0])
+        {
+            printf("The '-watch' switch needs a directory to watch, specify it with '-d'.\n");
+            return -1;
+        }
+        
+        if(watch && trace_filepath)
+        { // The trace would only be written when -watch ends and would keep growing with every rebuild until then.
+            printf("The '-trace' switch cannot be used with '-watch', record a trace of a single run instead.\n");
+            return -1;
+        }
+        
+        if(cache_path || watch)
+        { // Without a cache directory, -watch keeps its caches in memory.
+            int highlight_cache_size = cache_size? cache_size : OFD_DEFAULT_HIGHLIGHT_CACHE_SIZE;
+            int file_cache_size      = cache_size? cache_size : OFD_DEFAULT_FILE_CACHE_SIZE;
+            
+            if(!ofd_open_highlight_cache(cache_path, highlight_cache_size)) printf("Code blocks will not be cached.\n");
+            if(!ofd_open_file_cache(cache_path, file_cache_size))           printf("Markdown files will not be cached.\n");
+        }
+        
+        if(count_hardware && !ofd_open_hardware_counters())
+        {
+            printf("Hardware counters are not available, they need Linux, a CPU that exposes them and /proc/sys/kernel/perf_event_paranoid <= 2.\n");
+        }
+        
+        Ofd_Stats stats;
+        if(print_stats && !watch) ofd_begin_stats(&stats); // -watch prints stats after every run instead.
+        
+        Ofd_Trace trace;
+        if(trace_filepath) ofd_begin_trace(&trace);
+        
+        ofd_b8 status  = ofd_false;
+        ofd_b8 restart = ofd_false; // -watch saw the configuration file change.
+        
+        #ifdef OFD_OS_LINUX
+        if(watch)
+        { // Without a configuration file we watch for an implicit one to show up.
+            char* watched_config_filepath = config_filepath? config_filepath : implicit_config_filepath;
+            status = ofd_watch_documentation(directory_path, watched_config_filepath, html_filepath, theme_filepath, logo_path, icon_path, title, print_stats, &restart);
+        }
+        #endif
+        
+        if(!watch) status = ofd_generate_documentation(ofd_cast(md_files.data, char**), md_files.count, html_filepath, theme_filepath, logo_path, icon_path, title);
+        
+        if(print_stats && !watch) ofd_print_stats(&stats);
+        
+        if(trace_filepath)
+        {
+            // Save the trace. START
+            ofd_end_trace();
+            
+            Ofd_Writer writer;
+            if(ofd_writer_init_with_file(&writer, trace_filepath)) ofd_write_trace(&trace, &writer);
+            if(!ofd_close_writer(&writer)) printf("Failed to write trace file '%s'.\n", trace_filepath);
+            
+            ofd_free_trace(&trace);
+            // Save the trace. END
+        }
+        
+        ofd_close_hardware_counters();
+        ofd_close_file_cache();
+        ofd_close_highlight_cache();
+        
+        #ifdef OFD_OS_LINUX
+        if(restart)
+        { // The configuration decides about files, the theme and languages, starting over is the simplest way to apply it.
+            printf("The configuration file changed, restarting.\n");
+            
+            char executable_path[2048];
+            int executable_path_count = readlink("/proc/self/exe", executable_path, sizeof(executable_path) - 1);
+            if(executable_path_count > 0)
+            {
+                executable_path[executable_path_count] = 0;
+                execv(executable_path, arguments);
+            }
+            
+            printf("Failed to restart.\n");
+            return -1;
+        }
+        #endif
+        
         if(status) printf("Successfully generated '%s'.\n", html_filepath);
         else
         {
@@ -0,0 +1,506 @@
+#ifdef __clang__
+    #pragma clang diagnostic error "-Wshadow-all"
+    #pragma clang diagnostic error "-Wreturn-type"
+#endif
+
+#if defined(_WIN32) || defined(_WIN64) || defined(__WIN32__) || defined(__WINDOWS__)
+#define OFD_OS_WINDOWS
+#endif
+
+#ifdef OFD_OS_WINDOWS
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// NOTE: this measures how fast ofd_apply_syntax_highlighting() is for each built-in language. Every language gets a corpus made of copies
+// of a representative code block, which goes through the highlighter one block at a time like code blocks of a markdown file do.
+// It prints one CSV line per language so that runs can be compared with a diff or a spreadsheet:
+//     language,input_bytes,output_bytes,best_seconds,mb_per_second,output_bytes_per_input_byte,allocations_per_kb
+// best_seconds is the fastest of all runs. Allocations are counted by routing ofd_allocate() through benchmark_allocate().
+//
+// Usage: highlighter_benchmark [-size <KB per language>] [-runs <number of runs>] [language IDs...]
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#define STB_SPRINTF_IMPLEMENTATION
+#include "stb_sprintf.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static long long benchmark_num_allocations;
+
+static void* benchmark_allocate(size_t size)
+{
+    benchmark_num_allocations++;
+    return malloc(size);
+}
+
+#define ofd_allocate(_size) benchmark_allocate(_size)
+#define ofd_free(_memory)   free(_memory)
+
+#define ofd_sprintf stbsp_sprintf
+#define OFD_IMPLEMENTATION
+#include "ofd.h"
+
+
+#ifdef OFD_OS_WINDOWS
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#pragma comment(lib, "kernel32")
+
+double benchmark_get_seconds(void)
+{
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+}
+
+#else
+/////////////////////////
+// NOTE: we assume POSIX.
+/////////////////////////
+
+#include <time.h>
+
+double benchmark_get_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+#endif // OFD_OS_WINDOWS
+
+
+typedef struct
+{
+    char* language;
+    char* code;
+} Benchmark_Sample;
+
+static Benchmark_Sample benchmark_samples[] = {
+    {"c",
+        "#include <stdio.h>\n"
+        "#include \"ofd.h\"\n"
+        "\n"
+        "/* Sums the values of an array.\n"
+        "   Returns 0 for an empty array. */\n"
+        "static int sum(const int* values, int count)\n"
+        "{\n"
+        "    int result = 0;\n"
+        "    for(int i = 0; i < count; i++) result += values[i]; // Overflows are fine here.\n"
+        "    return result;\n"
+        "}\n"
+        "\n"
+        "int main(int argc, char** argv)\n"
+        "{\n"
+        "    int values[4] = {1, 0x20, 3, 1000};\n"
+        "    float ratio   = 1.5f * .25f;\n"
+        "    if(argc > 1 && argv[1][0] == '-') printf(\"%s: %d\\n\", argv[1], sum(values, 4));\n"
+        "    return ratio > 0.5 ? 0 : -1;\n"
+        "}\n"},
+    
+    {"rust",
+        "use std::collections::HashMap;\n"
+        "\n"
+        "/// Counts the words of a text.\n"
+        "pub fn count_words<'a>(text: &'a str) -> HashMap<&'a str, usize> {\n"
+        "    let mut counts = HashMap::new();\n"
+        "    for word in text.split_whitespace() {\n"
+        "        *counts.entry(word).or_insert(0) += 1; /* nested /* comment */ here */\n"
+        "    }\n"
+        "    counts\n"
+        "}\n"
+        "\n"
+        "fn main() {\n"
+        "    let text: &'static str = \"the quick brown fox jumps over the lazy dog\";\n"
+        "    let limit = 1_000u32;\n"
+        "    match count_words(text).get(\"the\") {\n"
+        "        Some(&n) if n as u32 > limit => println!(\"many: {}\", n),\n"
+        "        Some(n) => println!(\"{} times, {:.2}\", n, 0.5f64),\n"
+        "        None => {}\n"
+        "    }\n"
+        "}\n"},
+    
+    {"go",
+        "package main\n"
+        "\n"
+        "import (\n"
+        "    \"fmt\"\n"
+        "    \"strings\"\n"
+        ")\n"
+        "\n"
+        "// Point is a point in 2D.\n"
+        "type Point struct {\n"
+        "    X, Y float64\n"
+        "}\n"
+        "\n"
+        "func (p Point) String() string {\n"
+        "    return fmt.Sprintf(`(%g, %g)`, p.X, p.Y)\n"
+        "}\n"
+        "\n"
+        "func main() {\n"
+        "    points := []Point{{1, 2}, {3.5, 0x10}}\n"
+        "    for i, p := range points {\n"
+        "        if i > 0 { fmt.Println(strings.Repeat(\"-\", 10)) } /* separator */\n"
+        "        fmt.Println(p)\n"
+        "    }\n"
+        "}\n"},
+    
+    {"cs",
+        "using System;\n"
+        "using System.Collections.Generic;\n"
+        "\n"
+        "namespace Example\n"
+        "{\n"
+        "    // A stack that keeps its maximum.\n"
+        "    public class MaxStack<T> where T : IComparable<T>\n"
+        "    {\n"
+        "        private readonly List<T> items = new List<T>();\n"
+        "\n"
+        "        public void Push(T item) { items.Add(item); }\n"
+        "\n"
+        "        public T Pop()\n"
+        "        {\n"
+        "            if (items.Count == 0) throw new InvalidOperationException(\"The stack is empty.\");\n"
+        "            T last = items[items.Count - 1];\n"
+        "            items.RemoveAt(items.Count - 1); /* O(1) */\n"
+        "            return last;\n"
+        "        }\n"
+        "    }\n"
+        "}\n"},
+    
+    {"java",
+        "package com.example;\n"
+        "\n"
+        "import java.util.ArrayList;\n"
+        "import java.util.List;\n"
+        "\n"
+        "/**\n"
+        " * Keeps the last lines of a log.\n"
+        " */\n"
+        "public final class Tail {\n"
+        "    private static final int DEFAULT_SIZE = 100;\n"
+        "    private final List<String> lines = new ArrayList<>();\n"
+        "\n"
+        "    @Override\n"
+        "    public String toString() {\n"
+        "        StringBuilder builder = new StringBuilder();\n"
+        "        for (String line : lines) builder.append(line).append('\\n'); // One per line.\n"
+        "        return builder.toString();\n"
+        "    }\n"
+        "\n"
+        "    public boolean isFull() { return lines.size() >= DEFAULT_SIZE * 1.0; }\n"
+        "}\n"},
+    
+    {"jai",
+        "#import \"Basic\";\n"
+        "\n"
+        "Vector2 :: struct {\n"
+        "    x, y: float;\n"
+        "}\n"
+        "\n"
+        "// Returns the length of v.\n"
+        "length :: (v: Vector2) -> float {\n"
+        "    return sqrt(v.x*v.x + v.y*v.y);\n"
+        "}\n"
+        "\n"
+        "main :: () {\n"
+        "    v := Vector2.{3, 4};\n"
+        "    /* Print it /* twice */ */\n"
+        "    for 1..2 print(\"length: %\\n\", length(v));\n"
+        "    if length(v) > 4.5 then print(\"long\\n\");\n"
+        "}\n"},
+    
+    {"8",
+        "\\ Prints the squares of a few numbers.\n"
+        ": square dup n:* ;\n"
+        "\n"
+        "[1, 2, 3, 0x10] ( square . cr ) a:each drop\n"
+        "\n"
+        "\"done\" . cr\n"
+        "-- A word with a comment.\n"
+        ": greet \"Hello, \" swap s:+ . cr ; \\ Greets someone.\n"
+        "\"world\" greet\n"
+        "bye\n"},
+    
+    {"perl",
+        "#!/usr/bin/perl\n"
+        "use strict;\n"
+        "use warnings;\n"
+        "\n"
+        "# Counts the lines of every file given on the command line.\n"
+        "my %counts;\n"
+        "foreach my $path (@ARGV) {\n"
+        "    open(my $file, '<', $path) or die \"Cannot open $path: $!\";\n"
+        "    while (my $line = <$file>) {\n"
+        "        $counts{$path}++ unless $line =~ /^\\s*$/;\n"
+        "    }\n"
+        "    close($file);\n"
+        "}\n"
+        "\n"
+        "printf(\"%-20s %d\\n\", $_, $counts{$_}) for sort keys %counts;\n"},
+    
+    {"python",
+        "import sys\n"
+        "from collections import defaultdict\n"
+        "\n"
+        "\n"
+        "class Histogram:\n"
+        "    \"\"\"Counts how often values appear.\n"
+        "    Values can be anything hashable.\"\"\"\n"
+        "\n"
+        "    def __init__(self, bins=10):\n"
+        "        self.counts = defaultdict(int)  # value -> count\n"
+        "        self.bins = bins\n"
+        "\n"
+        "    def add(self, value):\n"
+        "        self.counts[value] += 1\n"
+        "        return self\n"
+        "\n"
+        "\n"
+        "if __name__ == '__main__':\n"
+        "    h = Histogram()\n"
+        "    for word in sys.argv[1:]:\n"
+        "        h.add(word.lower())\n"
+        "    print(f\"{len(h.counts)} distinct words, ratio {0.5 * 3:.2f}\")\n"},
+    
+    {"js",
+        "'use strict';\n"
+        "\n"
+        "// Debounces a function so that it only runs once things calm down.\n"
+        "function debounce(callback, delay = 250) {\n"
+        "    let timer = null;\n"
+        "    return function (...args) {\n"
+        "        if (timer !== null) clearTimeout(timer);\n"
+        "        timer = setTimeout(() => callback.apply(this, args), delay);\n"
+        "    };\n"
+        "}\n"
+        "\n"
+        "/* Resize handler. */\n"
+        "const onResize = debounce(() => {\n"
+        "    const width = window.innerWidth * 0.5;\n"
+        "    console.log(`width: ${width}px`, \"done\");\n"
+        "}, 100);\n"
+        "\n"
+        "window.addEventListener('resize', onResize);\n"},
+    
+    {"ts",
+        "interface User {\n"
+        "    id: number;\n"
+        "    name: string;\n"
+        "    email?: string;\n"
+        "}\n"
+        "\n"
+        "// Finds users whose name starts with prefix.\n"
+        "export async function findUsers(users: User[], prefix: string): Promise<User[]> {\n"
+        "    const result: User[] = [];\n"
+        "    for (const user of users) {\n"
+        "        if (user.name.startsWith(prefix) && user.id > 0x0) result.push(user);\n"
+        "    }\n"
+        "    return result; /* Might be empty. */\n"
+        "}\n"
+        "\n"
+        "export type Callback = (error: Error | null, value?: string) => void;\n"
+        "const greeting: string = `Hello ${'world'}`;\n"},
+    
+    {"php",
+        "<?php\n"
+        "namespace App\\Http;\n"
+        "\n"
+        "// Renders a list of articles.\n"
+        "class ArticleController extends Controller\n"
+        "{\n"
+        "    private $perPage = 20;\n"
+        "\n"
+        "    public function index(Request $request)\n"
+        "    {\n"
+        "        $page = (int) $request->get('page', 1);\n"
+        "        $articles = Article::where('published', true)->skip(($page - 1) * $this->perPage)->get();\n"
+        "        /* Nothing to show. */\n"
+        "        if (count($articles) === 0) return \"No articles\";\n"
+        "        foreach ($articles as $article) echo \"<h2>{$article->title}</h2>\\n\";\n"
+        "        return null;\n"
+        "    }\n"
+        "}\n"},
+    
+    {"bat",
+        "@echo off\n"
+        "REM Builds the project in release mode.\n"
+        "setlocal\n"
+        "\n"
+        "set BUILD_DIR=build\n"
+        "if not exist %BUILD_DIR% mkdir %BUILD_DIR%\n"
+        "\n"
+        "for %%f in (*.c) do (\n"
+        "    echo Compiling %%f\n"
+        "    cl /O2 /c \"%%f\" /Fo%BUILD_DIR%\\ > NUL\n"
+        "    if errorlevel 1 goto :error\n"
+        ")\n"
+        "goto :eof\n"
+        "\n"
+        ":error\n"
+        "echo Build failed with error %errorlevel%.\n"
+        "exit /b 1\n"},
+    
+    {"sh",
+        "#!/bin/bash\n"
+        "set -euo pipefail\n"
+        "\n"
+        "# Backs up a folder into a dated archive.\n"
+        "SOURCE=\"${1:-$HOME/documents}\"\n"
+        "DESTINATION='/var/backups'\n"
+        "\n"
+        "if [ ! -d \"$SOURCE\" ]; then\n"
+        "    echo \"Missing folder: $SOURCE\" >&2\n"
+        "    exit 1\n"
+        "fi\n"
+        "\n"
+        "for i in 1 2 3; do\n"
+        "    archive=\"$DESTINATION/backup-$(date +%Y%m%d)-$i.tar.gz\"\n"
+        "    [ -e \"$archive\" ] || { tar -czf \"$archive\" \"$SOURCE\"; break; }\n"
+        "done\n"},
+    
+    {"json",
+        "{\n"
+        "    \"name\": \"one-file-docs\",\n"
+        "    \"version\": \"0.1.1\",\n"
+        "    \"private\": true,\n"
+        "    \"ratio\": 0.75,\n"
+        "    \"limits\": {\"files\": 1000, \"size\": 1e6, \"depth\": null},\n"
+        "    \"keywords\": [\"markdown\", \"documentation\", \"html\"],\n"
+        "    \"authors\": [\n"
+        "        {\"name\": \"Someone\", \"email\": \"someone@example.com\"},\n"
+        "        {\"name\": \"Someone else\", \"active\": false}\n"
+        "    ]\n"
+        "}\n"},
+    
+    {"css",
+        "/* Layout of the side bar. */\n"
+        ":root {\n"
+        "    --accent: #3a7bd5;\n"
+        "}\n"
+        "\n"
+        ".sidebar > ul li a:hover {\n"
+        "    color: var(--accent);\n"
+        "    background-color: rgba(0, 0, 0, 0.05);\n"
+        "    transition: background-color 0.2s ease-in-out;\n"
+        "}\n"
+        "\n"
+        "@media (max-width: 800px) {\n"
+        "    .sidebar { display: none; width: 100%; font-family: \"Helvetica\", sans-serif; }\n"
+        "}\n"},
+    
+    {"xml",
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<!-- A small catalog. -->\n"
+        "<catalog xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\">\n"
+        "    <book id=\"bk101\" available='true'>\n"
+        "        <author>Gambardella, Matthew</author>\n"
+        "        <title>XML Developer's Guide</title>\n"
+        "        <price currency=\"EUR\">44.95</price>\n"
+        "        <description>An in-depth look at creating applications &amp; more.</description>\n"
+        "    </book>\n"
+        "    <book id=\"bk102\"/>\n"
+        "</catalog>\n"},
+};
+
+
+int main(int num_arguments, char** arguments)
+{
+    int size_in_kb = 4 * 1024;
+    int num_runs   = 5;
+    
+    char** selected_languages    = arguments + 1;
+    int    num_selected_languages = 0;
+    
+    // Parse arguments. START
+    for(int arg_index = 1; arg_index < num_arguments; arg_index++)
+    {
+        char* argument = arguments[arg_index];
+        
+        if(strcmp(argument, "-size") == 0 || strcmp(argument, "-runs") == 0)
+        {
+            if(arg_index + 1 == num_arguments || atoi(arguments[arg_index + 1]) <= 0)
+            {
+                printf("%s expects a number greater than 0.\n", argument);
+                return -1;
+            }
+            
+            if(argument[1] == 's') size_in_kb = atoi(arguments[arg_index + 1]);
+            else                   num_runs   = atoi(arguments[arg_index + 1]);
+            
+            arg_index++;
+        }
+        else if(argument[0] == '-')
+        {
+            printf("Usage: %s [-size <KB per language>] [-runs <number of runs>] [language IDs...]\n", arguments[0]);
+            return argument[1] == 'h' ? 0 : -1;
+        }
+        else
+        {
+            selected_languages[num_selected_languages] = argument;
+            num_selected_languages++;
+        }
+    }
+    // Parse arguments. END
+    
+    
+    ofd_register_builtin_languages(); // So that registering languages is not counted in the first language.
+    
+    printf("language,input_bytes,output_bytes,best_seconds,mb_per_second,output_bytes_per_input_byte,allocations_per_kb\n");
+    
+    for(int sample_index = 0; sample_index < ofd_array_count(benchmark_samples); sample_index++)
+    {
+        Benchmark_Sample* sample = benchmark_samples + sample_index;
+        
+        if(num_selected_languages)
+        {
+            ofd_b8 is_selected = ofd_false;
+            for(int i = 0; i < num_selected_languages; i++) is_selected |= (strcmp(selected_languages[i], sample->language) == 0);
+            if(!is_selected) continue;
+        }
+        
+        Ofd_String language = Ofd_String_(sample->language);
+        Ofd_String code     = Ofd_String_(sample->code);
+        
+        long long num_blocks  = ((long long)size_in_kb * 1024 + code.count - 1) / code.count;
+        long long input_bytes = num_blocks * code.count;
+        
+        double    best_seconds      = 0;
+        long long output_bytes      = 0;
+        long long num_allocations   = 0;
+        
+        for(int run_index = 0; run_index <= num_runs; run_index++)
+        { // The first run only warms things up.
+            Ofd_Array html;
+            ofd_array_init(&html, 1);
+            
+            long long allocations_before = benchmark_num_allocations;
+            double    start              = benchmark_get_seconds();
+            
+            for(long long i = 0; i < num_blocks; i++) ofd_apply_syntax_highlighting(&html, code, language);
+            
+            double seconds = benchmark_get_seconds() - start;
+            
+            if(run_index && (run_index == 1 || seconds < best_seconds)) best_seconds = seconds;
+            num_allocations = benchmark_num_allocations - allocations_before;
+            output_bytes    = html.count;
+            
+            ofd_free_array(&html);
+        }
+        
+        double mb_per_second = best_seconds > 0 ? ((double)input_bytes / (1024.0 * 1024.0)) / best_seconds : 0;
+        
+        printf("%s,%lld,%lld,%.6f,%.2f,%.3f,%.4f\n", sample->language, input_bytes, output_bytes, best_seconds, mb_per_second,
+               (double)output_bytes / (double)input_bytes, (double)num_allocations / ((double)input_bytes / 1024.0));
+    }
+    
+    return 0;
+}
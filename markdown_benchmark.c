@@ -0,0 +1,571 @@
+#ifdef __clang__
+    #pragma clang diagnostic error "-Wshadow-all"
+    #pragma clang diagnostic error "-Wreturn-type"
+#endif
+
+#if defined(_WIN32) || defined(_WIN64) || defined(__WIN32__) || defined(__WINDOWS__)
+#define OFD_OS_WINDOWS
+#endif
+
+#ifdef OFD_OS_WINDOWS
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// NOTE: this measures how fast whole documentation is generated. It makes synthetic corpora of markdown files, each with its own mix of
+// blocks (see benchmark_mixes), and runs ofd_generate_documentation_to_writer() on them, which is what
+// ofd_generate_documentation_from_memory() does minus keeping the HTML around. The HTML is counted and dropped so that corpora of
+// several GB fit in memory. It prints one CSV line per corpus so that runs can be compared with a diff or a spreadsheet:
+//     corpus,input_bytes,num_files,output_bytes,best_seconds,mb_per_second,allocations,allocated_bytes,peak_heap_bytes,peak_rss_kb
+// best_seconds is the fastest of all runs, the allocation numbers are those of a single run. Allocations are counted with
+// OFD_ALLOCATION_STATS during each run only. peak_heap_bytes does not include the corpus, peak_rss_kb does. On Linux the peak RSS is
+// reset before each corpus, elsewhere it is the peak of the whole process so run one corpus at a time to compare it.
+// Corpora only depend on the seed, their size and their mix so the same command line always measures the same markdown.
+//
+// Usage: markdown_benchmark [-size <bytes>[K|M|G]] [-file_size <bytes>[K|M|G]] [-runs <number of runs>] [-seed <number>] [corpora...]
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#define STB_SPRINTF_IMPLEMENTATION
+#include "stb_sprintf.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef OFD_OS_WINDOWS
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+
+#pragma comment(lib, "kernel32")
+
+#else
+/////////////////////////
+// NOTE: we assume POSIX.
+/////////////////////////
+
+#include <time.h>
+#include <sys/resource.h>
+#endif // OFD_OS_WINDOWS
+
+
+#define ofd_sprintf stbsp_sprintf
+#define OFD_ALLOCATION_STATS // Each run counts its allocations, see main().
+#define OFD_IMPLEMENTATION
+#include "ofd.h"
+
+
+#ifdef OFD_OS_WINDOWS
+
+double benchmark_get_seconds(void)
+{
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+}
+
+void benchmark_reset_peak_rss(void)
+{
+    // NOTE: Windows cannot do that.
+}
+
+long long benchmark_get_peak_rss_in_kb(void)
+{
+    PROCESS_MEMORY_COUNTERS counters;
+    if(!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    
+    return (long long)(counters.PeakWorkingSetSize / 1024);
+}
+
+#else
+
+double benchmark_get_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+void benchmark_reset_peak_rss(void)
+{
+    #ifdef __linux__
+    FILE* file = fopen("/proc/self/clear_refs", "w"); // Writing 5 resets the peak RSS since Linux 4.0.
+    if(!file) return;
+    
+    fputs("5", file);
+    fclose(file);
+    #endif
+}
+
+long long benchmark_get_peak_rss_in_kb(void)
+{
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    
+    #ifdef __APPLE__
+    return (long long)usage.ru_maxrss / 1024; // This is in bytes on macOS.
+    #else
+    return (long long)usage.ru_maxrss;
+    #endif
+}
+#endif // OFD_OS_WINDOWS
+
+
+typedef enum
+{
+    BENCHMARK_PROSE,
+    BENCHMARK_HEADER,
+    BENCHMARK_CODE_BLOCK,
+    BENCHMARK_TABLE,
+    BENCHMARK_LINK_REFERENCES,
+    BENCHMARK_LIST,
+    
+    BENCHMARK_BLOCK_KIND_COUNT,
+} Benchmark_Block_Kind;
+
+typedef struct
+{
+    char* name;
+    int   weights[BENCHMARK_BLOCK_KIND_COUNT]; // How often each kind of block is picked, in the order of Benchmark_Block_Kind.
+} Benchmark_Mix;
+
+static Benchmark_Mix benchmark_mixes[] = {
+    //             Prose Header Code Table Links List
+    {"prose",     {80,   5,     5,   2,    3,    5}},
+    {"headers",   {30,   60,    2,   2,    2,    4}},
+    {"code",      {25,   5,     60,  2,    3,    5}},
+    {"tables",    {25,   5,     3,   60,   2,    5}},
+    {"links",     {25,   5,     3,   2,    60,   5}},
+    {"lists",     {25,   5,     3,   2,    5,    60}},
+    {"mixed",     {35,   10,    20,  10,   10,   15}},
+};
+
+static char* benchmark_words[] = {
+    "the", "documentation", "file", "parser", "section", "markdown", "table", "link", "output", "theme", "code", "block",
+    "of", "and", "to", "in", "is", "that", "for", "with", "as", "on", "by", "from", "when", "every", "each", "one",
+    "generate", "render", "highlight", "measure", "build", "parse", "write", "read", "configure", "open", "close", "find",
+    "quickly", "simply", "usually", "always", "never", "often", "fast", "small", "large", "simple", "plain", "single",
+    "header", "list", "item", "reference", "image", "quote", "colour", "number", "string", "keyword", "comment", "value",
+};
+
+static char* benchmark_code_languages[] = {"c", "cpp", "rust", "go", "py", "js", "ts", "sh", "java", "css"};
+
+
+typedef struct
+{
+    unsigned long long random_state;
+    int                num_link_references;
+} Benchmark_Generator;
+
+static unsigned int benchmark_random(Benchmark_Generator* generator, unsigned int limit)
+{
+    // NOTE: xorshift64*, corpora must be the same on every platform so we do not use rand().
+    
+    unsigned long long x = generator->random_state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    generator->random_state = x;
+    
+    return (unsigned int)((x * 0x2545F4914F6CDD1DULL) >> 32) % limit;
+}
+
+static char* benchmark_random_word(Benchmark_Generator* generator)
+{
+    return benchmark_words[benchmark_random(generator, ofd_array_count(benchmark_words))];
+}
+
+static void benchmark_add(Ofd_Array* markdown, char* text)
+{
+    ofd_array_add_string(markdown, Ofd_String_(text));
+}
+
+static void benchmark_add_words(Benchmark_Generator* generator, Ofd_Array* markdown, int num_words)
+{
+    for(int i = 0; i < num_words; i++)
+    {
+        if(i) benchmark_add(markdown, " ");
+        benchmark_add(markdown, benchmark_random_word(generator));
+    }
+}
+
+static void benchmark_add_sentence_text(Benchmark_Generator* generator, Ofd_Array* markdown, int num_words)
+{
+    // NOTE: words with a bit of inline markdown here and there.
+    
+    char buffer[256];
+    
+    for(int i = 0; i < num_words; i++)
+    {
+        if(i) benchmark_add(markdown, (i % 13 == 0)? ". " : " ");
+        
+        char* word = benchmark_random_word(generator);
+        
+        unsigned int dice = benchmark_random(generator, 100);
+        if     (dice < 4)  stbsp_sprintf(buffer, "*%s*", word);
+        else if(dice < 7)  stbsp_sprintf(buffer, "`%s`", word);
+        else if(dice < 9)  stbsp_sprintf(buffer, "[%s](https://example.com/%s \"%s\")", word, word, word);
+        else if(dice < 10) stbsp_sprintf(buffer, "\\*%s", word);
+        else               stbsp_sprintf(buffer, "%s", word);
+        
+        benchmark_add(markdown, buffer);
+    }
+}
+
+static void benchmark_add_block(Benchmark_Generator* generator, Ofd_Array* markdown, Benchmark_Block_Kind kind)
+{
+    char buffer[256];
+    
+    switch(kind)
+    {
+        case BENCHMARK_PROSE:
+        {
+            benchmark_add_sentence_text(generator, markdown, 30 + benchmark_random(generator, 90));
+            benchmark_add(markdown, ".\n\n");
+        } break;
+        
+        case BENCHMARK_HEADER:
+        {
+            int level = 1 + benchmark_random(generator, 4);
+            for(int i = 0; i < level; i++) benchmark_add(markdown, "#");
+            benchmark_add(markdown, " ");
+            benchmark_add_words(generator, markdown, 1 + benchmark_random(generator, 5));
+            benchmark_add(markdown, "\n");
+            
+            benchmark_add_sentence_text(generator, markdown, 5 + benchmark_random(generator, 20));
+            benchmark_add(markdown, ".\n\n");
+        } break;
+        
+        case BENCHMARK_CODE_BLOCK:
+        {
+            char* language = benchmark_code_languages[benchmark_random(generator, ofd_array_count(benchmark_code_languages))];
+            char* comment  = (language[0] == 'p' || language[0] == 's')? "#" : "//";
+            
+            stbsp_sprintf(buffer, "```%s\n", language);
+            benchmark_add(markdown, buffer);
+            
+            int num_lines = 5 + benchmark_random(generator, 25);
+            for(int i = 0; i < num_lines; i++)
+            {
+                int indentation = benchmark_random(generator, 3) * 4;
+                for(int j = 0; j < indentation; j++) benchmark_add(markdown, " ");
+                
+                stbsp_sprintf(buffer, "%s_%s = %s(%u, \"%s\", 0x%x) + %u.%u;", benchmark_random_word(generator), benchmark_random_word(generator),
+                              benchmark_random_word(generator), benchmark_random(generator, 1000), benchmark_random_word(generator),
+                              benchmark_random(generator, 4096), benchmark_random(generator, 100), benchmark_random(generator, 100));
+                benchmark_add(markdown, buffer);
+                
+                if(benchmark_random(generator, 4) == 0)
+                {
+                    stbsp_sprintf(buffer, " %s ", comment);
+                    benchmark_add(markdown, buffer);
+                    benchmark_add_words(generator, markdown, 2 + benchmark_random(generator, 8));
+                }
+                
+                benchmark_add(markdown, "\n");
+            }
+            
+            benchmark_add(markdown, "```\n\n");
+        } break;
+        
+        case BENCHMARK_TABLE:
+        {
+            int num_columns = 2 + benchmark_random(generator, 5);
+            int num_rows    = 2 + benchmark_random(generator, 12);
+            
+            for(int row = 0; row < num_rows; row++)
+            {
+                for(int column = 0; column < num_columns; column++)
+                {
+                    benchmark_add(markdown, column ? " | " : "| ");
+                    
+                    if(!row)
+                    {
+                        stbsp_sprintf(buffer, "*%s*", benchmark_random_word(generator));
+                        benchmark_add(markdown, buffer);
+                    }
+                    else benchmark_add_sentence_text(generator, markdown, 1 + benchmark_random(generator, 4));
+                }
+                
+                benchmark_add(markdown, "\n");
+            }
+            
+            benchmark_add(markdown, "\n");
+        } break;
+        
+        case BENCHMARK_LINK_REFERENCES:
+        {
+            // NOTE: a paragraph that uses references, some of which are only defined later on, then a few definitions.
+            
+            int num_links = 3 + benchmark_random(generator, 8);
+            for(int i = 0; i < num_links; i++)
+            {
+                int reference_index = benchmark_random(generator, generator->num_link_references + 8);
+                
+                benchmark_add_sentence_text(generator, markdown, 3 + benchmark_random(generator, 10));
+                stbsp_sprintf(buffer, " [%s %s][reference-%d] ", benchmark_random_word(generator), benchmark_random_word(generator), reference_index);
+                benchmark_add(markdown, buffer);
+            }
+            benchmark_add(markdown, "\n\n");
+            
+            int num_definitions = 2 + benchmark_random(generator, 5);
+            for(int i = 0; i < num_definitions; i++)
+            {
+                stbsp_sprintf(buffer, "[reference-%d]: https://example.com/%s/%d \"%s\"\n", generator->num_link_references,
+                              benchmark_random_word(generator), generator->num_link_references, benchmark_random_word(generator));
+                benchmark_add(markdown, buffer);
+                
+                generator->num_link_references++;
+            }
+            benchmark_add(markdown, "\n");
+        } break;
+        
+        case BENCHMARK_LIST:
+        {
+            unsigned int list_kind = benchmark_random(generator, 3);
+            
+            int num_items = 3 + benchmark_random(generator, 10);
+            for(int i = 0; i < num_items; i++)
+            {
+                if(i && benchmark_random(generator, 5) == 0) benchmark_add(markdown, "    ");
+                
+                if     (list_kind == 0) benchmark_add(markdown, "- ");
+                else if(list_kind == 1) benchmark_add(markdown, "1. ");
+                else                    benchmark_add(markdown, benchmark_random(generator, 2)? "- [x] " : "- [ ] ");
+                
+                benchmark_add_sentence_text(generator, markdown, 2 + benchmark_random(generator, 15));
+                benchmark_add(markdown, "\n");
+            }
+            
+            benchmark_add(markdown, "\n");
+        } break;
+        
+        default: break;
+    }
+}
+
+static void benchmark_generate_corpus(Benchmark_Mix* mix, long long size, int file_size, unsigned long long seed, Ofd_Array* result_files, Ofd_Array* result_filepaths)
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: result_files gets an Ofd_String per markdown file and result_filepaths their names. Files are the data of Ofd_Arrays and
+    // names come from ofd_allocate(), see benchmark_free_corpus().
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    ofd_array_init(result_files,     sizeof(Ofd_String));
+    ofd_array_init(result_filepaths, sizeof(char*));
+    
+    Benchmark_Generator generator = {0};
+    generator.random_state = seed * 0x9E3779B97F4A7C15ULL + 1; // Must not be 0.
+    
+    int total_weight = 0;
+    for(int i = 0; i < BENCHMARK_BLOCK_KIND_COUNT; i++) total_weight += mix->weights[i];
+    
+    long long corpus_size = 0;
+    while(corpus_size < size)
+    {
+        Ofd_Array markdown;
+        ofd_array_init(&markdown, 1);
+        
+        while(markdown.count < file_size && corpus_size + markdown.count < size)
+        {
+            int weight = benchmark_random(&generator, total_weight);
+            
+            Benchmark_Block_Kind kind = BENCHMARK_PROSE;
+            while(weight >= mix->weights[kind])
+            {
+                weight -= mix->weights[kind];
+                kind++;
+            }
+            
+            benchmark_add_block(&generator, &markdown, kind);
+        }
+        
+        corpus_size += markdown.count;
+        
+        Ofd_String file = {markdown.data, markdown.count};
+        *(Ofd_String*)ofd_array_add_fast(result_files) = file;
+        
+        char* filepath = ofd_allocate(64);
+        stbsp_sprintf(filepath, "%s_%04d.md", mix->name, result_files->count);
+        *(char**)ofd_array_add_fast(result_filepaths) = filepath;
+    }
+}
+
+static void benchmark_free_corpus(Ofd_Array* files, Ofd_Array* filepaths)
+{
+    for(int i = 0; i < files->count; i++)     ofd_tagged_free(((Ofd_String*)files->data)[i].data); // What ofd_free_array() would do.
+    for(int i = 0; i < filepaths->count; i++) ofd_free(((char**)filepaths->data)[i]);
+    
+    ofd_free_array(files);
+    ofd_free_array(filepaths);
+}
+
+static ofd_b8 benchmark_count_output(void* user_data, void* data, int count)
+{
+    *(long long*)user_data += count;
+    return ofd_true;
+}
+
+static long long benchmark_parse_size(char* text)
+{
+    // NOTE: a number of bytes with an optional K, M or G suffix. This returns 0 if text is not one.
+    
+    char* end;
+    long long result = strtoll(text, &end, 10);
+    
+    if     (*end == 'K' || *end == 'k') { result *= 1024;               end++; }
+    else if(*end == 'M' || *end == 'm') { result *= 1024 * 1024;        end++; }
+    else if(*end == 'G' || *end == 'g') { result *= 1024LL * 1024 * 1024; end++; }
+    
+    return (*end || result < 0)? 0 : result;
+}
+
+
+int main(int num_arguments, char** arguments)
+{
+    long long          size      = 8 * 1024 * 1024;
+    long long          file_size = 64 * 1024;
+    int                num_runs  = 3;
+    unsigned long long seed      = 1;
+    
+    char** selected_mixes    = arguments + 1;
+    int    num_selected_mixes = 0;
+    
+    // Parse arguments. START
+    for(int arg_index = 1; arg_index < num_arguments; arg_index++)
+    {
+        char* argument = arguments[arg_index];
+        char* value    = (arg_index + 1 < num_arguments)? arguments[arg_index + 1] : "";
+        
+        if(strcmp(argument, "-size") == 0 || strcmp(argument, "-file_size") == 0)
+        {
+            long long bytes = benchmark_parse_size(value);
+            if(!bytes || (argument[1] == 'f' && bytes > 1024 * 1024 * 1024))
+            {
+                printf("%s expects a size in bytes, optionally followed by K, M or G (e.g. 64K).\n", argument);
+                return -1;
+            }
+            
+            if(argument[1] == 's') size      = bytes;
+            else                   file_size = bytes;
+            
+            arg_index++;
+        }
+        else if(strcmp(argument, "-runs") == 0 || strcmp(argument, "-seed") == 0)
+        {
+            if(atoi(value) <= 0)
+            {
+                printf("%s expects a number greater than 0.\n", argument);
+                return -1;
+            }
+            
+            if(argument[2] == 'u') num_runs = atoi(value);
+            else                   seed     = strtoull(value, NULL, 10);
+            
+            arg_index++;
+        }
+        else if(argument[0] == '-')
+        {
+            printf("Usage: %s [-size <bytes>[K|M|G]] [-file_size <bytes>[K|M|G]] [-runs <number of runs>] [-seed <number>] [corpora...]\n", arguments[0]);
+            printf("Corpora:");
+            for(int i = 0; i < ofd_array_count(benchmark_mixes); i++) printf(" %s", benchmark_mixes[i].name);
+            printf("\n");
+            
+            return argument[1] == 'h' ? 0 : -1;
+        }
+        else
+        {
+            selected_mixes[num_selected_mixes] = argument;
+            num_selected_mixes++;
+        }
+    }
+    // Parse arguments. END
+    
+    
+    ofd_register_builtin_languages(); // So that registering languages is not counted in the first corpus.
+    
+    Ofd_Theme theme = {0}; // The theme only changes the CSS.
+    
+    printf("corpus,input_bytes,num_files,output_bytes,best_seconds,mb_per_second,allocations,allocated_bytes,peak_heap_bytes,peak_rss_kb\n");
+    fflush(stdout);
+    
+    for(int mix_index = 0; mix_index < ofd_array_count(benchmark_mixes); mix_index++)
+    {
+        Benchmark_Mix* mix = benchmark_mixes + mix_index;
+        
+        if(num_selected_mixes)
+        {
+            ofd_b8 is_selected = ofd_false;
+            for(int i = 0; i < num_selected_mixes; i++) is_selected |= (strcmp(selected_mixes[i], mix->name) == 0);
+            if(!is_selected) continue;
+        }
+        
+        Ofd_Array files, filepaths;
+        benchmark_generate_corpus(mix, size, (int)file_size, seed, &files, &filepaths);
+        
+        long long input_bytes = 0;
+        for(int i = 0; i < files.count; i++) input_bytes += ((Ofd_String*)files.data)[i].count;
+        
+        benchmark_reset_peak_rss();
+        
+        double    best_seconds    = 0;
+        long long output_bytes    = 0;
+        long long num_allocations = 0;
+        long long allocated_bytes = 0;
+        long long peak_heap_bytes = 0;
+        
+        for(int run_index = 0; run_index <= num_runs; run_index++)
+        { // The first run only warms things up.
+            ofd_reset_allocation_stats();
+            ofd_count_allocations(ofd_true);
+            
+            Ofd_Allocation_Stats stats_before;
+            ofd_get_allocation_stats(&stats_before);
+            
+            output_bytes = 0;
+            
+            Ofd_Writer writer;
+            ofd_writer_init(&writer, benchmark_count_output, &output_bytes);
+            
+            Ofd_Array log_data;
+            
+            double start = benchmark_get_seconds();
+            
+            ofd_generate_documentation_to_writer((Ofd_String*)files.data, (char**)filepaths.data, files.count, &writer, theme, NULL, NULL, mix->name, &log_data);
+            ofd_close_writer(&writer);
+            
+            double seconds = benchmark_get_seconds() - start;
+            
+            ofd_free_array(&log_data);
+            
+            Ofd_Allocation_Stats stats;
+            ofd_get_allocation_stats(&stats);
+            ofd_count_allocations(ofd_false);
+            
+            if(run_index && (run_index == 1 || seconds < best_seconds)) best_seconds = seconds;
+            num_allocations = 0;
+            allocated_bytes = 0;
+            for(int tag = 0; tag < OFD_ALLOCATION_TAG_COUNT; tag++)
+            {
+                num_allocations += (long long)stats.tags[tag].num_allocations;
+                allocated_bytes += (long long)stats.tags[tag].num_allocated_bytes;
+            }
+            peak_heap_bytes = ofd_max(peak_heap_bytes, (long long)(stats.peak_live_bytes - stats_before.num_live_bytes));
+        }
+        
+        double mb_per_second = best_seconds > 0 ? ((double)input_bytes / (1024.0 * 1024.0)) / best_seconds : 0;
+        
+        printf("%s,%lld,%d,%lld,%.6f,%.2f,%lld,%lld,%lld,%lld\n", mix->name, input_bytes, files.count, output_bytes, best_seconds, mb_per_second,
+               num_allocations, allocated_bytes, peak_heap_bytes, benchmark_get_peak_rss_in_kb());
+        fflush(stdout);
+        
+        benchmark_free_corpus(&files, &filepaths);
+    }
+    
+    return 0;
+}
@@ -21,6 +21,10 @@ extern "C" {
         ofd_generate_documentation_from_memory()
     
     The first one handles file I/O whereas the second one lets you handle that yourself.
+    If you would rather receive the HTML as it is generated (to stream it somewhere without keeping the whole page in memory) use
+    ofd_generate_documentation_to_writer() with an Ofd_Writer.
+    To regenerate the same documentation whenever its files change (like ofd -watch does), keep an Ofd_Documentation and call
+    ofd_update_documentation() every time: it only redoes what changed and replaces the output file atomically.
     If you do not need file I/O you can #define OFD_NO_FILE_IO before including this file.
     
     This library uses several utility routines from the C runtime. If you would like to cut dependency on the C runtime you can #define them yourself.
@@ -35,31 +39,54 @@ extern "C" {
     
     
     -=-=- Syntax highlighting in code blocks -=-=-
-    If you want to add a language to the syntax highlighter check ofd_apply_syntax_highlighting(). If the language you want to add happens to be similar to C
-    then you can use ofd_apply_c_syntax_highlighting() directly; all you have to do is provide it with a list of keywords and comment indicators.
+    If you want to add a language to the syntax highlighter fill an Ofd_Language and pass it to ofd_register_language(), you can find the built-in ones in
+    ofd_register_builtin_languages(). If the language you want to add happens to be similar to C then all you have to do is provide it with a list of keywords
+    and comment indicators, it will be highlighted by ofd_highlight_c_like_chunk(). Such a language can also come from a language definition file, see
+    ofd_parse_language_definition().
     In any other case you will have to write your own parser. You can take inspiration from the existing parsers if you want. There are a few basic routines that
     can help you deal with simple elements like string/number literals and keywords.
+    Highlighters take code blocks in chunks (see Ofd_Highlight_Callback), so you can also highlight a listing as it streams in with ofd_feed_highlighter().
     
     
     -=-=- Note on speed -=-=-
-    Right now the library is not optimised for speed. I do not have relevant speed data so if you find it too slow for your use case feel free to open
-    an issue or make a pull request. One thing to note though, you can have an impact on speed if you decide to use a fast allocator for ofd_allocate()
-    (we default on malloc() if you do not provide your own allocator).
+    The library tries to keep generation fast, the parts that matter most are listed below. markdown_benchmark.c and highlighter_benchmark.c
+    measure the parser and the highlighters, if you still find it too slow for your use case feel free to open an issue or make a pull request.
+    You can also have an impact on speed by using a fast allocator for ofd_allocate() (we default on malloc() if you do not provide your own allocator).
+    Temporary memory used while generating documentation comes from an Ofd_Arena, which only calls ofd_allocate() once per block and releases
+    everything at the end of the run with ofd_free_arena(). Arrays can live in an arena too, see ofd_array_init_in_arena().
+    Markdown files are parsed on several threads at once and then stitched together in order (see ofd_run_jobs() and OFD_NO_THREADS).
+    Code blocks are highlighted on several threads too, once parsing is done (see Ofd_Code_Block).
+    When the same documentation is generated again and again, ofd_open_highlight_cache() and ofd_open_file_cache() keep highlighted code
+    blocks and parsed files on disk so that a run only redoes the files that changed.
+    To see where the time goes turn stats on with ofd_begin_stats() and read them with ofd_write_stats_report(). For a timeline of a
+    run use ofd_begin_trace() and ofd_write_trace(). #define OFD_ALLOCATION_STATS to also count allocations by call site, and on Linux
+    call ofd_open_hardware_counters() first for cycles, instructions and misses in every phase.
 */
 
 #ifndef ofd_static
 #define ofd_static
 #endif
 
+#if defined(_MSC_VER)
+#define ofd_force_inline static __forceinline
+#elif defined(__GNUC__) || defined(__clang__)
+#define ofd_force_inline static inline __attribute__((always_inline))
+#else
+#define ofd_force_inline static
+#endif
+
 
 #define ofd_cast(_v, _type) ((_type)(_v))
 #define ofd_array_count(_array) (sizeof(_array)/sizeof(_array[0]))
 #define ofd_min(_a, _b) ((_a) < (_b)? (_a) : (_b))
 #define ofd_max(_a, _b) ((_a) > (_b)? (_a) : (_b))
 
-typedef unsigned char ofd_b8;
-typedef unsigned char ofd_u8;
+typedef unsigned char      ofd_b8;
+typedef unsigned char      ofd_u8;
+typedef unsigned int       ofd_u32;
+typedef unsigned long long ofd_u64;
 typedef float         ofd_f32;
+typedef double        ofd_f64;
 
 #define ofd_true  1
 #define ofd_false 0
@@ -122,9 +149,69 @@ typedef float         ofd_f32;
 #define ofd_printf(_format, ...) printf(_format, __VA_ARGS__)
 #endif
 
+// ofd_map_whole_file() maps files into memory where it can, #define OFD_NO_MMAP to always read them with <stdio.h>.
+#if !defined(OFD_NO_MMAP) && (defined(__linux__) || defined(__APPLE__))
+#define OFD_USE_MMAP
+#endif
+
 #endif // OFD_NO_FILE_IO
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// NOTE: hot scanning loops use SSE2 (and AVX2 if you compile for it) when the compiler targets it.
+// #define OFD_NO_SIMD to use plain C only.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(OFD_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define OFD_USE_SSE2
+
+#ifdef __AVX2__
+#define OFD_USE_AVX2
+#endif
+#endif
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// NOTE: some of the work is spread over several threads, see ofd_run_jobs(). #define OFD_NO_THREADS to do everything on the
+// calling thread. If you provide your own ofd_allocate() and ofd_free() they must be thread-safe unless you do so.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef OFD_MAX_THREADS
+#define OFD_MAX_THREADS 64
+#endif
+
+#ifndef OFD_NO_THREADS
+#if defined(_WIN32) || defined(_WIN64)
+#define OFD_USE_WIN32_THREADS
+#else
+#define OFD_USE_PTHREADS
+#endif
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// NOTE: Ofd_Stats reads the clocks of the platform, see ofd_get_wall_time(). Anywhere else it falls back on clock().
+// On Linux it can also read hardware counters with perf_event_open(), #define OFD_NO_HARDWARE_COUNTERS to leave them out.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined(_WIN32) || defined(_WIN64)
+#define OFD_USE_WIN32_CLOCKS
+#elif defined(__unix__) || defined(__APPLE__)
+#define OFD_USE_POSIX_CLOCKS
+#endif
+
+#if defined(__linux__) && !defined(OFD_NO_HARDWARE_COUNTERS)
+#define OFD_USE_PERF_EVENTS
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// NOTE: highlighted code is written with one <div class='ofd-syntax ofd-syntax-keyword'> per token. #define
+// OFD_COMPACT_SYNTAX_MARKUP to get short inline elements (<span class=ofd-k>) instead, where adjacent tokens of the same kind
+// share one element. That makes pages with a lot of code much smaller but themes that style .ofd-syntax-* no longer apply.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
 ///////////////
 // Utility API.
 
@@ -152,6 +239,131 @@ ofd_static Ofd_String ofd_cleanup_section_name(Ofd_String name, char* result_mem
 
 ofd_static Ofd_String ofd_make_section_id(Ofd_String section_name, char* result_memory);
 
+ofd_static int ofd_get_first_set_bit(unsigned int mask);
+
+ofd_static unsigned int ofd_hash_string(Ofd_String s);
+
+ofd_static ofd_u64 ofd_hash_64(ofd_u64 hash, void* data, int count); // Pass OFD_HASH_64_START as hash for a new hash, or a previous result to continue it.
+#define OFD_HASH_64_START 14695981039346656037ull
+
+ofd_static void ofd_hash_128(ofd_u64* hash, void* data, int count); // hash points to 2 values, same as above with OFD_HASH_128_START_0/1 for a new hash.
+#define OFD_HASH_128_START_0 0x243F6A8885A308D3ull
+#define OFD_HASH_128_START_1 0x13198A2E03707344ull
+
+
+typedef enum
+{
+    OFD_ALLOCATION_ARRAY,           // Arrays that have no tag of their own, see Ofd_Array.
+    OFD_ALLOCATION_FILTER,          // Arrays growing in ofd_array_add_filtered_text().
+    OFD_ALLOCATION_LINK_CSS,        // Additional CSS of links and link references.
+    OFD_ALLOCATION_LIST_WHITESPACE, // Indentation of nested list items.
+    OFD_ALLOCATION_SECTIONS,        // Sections and their strings.
+    OFD_ALLOCATION_ARENA,           // Arena blocks.
+    OFD_ALLOCATION_FILES,           // Files read into memory and per-file bookkeeping.
+    OFD_ALLOCATION_HIGHLIGHT_CACHE,
+    OFD_ALLOCATION_FILE_CACHE,      // Entries and records of the file cache.
+    OFD_ALLOCATION_LANGUAGES,       // Language definitions.
+    
+    OFD_ALLOCATION_TAG_COUNT,
+} Ofd_Allocation_Tag;
+
+typedef struct
+{
+    ofd_u64 num_allocations;
+    ofd_u64 num_allocated_bytes;
+    ofd_u64 num_copies;       // Arrays moved to bigger memory by ofd_array_grow(), on the heap or in an arena.
+    ofd_u64 num_copied_bytes;
+} Ofd_Allocation_Counts;
+
+typedef struct
+{
+    Ofd_Allocation_Counts tags[OFD_ALLOCATION_TAG_COUNT];
+    
+    ofd_u64 num_live_bytes; // Allocated and not freed yet.
+    ofd_u64 peak_live_bytes;
+} Ofd_Allocation_Stats;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// NOTE: #define OFD_ALLOCATION_STATS to count what the library allocates through ofd_allocate() and copies in ofd_array_grow(), by
+// call site. Every allocation then carries a 16-byte header, so memory the library allocates must be freed by the library.
+// Counting is thread-safe and only happens while it is turned on with ofd_count_allocations(), which ofd_begin_stats() and
+// ofd_end_stats() do, so the rest of the time it costs the header and one check per allocation. Live bytes only cover
+// allocations made while counting. Without OFD_ALLOCATION_STATS everything stays at 0.
+ofd_static void ofd_count_allocations(ofd_b8 count);
+
+ofd_static void ofd_get_allocation_stats(Ofd_Allocation_Stats* result);
+
+ofd_static void ofd_reset_allocation_stats(void); // Counts go back to 0 and the peak to what is live right now.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#define OFD_ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+
+typedef struct Ofd_Arena_Block
+{
+    struct Ofd_Arena_Block* previous;
+    int size; // This does not include the block header.
+    int used;
+} Ofd_Arena_Block;
+
+typedef struct
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: this is a bump allocator. Blocks are requested with ofd_allocate() and everything allocated from the arena is released at once with
+    // ofd_free_arena(). Use ofd_arena_get_marker() and ofd_arena_reset_to_marker() to release temporary memory early.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    Ofd_Arena_Block* current_block;
+    Ofd_Arena_Block* free_blocks; // Blocks released by ofd_arena_reset_to_marker() that we can reuse.
+    int block_size;
+} Ofd_Arena;
+
+typedef struct
+{
+    Ofd_Arena_Block* block;
+    int used;
+} Ofd_Arena_Marker;
+
+ofd_static void ofd_arena_init(Ofd_Arena* arena, int block_size);
+
+ofd_static void* ofd_arena_allocate(Ofd_Arena* arena, int size);
+
+ofd_static void* ofd_arena_resize(Ofd_Arena* arena, void* memory, int old_size, int new_size);
+
+ofd_static void ofd_arena_release(Ofd_Arena* arena, void* memory, int size);
+
+ofd_static Ofd_Arena_Marker ofd_arena_get_marker(Ofd_Arena* arena);
+
+ofd_static void ofd_arena_reset_to_marker(Ofd_Arena* arena, Ofd_Arena_Marker marker);
+
+ofd_static void ofd_free_arena(Ofd_Arena* arena);
+
+
+typedef void Ofd_Job_Callback(void* user_data, int job_index);
+
+ofd_static int ofd_get_num_cpu_cores(void);
+
+ofd_static ofd_u64 ofd_get_thread_id(void); // This is only meant to tell threads apart.
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// NOTE: this calls callback once for every job index in [0, num_jobs) and returns once they are all done. Jobs are taken
+// in order by up to OFD_MAX_THREADS threads (the calling thread included) so they must not depend on each other.
+ofd_static void ofd_run_jobs(Ofd_Job_Callback* callback, void* user_data, int num_jobs);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct
+{ // A CRITICAL_SECTION or a pthread_mutex_t, kept opaque so that the declarations do not need the platform headers.
+    ofd_u64 storage[8];
+} Ofd_Mutex;
+
+ofd_static void ofd_mutex_init(Ofd_Mutex* mutex);
+
+ofd_static void ofd_mutex_lock(Ofd_Mutex* mutex);
+
+ofd_static void ofd_mutex_unlock(Ofd_Mutex* mutex);
+
+ofd_static void ofd_free_mutex(Ofd_Mutex* mutex);
+
 
 typedef struct
 {
@@ -159,12 +371,17 @@ typedef struct
     int   item_size;
     int   count;
     int   max_count;
+    int   allocation_tag; // Ofd_Allocation_Tag, what its memory counts as. ofd_array_init() makes it OFD_ALLOCATION_ARRAY.
+    
+    Ofd_Arena* arena; // If this is NULL the array lives on the heap, otherwise it lives in the arena and does not need to be freed.
 } Ofd_Array;
 
 ofd_static void ofd_array_grow(Ofd_Array* array, int new_count);
 
 ofd_static void ofd_array_init(Ofd_Array* array, int item_size);
 
+ofd_static void ofd_array_init_in_arena(Ofd_Array* array, int item_size, Ofd_Arena* arena);
+
 ofd_static void ofd_array_init_with_space(Ofd_Array* array, int item_size, int num_items_to_preallocate);
 
 ofd_static void* ofd_array_add_fast(Ofd_Array* array);
@@ -182,8 +399,67 @@ ofd_static void ofd_free_array(Ofd_Array* array);
 ofd_static ofd_b8 ofd_read_whole_file(char* filepath, Ofd_String* result);
 
 ofd_static ofd_b8 ofd_write_whole_file(char* filepath, void* data, int count);
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// NOTE: ofd_map_whole_file() maps the file into memory instead of copying it when it is a regular file and the OS lets us,
+// otherwise it falls back to ofd_read_whole_file() (pipes, empty files, OFD_NO_MMAP...).
+// Either way the result must be given back with ofd_release_whole_file() along with result_is_mapped, never ofd_free().
+// Mapped data is read-only.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+ofd_static ofd_b8 ofd_map_whole_file(char* filepath, Ofd_String* result, ofd_b8* result_is_mapped);
+
+ofd_static void ofd_release_whole_file(Ofd_String* file, ofd_b8 is_mapped);
+#endif // OFD_NO_FILE_IO
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// NOTE: an Ofd_Writer is where generated HTML goes. It can write to a file, append to an Ofd_Array or call your own callback.
+// Small writes are gathered in the writer's buffer and handed to the callback in big chunks, call ofd_close_writer() once
+// you are done to flush what is left. The callback returns ofd_false if it failed, in which case subsequent writes are
+// ignored and ofd_close_writer() returns ofd_false.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define OFD_WRITER_BUFFER_SIZE (16 * 1024)
+
+typedef ofd_b8 Ofd_Write_Callback(void* user_data, void* data, int count);
+
+typedef struct
+{
+    Ofd_Write_Callback* callback;
+    void*               user_data;
+    
+    char buffer[OFD_WRITER_BUFFER_SIZE];
+    int  buffer_count;
+    
+    ofd_b8  failed;
+    void*   file;      // Only used by ofd_writer_init_with_file(), ofd_close_writer() closes it.
+    ofd_u64 num_bytes; // Everything that went through ofd_writer_add() so far.
+    
+    char* replaced_filepath;  // Only used by ofd_writer_init_with_file_replacement(), ofd_close_writer() moves
+    char* temporary_filepath; // the temporary file over the replaced one.
+} Ofd_Writer;
+
+ofd_static void ofd_writer_init(Ofd_Writer* writer, Ofd_Write_Callback* callback, void* user_data);
+
+ofd_static void ofd_writer_init_with_array(Ofd_Writer* writer, Ofd_Array* array); // array must be initialised.
+
+#ifndef OFD_NO_FILE_IO
+ofd_static ofd_b8 ofd_writer_init_with_file(Ofd_Writer* writer, char* filepath);
+
+// NOTE: same as ofd_writer_init_with_file() but the data goes to filepath.tmp first and ofd_close_writer() moves it over
+// filepath, so anyone reading filepath meanwhile sees either the old file or the whole new one. filepath must stay valid
+// until ofd_close_writer(), which must be called even if this fails.
+ofd_static ofd_b8 ofd_writer_init_with_file_replacement(Ofd_Writer* writer, char* filepath);
 #endif // OFD_NO_FILE_IO
 
+ofd_static void ofd_writer_add(Ofd_Writer* writer, void* data, int count);
+
+ofd_static void ofd_writer_add_string(Ofd_Writer* writer, Ofd_String string);
+
+ofd_static ofd_b8 ofd_writer_flush(Ofd_Writer* writer);
+
+ofd_static ofd_b8 ofd_close_writer(Ofd_Writer* writer);
+
 
 typedef struct
 {
@@ -229,28 +505,25 @@ typedef struct
 
 typedef struct
 {
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: strings are stored as offsets into a separate string pool (see ofd_add_section()) so that sections stay small.
+    // Identical strings are stored once, e.g. the full ID of a root section is its ID.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
     int id;
     int hierarchy; // 0 is the highest hierarchy. 1-6 is for markdown headers, 0 means this is a markdown file.
+    
+    int name_offset;
     int name_count;
+    int id_offset;
     int id_count;
+    int full_id_offset;
     int full_id_count;
-    
-    char name_memory[OFD_MAX_SECTION_NAME_COUNT];
-    char id_memory[OFD_MAX_SECTION_NAME_COUNT];
-    char full_id_memory[OFD_MAX_SECTION_NAME_COUNT];
 } Ofd_Section;
 
-typedef enum {
-    OFD_LESS_THAN_BRACKET    = 0x01,
-    OFD_GREATER_THAN_BRACKET = 0x02,
-    OFD_LINK                 = 0x04,
-} Ofd_Filter_Type;
+ofd_static Ofd_String ofd_get_section_string(Ofd_Array* section_strings, int offset, int count);
 
-typedef struct
-{
-    Ofd_String      text;
-    Ofd_Filter_Type type;
-} Ofd_Element_To_Filter;
+ofd_static Ofd_Section* ofd_add_section(Ofd_Array* sections, Ofd_Array* section_strings, Ofd_String name, int id, int hierarchy, ofd_b8 also_remove_leading_number);
 
 typedef struct
 {
@@ -260,7 +533,29 @@ typedef struct
     Ofd_Array additional_css;
 } Ofd_Link_Reference;
 
-ofd_static ofd_b8 ofd_filter_plain_text(Ofd_String* text);
+typedef struct Ofd_Link_Reference_Table
+{
+    Ofd_Array references; // Ofd_Link_Reference
+    Ofd_Array slots;      // Hash index into references: index + 1 of a reference, 0 for an empty slot. The count is a power of two.
+    
+    struct Ofd_Link_Reference_Table* parent; // Looked up when an ID is not found in this table, never modified through it.
+    
+    Ofd_Array* lookups; // Ofd_String, when this is not NULL every ID looked up in this table is added to it. The file cache needs them.
+} Ofd_Link_Reference_Table;
+
+ofd_static void ofd_link_reference_table_init(Ofd_Link_Reference_Table* table, Ofd_Link_Reference_Table* parent, Ofd_Arena* arena);
+
+ofd_static Ofd_Link_Reference* ofd_find_link_reference(Ofd_Link_Reference_Table* table, Ofd_String id);
+
+ofd_static Ofd_Link_Reference* ofd_add_link_reference(Ofd_Link_Reference_Table* table, Ofd_Link_Reference reference); // This does not check for duplicates.
+
+ofd_static char* ofd_parse_link_reference(char* c, char* limit, Ofd_Link_Reference* result, Ofd_Arena* arena);
+
+ofd_static void ofd_find_link_references(char* c, char* limit, Ofd_Link_Reference_Table* link_references, Ofd_Arena* arena);
+
+ofd_static char* ofd_find_character_to_filter(char* c, char* limit);
+
+ofd_static void ofd_array_add_filtered_text(Ofd_Array* destination, Ofd_String text);
 
 ofd_static char* ofd_skip_whitespace(char* c, char* limit);
 
@@ -268,43 +563,340 @@ ofd_static Ofd_String ofd_get_line_view(char* c, char* lower_limit, char* upper_
 
 ofd_static void ofd_log_error(Ofd_Array* log_data, Ofd_String line_view, Ofd_String message);
 
-ofd_static char* ofd_parse_link(char* c, char* limit, Ofd_Array* link_references, Ofd_String* result_name, Ofd_String* result_address, Ofd_String* result_title, Ofd_Array* additional_css, Ofd_Array* log_data);
+ofd_static char* ofd_parse_link(char* c, char* limit, Ofd_Link_Reference_Table* link_references, Ofd_String* result_name, Ofd_String* result_address, Ofd_String* result_title, Ofd_Array* additional_css, Ofd_Arena* arena, Ofd_Array* log_data);
 
 ofd_static char* ofd_maybe_handle_a_horizontal_rule(char* c, char* limit, char indicator, Ofd_Array* result_html, Ofd_String* text_to_spill);
 
 ofd_static char* ofd_get_next_character_like_in_line(char* c, char* limit, char wanted, char** result_line_end);
 
+ofd_static char* ofd_find_markdown_special_character(char* c, char* limit);
+
 
 ///////////////////////////
 // Syntax highlighting API.
 
+#define OFD_KEYWORD_SET_SIZE 512 // Number of slots in an Ofd_Keyword_Set. This must be a power of two.
+
+typedef struct
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: a hash set of keywords, see ofd_keyword_set_init(). Keywords are not copied so they must outlive the set.
+    // Sets with more than OFD_KEYWORD_SET_SIZE / 2 keywords are not hashed and are searched linearly instead.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    const Ofd_String* keywords;
+    int               num_keywords;
+    
+    unsigned int   length_mask; // Bit n is set if a keyword is n characters long (31 for longer ones), most words are rejected with this alone.
+    ofd_b8         is_hashed;
+    unsigned short slots[OFD_KEYWORD_SET_SIZE]; // Index + 1 of a keyword, 0 for an empty slot.
+} Ofd_Keyword_Set;
+
+ofd_static void ofd_keyword_set_init(Ofd_Keyword_Set* set, const Ofd_String* keywords, int num_keywords);
+
+ofd_static ofd_b8 ofd_keyword_set_contains(Ofd_Keyword_Set* set, Ofd_String word);
+
+typedef enum
+{
+    OFD_SYNTAX_CLASS_COMMENT,
+    OFD_SYNTAX_CLASS_STRING,
+    OFD_SYNTAX_CLASS_NUMBER,
+    OFD_SYNTAX_CLASS_STRUCTURE,
+    OFD_SYNTAX_CLASS_KEYWORD,
+    OFD_SYNTAX_CLASS_DIRECTIVE,
+    
+    OFD_SYNTAX_CLASS_COUNT,
+} Ofd_Syntax_Class;
+
+#define OFD_SYNTAX_MAX_MERGED_TOKEN_SIZE 256 // Tokens are only merged with the previous one while it is shorter than this, see ofd_syntax_begin_token().
+
+ofd_static void ofd_syntax_begin_token(Ofd_Array* result_html, Ofd_Syntax_Class syntax_class);
+
+ofd_static void ofd_syntax_end_token(Ofd_Array* result_html);
+
+ofd_static void ofd_syntax_add_token(Ofd_Array* result_html, Ofd_Syntax_Class syntax_class, Ofd_String token);
+
 ofd_static void ofd_syntax_insert_token(Ofd_Array* result_html, Ofd_String token);
 
-ofd_static void ofd_syntax_spill_basic_text(Ofd_Array* result_html, Ofd_String* basic_text, const Ofd_String* keywords, int num_keywords);
+ofd_static void ofd_syntax_spill_basic_text(Ofd_Array* result_html, Ofd_String* basic_text, Ofd_Keyword_Set* keywords);
 
 ofd_static void ofd_syntax_spill_basic_text_no_keywords(Ofd_Array* result_html, Ofd_String* basic_text);
 
+ofd_static char* ofd_syntax_find_first_of(char* c, char* limit, char a, char b, char d);
+
+ofd_static char* ofd_syntax_skip_string(char* c, char* limit, char delimiter, ofd_b8 is_last_chunk, ofd_b8* result_reached_the_end);
+
 ofd_static char* ofd_syntax_handle_string(Ofd_Array* result_html, char* c, char* limit);
 
 ofd_static char* ofd_syntax_handle_number(Ofd_Array* result_html, char* c, char* limit);
 
+typedef enum
+{
+    OFD_SYNTAX_NO_MATCH,
+    OFD_SYNTAX_MATCH,
+    OFD_SYNTAX_NEEDS_MORE_TEXT,
+} Ofd_Syntax_Match;
+
+ofd_static Ofd_Syntax_Match ofd_syntax_match(char* c, char* limit, Ofd_String wanted, ofd_b8 is_last_chunk);
+
+ofd_static char* ofd_syntax_write_unfinished_token(Ofd_Array* result_html, char* token_start, char* c);
+
 
 typedef enum
 {
     OFD_SUPPORTS_NESTED_MULTI_LINE_COMMENTS = 0x01,
     OFD_BACKTICK_IS_A_STRING                = 0x02,
     OFD_THIS_IS_RUST                        = 0x02,
+    OFD_NO_DIRECTIVES                       = 0x04, // '#' is an operator rather than the start of a directive like #include.
 } Ofd_Syntax_Flags;
 
 ofd_static void ofd_apply_c_syntax_highlighting(Ofd_Array* result_html, Ofd_String text, Ofd_String single_line_comment_start, Ofd_String multi_line_comment_start, Ofd_String multi_line_comment_end, const Ofd_String* keywords, int num_keywords, Ofd_Syntax_Flags flags);
 
+
+
+typedef enum
+{
+    OFD_SYNTAX_CHARACTER_OTHER,
+    OFD_SYNTAX_CHARACTER_LETTER,
+    OFD_SYNTAX_CHARACTER_DIGIT,
+    OFD_SYNTAX_CHARACTER_DOT,
+    OFD_SYNTAX_CHARACTER_STRUCTURE,
+    OFD_SYNTAX_CHARACTER_DIRECTIVE,
+    OFD_SYNTAX_CHARACTER_LESS_THAN,
+    OFD_SYNTAX_CHARACTER_NEW_LINE,
+    OFD_SYNTAX_CHARACTER_WHITESPACE,
+    OFD_SYNTAX_CHARACTER_QUOTE,
+    OFD_SYNTAX_CHARACTER_BACKTICK,
+    OFD_SYNTAX_CHARACTER_OPERATOR,
+    
+    OFD_SYNTAX_CHARACTER_CONTINUES_A_NUMBER = 0x40, // Combined with one of the above for the characters that can follow the start of a number.
+    OFD_SYNTAX_CHARACTER_STARTS_A_COMMENT   = 0x80, // Combined with one of the above for the first character of a comment indicator.
+} Ofd_Syntax_Character_Class;
+
+
+#define OFD_MAX_LANGUAGES          64
+#define OFD_MAX_LANGUAGE_ALIASES   4
+#define OFD_LANGUAGE_ALIASES_SLOTS 512 // This must be a power of two, bigger than OFD_MAX_LANGUAGES * OFD_MAX_LANGUAGE_ALIASES.
+
+typedef struct Ofd_Language Ofd_Language;
+
+typedef enum
+{
+    OFD_HIGHLIGHTING_CODE,
+    OFD_HIGHLIGHTING_SINGLE_LINE_COMMENT,
+    OFD_HIGHLIGHTING_MULTI_LINE_COMMENT,
+    OFD_HIGHLIGHTING_STRING_IN_A_COMMENT,
+    OFD_HIGHLIGHTING_STRING,
+} Ofd_Highlighting_Mode;
+
+typedef struct
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: what a highlighter needs to pick up where the previous chunk of a code block stopped, see ofd_feed_highlighter().
+    // Comments and strings are written as they go so a long one only keeps its last few bytes around. Other tokens are short and are
+    // only written once they are complete.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    Ofd_Language* language;
+    
+    Ofd_Highlighting_Mode mode;
+    int    imbrication_level;    // Of multi-line comments.
+    char   string_delimiter;
+    ofd_b8 directive_is_include; // The line started with #include so its <path> is a string.
+    ofd_b8 we_are_inside_a_tag;  // XML.
+    
+    Ofd_Array pending;                // The end of the text fed so far, which could not be highlighted without what comes next.
+    int       num_scanned_characters; // The start of pending the highlighter already went through, it is part of an unfinished comment or string.
+    char      previous_character;     // The character right before pending, 0 at the start of the code block.
+} Ofd_Highlighter_State;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// NOTE: a highlight callback highlights what it can of text and returns where it stopped, the rest comes back at the start of text with
+// the next chunk. It must leave state->num_scanned_characters at how much of the rest it went through already, and state->mode at
+// OFD_HIGHLIGHTING_CODE unless the rest starts in the middle of a comment or a string. When is_last_chunk is set it must highlight
+// everything. A callback that can only deal with whole code blocks can return text.data until then.
+typedef char* Ofd_Highlight_Callback(Ofd_Highlighter_State* state, Ofd_Array* result_html, Ofd_String text, ofd_b8 is_last_chunk);
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ofd_static void ofd_syntax_finish_token(Ofd_Highlighter_State* state, Ofd_Array* result_html, char* token_start, char* token_end);
+
+ofd_static char* ofd_highlight_c_like_chunk(Ofd_Highlighter_State* state, Ofd_Array* result_html, Ofd_String text, ofd_b8 is_last_chunk);
+
+struct Ofd_Language
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: a language code blocks can be highlighted with, see ofd_register_language(). Code blocks pick a language with the tag that
+    // follows their opening backticks (```c for example), any of the aliases selects the language.
+    // Languages that are similar to C only need comment indicators, keywords and flags. Other languages provide their own highlight
+    // callback, which gets the language back so it can use the same fields if it wants.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    Ofd_String aliases[OFD_MAX_LANGUAGE_ALIASES]; // Unused aliases are left empty.
+    
+    Ofd_String single_line_comment_start;
+    Ofd_String multi_line_comment_start;
+    Ofd_String multi_line_comment_end;
+    
+    const Ofd_String* keywords; // This is not copied so it must outlive the language.
+    int               num_keywords;
+    
+    Ofd_String string_delimiters; // Each character starts and ends strings. Leave data NULL for the default: '"' and '\''.
+    Ofd_String number_characters; // The characters other than digits that can follow the start of a number. Leave data NULL for the default: letters, '.' and '_'.
+    
+    Ofd_Syntax_Flags flags;
+    
+    Ofd_Highlight_Callback* highlight; // NULL to use ofd_highlight_c_like_chunk().
+    
+    Ofd_Keyword_Set keyword_set;            // Built by ofd_prepare_language(), which ofd_register_language() calls.
+    ofd_u8          character_classes[256]; // Same, one Ofd_Syntax_Character_Class per byte value. It drives ofd_highlight_c_like_chunk().
+    ofd_u64         definition_hash;        // Same, this is a hash of everything above but highlight. It tells the highlight cache when a language changed.
+};
+
+ofd_static void ofd_prepare_language(Ofd_Language* language);
+
+ofd_static Ofd_Language* ofd_register_language(Ofd_Language* language);
+
+ofd_static Ofd_Language* ofd_find_language(Ofd_String alias);
+
+ofd_static void ofd_register_builtin_languages(void);
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// NOTE: a language definition describes a language similar to C with the same syntax as themes, one field per line:
+//     aliases                  "zig"                          # Up to OFD_MAX_LANGUAGE_ALIASES, separated with spaces.
+//     single_line_comment      "//"
+//     multi_line_comment_start "/*"
+//     multi_line_comment_end   "*/"
+//     nested_comments          0                              # 1 if multi-line comments can be nested.
+//     strings                  "double_quotes single_quotes"  # Any of double_quotes, single_quotes and backticks.
+//     number_characters        "._xXabcdefABCDEF"             # What can follow the first digit of a number.
+//     directives               0                              # 1 if '#' starts a directive like #include.
+//     keywords                 "const var fn pub return"      # Separated with spaces.
+// Only aliases is required, the default is no comments, '"' and '\'' strings, the default number characters and directives.
+// The strings of result point into data, except result->keywords which is allocated: free it with ofd_free_language_definition().
+// ofd_load_language_definition() reads a file, parses it and registers the language. The file stays in memory for the rest of the
+// run since the language points into it.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+ofd_static ofd_b8 ofd_parse_language_definition(char* data, int data_size, Ofd_Language* result, char* error_message);
+
+ofd_static void ofd_free_language_definition(Ofd_Language* language);
+
+#ifndef OFD_NO_FILE_IO
+ofd_static ofd_b8 ofd_load_language_definition(char* filepath, char* error_message);
+#endif // OFD_NO_FILE_IO
+
+ofd_static char* ofd_highlight_xml_chunk(Ofd_Highlighter_State* state, Ofd_Array* result_html, Ofd_String text, ofd_b8 is_last_chunk);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// NOTE: feed a code block to ofd_feed_highlighter() in chunks of any size as it comes in, ofd_finish_highlighting() then writes what is
+// left and frees the state. The HTML is the same as ofd_highlight_text() gives for the whole block, as long as result_html is not
+// emptied in between: highlighted tokens are merged with the ones right before them when they can.
+ofd_static void ofd_begin_highlighting(Ofd_Highlighter_State* state, Ofd_Language* language);
+
+ofd_static void ofd_feed_highlighter(Ofd_Highlighter_State* state, Ofd_Array* result_html, Ofd_String chunk);
+
+ofd_static void ofd_finish_highlighting(Ofd_Highlighter_State* state, Ofd_Array* result_html);
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ofd_static void ofd_highlight_text(Ofd_Array* result_html, Ofd_String text, Ofd_Language* language);
+
 ofd_static void ofd_apply_syntax_highlighting(Ofd_Array* result_html, Ofd_String text, Ofd_String language);
 
 
+#ifndef OFD_NO_FILE_IO
+#define OFD_HIGHLIGHTER_VERSION           1 // Bump this whenever highlighted HTML changes, it invalidates every highlight cache.
+#define OFD_HIGHLIGHT_CACHE_FILENAME      "highlight_cache.bin"
+#define OFD_DEFAULT_HIGHLIGHT_CACHE_SIZE  (64 * 1024 * 1024)
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// NOTE: the highlight cache keeps the HTML of highlighted code blocks on disk between runs so that blocks that did not change are not
+// highlighted again. Blocks are looked up by a hash of their language, their text and the highlighter version.
+// Open the cache before generating documentation and close it afterwards: ofd_close_highlight_cache() drops the least recently used
+// blocks until the cache fits in max_size bytes and saves it to directory/OFD_HIGHLIGHT_CACHE_FILENAME.
+// With a NULL directory the cache only lives in memory until it is closed, for programs that generate the documentation several
+// times themselves, see ofd_update_documentation().
+// The cache is shared by all threads. Opening and closing it is not thread-safe, looking blocks up is.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+ofd_static ofd_b8 ofd_open_highlight_cache(char* directory, int max_size);
+
+ofd_static void ofd_close_highlight_cache(void);
+
+
+#define OFD_PARSER_VERSION           1 // Bump this whenever parsed markdown changes (HTML, sections or errors), it invalidates every file cache.
+#define OFD_FILE_CACHE_FILENAME      "file_cache.bin"
+#define OFD_DEFAULT_FILE_CACHE_SIZE  (256 * 1024 * 1024)
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// NOTE: the file cache keeps what became of every markdown file (its HTML with highlighted code blocks, its sections, its link reference
+// definitions and its errors) so that files that did not change are neither parsed nor highlighted again, only stitched into the page.
+// Files are looked up by a hash of their name, their content, the registered languages and the parser and highlighter versions. A file
+// is only taken from the cache if the link references it looked up still resolve to the same definitions, see Ofd_File_Cache_Record.
+// It is opened, closed and shared by threads like the highlight cache and lives next to it in directory/OFD_FILE_CACHE_FILENAME, or
+// only in memory with a NULL directory.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+ofd_static ofd_b8 ofd_open_file_cache(char* directory, int max_size);
+
+ofd_static void ofd_close_file_cache(void);
+#endif // OFD_NO_FILE_IO
+
+
 ////////////
 // Main API.
 
-ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html, Ofd_Array* result_sections, Ofd_Array* link_references, int* next_section_id, Ofd_Array* log_data);
+typedef struct
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: a code block ofd_parse_markdown() left for later so that code blocks can be highlighted on several threads at once.
+    // Its highlighted HTML belongs at html_offset in the HTML of the markdown it comes from, see ofd_highlight_code_block().
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    Ofd_String text;
+    Ofd_String language;
+    int        html_offset;
+    Ofd_Array  html;
+    
+    ofd_f64 highlight_wall_seconds; // Only measured while stats are on, see ofd_begin_stats().
+    ofd_f64 highlight_cpu_seconds;
+} Ofd_Code_Block;
+
+ofd_static void ofd_highlight_code_block(Ofd_Code_Block* code_block);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// NOTE: if result_code_blocks is NULL code blocks are highlighted as they are found. Otherwise code blocks that indicate a language
+// are added to it as Ofd_Code_Block and their highlighted HTML is left out of result_html.
+ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html, Ofd_Array* result_code_blocks, Ofd_Array* result_sections, Ofd_Array* section_strings, Ofd_Link_Reference_Table* link_references, int* next_section_id, Ofd_Arena* arena, Ofd_Array* log_data);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: files are parsed on their own (see ofd_parse_markdown_file()) and then stitched together in order. Section IDs start
+    // at 0 for every file.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    Ofd_String markdown;
+    char*      filepath;
+    
+    Ofd_Array html;
+    Ofd_Array code_blocks; // Ofd_Code_Block, they still need to be highlighted after parsing.
+    Ofd_Array sections;
+    Ofd_Array section_strings;
+    Ofd_Array log_data;
+    int       num_section_ids;
+    
+    Ofd_Link_Reference_Table link_references; // Its parent should hold the references of all files, see ofd_find_link_references().
+    Ofd_Array                definitions;     // Ofd_Link_Reference, the ones ofd_find_link_references() found in this file.
+    Ofd_Array                lookups;         // Ofd_String, the link reference IDs parsing looked up. Only gathered for the file cache.
+    Ofd_Arena                arena;
+    
+    Ofd_String cache_record; // What the file cache had for this file, if anything. Parsing is skipped when this is still set afterwards.
+    Ofd_String cached_html;  // Highlighted HTML inside cache_record, it is written from there so html stays empty.
+    ofd_u64    cache_key[2];
+    
+    ofd_f64 parse_wall_seconds; // Only measured while stats are on, see ofd_begin_stats().
+    ofd_f64 parse_cpu_seconds;
+} Ofd_Markdown_File;
+
+ofd_static void ofd_parse_markdown_file(Ofd_Markdown_File* file);
 
 
 
@@ -339,6 +931,7 @@ typedef struct
     Ofd_String logo_path;
     Ofd_String icon_path;
     Ofd_String title;
+    Ofd_String language_filepaths; // Language definition files separated with spaces, wrap a filepath in single quotes if it contains spaces. See ofd_parse_language_definition().
 } Ofd_Config;
 
 ofd_static ofd_b8 ofd_parse_configuration_data(char* data, int data_size, Ofd_Config* result, char* error_message);
@@ -351,76 +944,308 @@ ofd_static ofd_b8 ofd_parse_configuration_data(char* data, int data_size, Ofd_Co
 ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_files, char** markdown_filepaths, int num_markdown_files, Ofd_Array* output, Ofd_Theme theme, char* logo_path, char* icon_path, char* title, Ofd_Array* log_data);
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// NOTE: same as ofd_generate_documentation_from_memory() but the HTML goes through writer as it is generated.
+// The writer is not closed, call ofd_close_writer() yourself. You must free log_data using ofd_free_array().
+ofd_static void ofd_generate_documentation_to_writer(Ofd_String* markdown_files, char** markdown_filepaths, int num_markdown_files, Ofd_Writer* writer, Ofd_Theme theme, char* logo_path, char* icon_path, char* title, Ofd_Array* log_data);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 #ifndef OFD_NO_FILE_IO
 ofd_static ofd_b8 ofd_generate_documentation(char** markdown_filepaths, int num_markdown_files, char* output_filepath, char* theme_filepath, char* logo_path, char* icon_path, char* title);
-#endif // OFD_NO_FILE_IO
-
-#ifdef __cplusplus
-}
-#endif
-#endif // OFD_HEADER
 
 
+typedef struct
+{
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: what ofd_update_documentation() keeps between runs. Start from a zeroed one and free it with
+    // ofd_free_documentation().
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    Ofd_Array head;       // The HTML head and the styles, they only depend on the theme, the icon and the title.
+    Ofd_Array body;       // The sidebar and the content of every markdown file.
+    Ofd_Theme body_theme; // The theme body was generated with.
+    ofd_b8    has_body;
+} Ofd_Documentation;
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// NOTE: same as ofd_generate_documentation() but for programs that regenerate the same documentation again and again (ofd -watch).
+// The page is kept in documentation and the output file is replaced atomically, so a browser reloading it never sees half of it.
+// Pass files_changed = ofd_false when only the theme changed: the markdown files are then left alone unless the theme change reaches
+// the body, only the styles are generated again. Otherwise open the file cache beforehand, in memory if need be (NULL directory), so
+// that only the files that changed are parsed again. logo_path must be the same every time, or files_changed must be ofd_true.
+// Input files are read rather than mapped since they may be edited (and truncated) during the update.
+ofd_static ofd_b8 ofd_update_documentation(Ofd_Documentation* documentation, char** markdown_filepaths, int num_markdown_files, char* output_filepath, char* theme_filepath, char* logo_path, char* icon_path, char* title, ofd_b8 files_changed);
+
+ofd_static void ofd_free_documentation(Ofd_Documentation* documentation);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#endif // OFD_NO_FILE_IO
 
-#ifdef OFD_IMPLEMENTATION
-#ifdef __cplusplus
-extern "C" {
-#endif
 
-ofd_static Ofd_String Ofd_String_(char* c_string)
-{
-    Ofd_String result = {c_string, ofd_strlen(c_string)};
-    return result;
-}
+/////////////
+// Stats API.
 
-ofd_static ofd_b8 ofd_string_matches(Ofd_String a, char* b)
+typedef enum
 {
-    int b_count = ofd_strlen(b);
-    if(a.count != b_count) return ofd_false;
-    
-    return (ofd_memcmp(a.data, b, b_count) == 0);
-}
+    OFD_STATS_PHASE_LOAD,            // Reading the markdown files and the theme, only in ofd_generate_documentation() and ofd_update_documentation().
+    OFD_STATS_PHASE_CSS,             // The HTML head and the styles generated from the theme.
+    OFD_STATS_PHASE_LINK_REFERENCES, // Gathering the link reference definitions of every file.
+    OFD_STATS_PHASE_PARSE,           // Parsing markdown files.
+    OFD_STATS_PHASE_HIGHLIGHT,       // Highlighting code blocks.
+    OFD_STATS_PHASE_STITCH,          // Renumbering sections across files.
+    OFD_STATS_PHASE_SIDEBAR,         // The logo and the sidebar.
+    OFD_STATS_PHASE_WRITE,           // The main content, and closing the output file in ofd_generate_documentation() and ofd_update_documentation().
+    
+    OFD_STATS_PHASE_COUNT,
+} Ofd_Stats_Phase;
 
-ofd_static ofd_b8 ofd_strings_match(Ofd_String a, Ofd_String b)
+typedef enum
 {
-    if(a.count != b.count) return ofd_false;
+    OFD_HARDWARE_COUNTER_CYCLES,
+    OFD_HARDWARE_COUNTER_INSTRUCTIONS,
+    OFD_HARDWARE_COUNTER_BRANCH_MISSES,
+    OFD_HARDWARE_COUNTER_CACHE_MISSES, // Last level cache.
     
-    return (ofd_memcmp(a.data, b.data, a.count) == 0);
-}
+    OFD_HARDWARE_COUNTER_COUNT,
+} Ofd_Hardware_Counter;
 
-ofd_static void ofd_to_c_string(Ofd_String s, char* buffer)
+typedef struct
 {
-    ofd_copy(buffer, s.data, s.count);
-    buffer[s.count] = 0;
-}
+    char*   filepath;
+    int     input_bytes;
+    int     output_bytes; // Its HTML, highlighted code blocks included.
+    int     num_sections;
+    int     num_code_blocks;
+    ofd_b8  is_cached; // It came from the file cache, the parse times below are those of loading it.
+    ofd_f64 parse_wall_seconds;
+    ofd_f64 parse_cpu_seconds;
+    ofd_f64 highlight_wall_seconds; // Added up over its code blocks, they may have been highlighted on several threads at once.
+    ofd_f64 highlight_cpu_seconds;
+} Ofd_File_Stats;
 
-ofd_static Ofd_String ofd_get_last_item_from_filepath(Ofd_String filepath)
+typedef struct
 {
-    char* c     = filepath.data + filepath.count - 1;
-    char* limit = filepath.data;
-    while(c >= limit)
-    {
-        if(*c == '/' || *c == '\\') break; // @ Speed this up;
-        c--;
-    }
+    ofd_f64 wall_seconds[OFD_STATS_PHASE_COUNT];
+    ofd_f64 cpu_seconds[OFD_STATS_PHASE_COUNT]; // CPU time of the whole process, so every thread adds to it.
     
-    filepath.count = filepath.data + filepath.count - (c + 1);
-    filepath.data  = c + 1;
+    ofd_u64 input_bytes;
+    ofd_u64 output_bytes;
+    int     num_sections;
+    int     num_link_references;
+    int     num_code_blocks;
+    int     num_cached_files; // Files that came from the file cache instead of being parsed, see ofd_open_file_cache().
     
-    return filepath;
-}
+    Ofd_Array files; // Ofd_File_Stats, one per markdown file in the order they were given.
+    
+    Ofd_Allocation_Stats allocations; // From ofd_begin_stats() to ofd_end_stats(), only counted with OFD_ALLOCATION_STATS.
+    
+    ofd_b8  has_hardware_counters[OFD_HARDWARE_COUNTER_COUNT]; // The ones that were open in ofd_begin_stats().
+    ofd_u64 hardware_counters[OFD_STATS_PHASE_COUNT][OFD_HARDWARE_COUNTER_COUNT];
+    
+    ofd_f64 phase_wall_start; // Used while a phase runs.
+    ofd_f64 phase_cpu_start;
+    ofd_u64 phase_hardware_counters_start[OFD_HARDWARE_COUNTER_COUNT];
+} Ofd_Stats;
 
-ofd_static Ofd_String ofd_strip_file_extension(Ofd_String filepath)
-{
-    char* c     = filepath.data + filepath.count;
-    char* limit = filepath.data;
-    while(c >= limit)
-    {
-        if(*c == '.') // @ Speed this up.
-        {
-            filepath.count -= filepath.data + filepath.count - c;
-            break;
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// NOTE: while stats are on the ofd_generate_documentation*() routines add what they measure to stats, so several runs add up. It only
+// costs a few clock reads per phase, file and code block. Turning stats on and off is not thread-safe, do it around the runs you measure.
+ofd_static void ofd_begin_stats(Ofd_Stats* stats); // This initialises stats, free it with ofd_free_stats().
+
+ofd_static void ofd_end_stats(void);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ofd_static void ofd_free_stats(Ofd_Stats* stats);
+
+// This adds a C string to result: the time spent in every phase, counts and the max_slowest_files files that took the longest.
+ofd_static void ofd_write_stats_report(Ofd_Stats* stats, int max_slowest_files, Ofd_Array* result); // result must be initialised.
+
+// These return seconds from an arbitrary starting point, only differences between two calls make sense.
+ofd_static ofd_f64 ofd_get_wall_time(void);
+
+ofd_static ofd_f64 ofd_get_cpu_time(void); // Every thread of the process.
+
+ofd_static ofd_f64 ofd_get_thread_cpu_time(void);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// NOTE: open the hardware counters before ofd_begin_stats() and the stats count cycles, instructions, branch misses and last level cache
+// misses in every phase, in user space only. Threads started while they are open are counted too. They are only there on Linux when the
+// CPU exposes them and /proc/sys/kernel/perf_event_paranoid allows it, otherwise the stats go on without them. This returns ofd_true if
+// at least one counter could be opened.
+ofd_static ofd_b8 ofd_open_hardware_counters(void);
+
+ofd_static void ofd_close_hardware_counters(void);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+/////////////
+// Trace API.
+
+typedef struct
+{
+    char*   name;          // This must stay alive as long as the trace, a string literal is best.
+    int     detail_offset; // Into the strings of the trace.
+    int     detail_count;
+    int     size;          // Number of bytes the span worked on, -1 if it does not apply.
+    ofd_u64 thread_id;
+    ofd_f64 start_time;
+    ofd_f64 end_time;
+} Ofd_Trace_Span;
+
+typedef struct
+{
+    Ofd_Array spans;   // Ofd_Trace_Span
+    Ofd_Array strings; // The details of the spans.
+    Ofd_Mutex mutex;
+    
+    ofd_f64 start_time;       // Spans are written relative to this.
+    ofd_f64 phase_start_time; // Used while a phase runs.
+} Ofd_Trace;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// NOTE: while a trace is on the ofd_generate_documentation*() routines record a span for every file they load, every phase (see
+// Ofd_Stats_Phase), every file they parse, every header, code block, quote, list and table in the markdown and every call to
+// ofd_apply_syntax_highlighting(). Spans can be recorded from any thread. Turning the trace on and off is not thread-safe.
+ofd_static void ofd_begin_trace(Ofd_Trace* trace); // This initialises trace, free it with ofd_free_trace().
+
+ofd_static void ofd_end_trace(void);
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ofd_static void ofd_free_trace(Ofd_Trace* trace);
+
+// Your own spans: keep what ofd_begin_trace_span() returns and give it to ofd_end_trace_span(). They do nothing while the trace is off.
+ofd_static ofd_f64 ofd_begin_trace_span(void);
+
+ofd_static void ofd_end_trace_span(char* name, ofd_f64 start_time, Ofd_String detail, int size);
+
+// This writes the spans in the Chrome trace event format (JSON) that chrome://tracing and Perfetto open, every thread gets its own lane.
+ofd_static void ofd_write_trace(Ofd_Trace* trace, Ofd_Writer* writer);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // OFD_HEADER
+
+
+
+
+#ifdef OFD_IMPLEMENTATION
+
+// Platform headers are only needed by the implementation, the OFD_USE_* switches that pick them are set above.
+#if defined(OFD_USE_WIN32_THREADS) || defined(OFD_USE_WIN32_CLOCKS)
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+        #define OFD_DEFINED_WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+        #define NOMINMAX
+        #define OFD_DEFINED_NOMINMAX
+    #endif
+    #include <windows.h>
+    #ifdef OFD_DEFINED_WIN32_LEAN_AND_MEAN
+        #undef WIN32_LEAN_AND_MEAN
+        #undef OFD_DEFINED_WIN32_LEAN_AND_MEAN
+    #endif
+    #ifdef OFD_DEFINED_NOMINMAX
+        #undef NOMINMAX
+        #undef OFD_DEFINED_NOMINMAX
+    #endif
+#endif
+
+#if defined(OFD_USE_PTHREADS)
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include <time.h>
+
+#if defined(OFD_USE_PERF_EVENTS)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifndef OFD_NO_FILE_IO
+#if defined(OFD_USE_MMAP)
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <direct.h> // _mkdir() for ofd_open_cache().
+#else
+#include <sys/stat.h> // mkdir() for ofd_open_cache().
+#include <sys/types.h>
+#endif
+#endif // OFD_NO_FILE_IO
+
+#if defined(OFD_USE_SSE2)
+#include <emmintrin.h>
+#ifdef OFD_USE_AVX2
+#include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+ofd_static Ofd_String Ofd_String_(char* c_string)
+{
+    Ofd_String result = {c_string, ofd_strlen(c_string)};
+    return result;
+}
+
+ofd_static ofd_b8 ofd_string_matches(Ofd_String a, char* b)
+{
+    int b_count = ofd_strlen(b);
+    if(a.count != b_count) return ofd_false;
+    
+    return (ofd_memcmp(a.data, b, b_count) == 0);
+}
+
+ofd_static ofd_b8 ofd_strings_match(Ofd_String a, Ofd_String b)
+{
+    if(a.count != b.count) return ofd_false;
+    
+    return (ofd_memcmp(a.data, b.data, a.count) == 0);
+}
+
+ofd_static void ofd_to_c_string(Ofd_String s, char* buffer)
+{
+    ofd_copy(buffer, s.data, s.count);
+    buffer[s.count] = 0;
+}
+
+ofd_static Ofd_String ofd_get_last_item_from_filepath(Ofd_String filepath)
+{
+    char* c     = filepath.data + filepath.count - 1;
+    char* limit = filepath.data;
+    while(c >= limit)
+    {
+        if(*c == '/' || *c == '\\') break; // @ Speed this up;
+        c--;
+    }
+    
+    filepath.count = filepath.data + filepath.count - (c + 1);
+    filepath.data  = c + 1;
+    
+    return filepath;
+}
+
+ofd_static Ofd_String ofd_strip_file_extension(Ofd_String filepath)
+{
+    char* c     = filepath.data + filepath.count;
+    char* limit = filepath.data;
+    while(c >= limit)
+    {
+        if(*c == '.') // @ Speed this up.
+        {
+            filepath.count -= filepath.data + filepath.count - c;
+            break;
         }
         
         c--;
@@ -556,1166 +1381,2993 @@ ofd_static Ofd_String ofd_make_section_id(Ofd_String section_name, char* result_
     
     
     section_name.data  = result_memory;
-    section_name.count = ofd_strlen(result_memory);
+    section_name.count = offset;
     
     return section_name;
 }
 
 
-ofd_static void ofd_array_grow(Ofd_Array* array, int new_count)
+ofd_static int ofd_get_first_set_bit(unsigned int mask)
 {
-    ofd_assert(array->max_count < new_count);
+    ////////////////////////////////////////////////
+    // NOTE: mask must not be 0.
+    ////////////////////////////////////////////////
+    
+    #if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+    #elif defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(mask);
+    #else
+    int index = 0;
+    while(!(mask & 1))
+    {
+        mask >>= 1;
+        index++;
+    }
     
-    int new_max_count = new_count * 2;
+    return index;
+    #endif
+}
+
+ofd_static unsigned int ofd_hash_string(Ofd_String s)
+{ // FNV-1a.
+    unsigned int hash = 2166136261u;
+    for(int i = 0; i < s.count; i++)
+    {
+        hash ^= ofd_cast(s.data[i], ofd_u8);
+        hash *= 16777619u;
+    }
     
-    int new_size = new_max_count * array->item_size;
-    char* new_data = ofd_allocate(new_size);
+    return hash;
+}
+
+ofd_static ofd_u64 ofd_hash_64(ofd_u64 hash, void* data, int count)
+{ // FNV-1a.
+    ofd_u8* bytes = ofd_cast(data, ofd_u8*);
+    for(int i = 0; i < count; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
     
-    ofd_copy(new_data, array->data, array->count * array->item_size);
-    ofd_free(array->data);
-    array->data      = new_data;
-    array->max_count = new_max_count;
+    return hash;
 }
 
-ofd_static void ofd_array_init(Ofd_Array* array, int item_size)
+#define ofd_rotate_left_64(_x, _bits) (((_x) << (_bits)) | ((_x) >> (64 - (_bits))))
+
+ofd_force_inline void ofd_mix_hash_128(ofd_u64* hash, ofd_u64 a, ofd_u64 b)
 {
-    array->data      = NULL;
-    array->item_size = item_size;
-    array->count     = 0;
-    array->max_count = 0;
+    ofd_u64 h0 = hash[0] ^ (a * 0x87C37B91114253D5ull);
+    ofd_u64 h1 = hash[1] ^ (b * 0x4CF5AD432745937Full);
+    h0 = ofd_rotate_left_64(h0, 31) * 0x4CF5AD432745937Full;
+    h1 = ofd_rotate_left_64(h1, 33) * 0x87C37B91114253D5ull;
+    
+    hash[0] = h0 + h1;
+    hash[1] = h1 + hash[0];
 }
 
-ofd_static void ofd_array_init_with_space(Ofd_Array* array, int item_size, int num_items_to_preallocate)
-{
-    array->data      = ofd_allocate(num_items_to_preallocate * item_size);
-    array->item_size = item_size;
-    array->count     = 0;
-    array->max_count = num_items_to_preallocate;
+ofd_static void ofd_hash_128(ofd_u64* hash, void* data, int count)
+{ // This reads 16 bytes per step where FNV-1a reads one, it is meant for the cache keys that cover whole files and code blocks.
+    ofd_u8* bytes = ofd_cast(data, ofd_u8*);
+    int i = 0;
+    for(; i + 16 <= count; i += 16)
+    {
+        ofd_u64 a, b;
+        ofd_copy(&a, bytes + i, 8);
+        ofd_copy(&b, bytes + i + 8, 8);
+        ofd_mix_hash_128(hash, a, b);
+    }
+    
+    ofd_u64 tail[2] = {0, 0};
+    if(i < count) ofd_copy(tail, bytes + i, count - i);
+    ofd_mix_hash_128(hash, tail[0], tail[1]);
+    ofd_mix_hash_128(hash, ofd_cast(count, ofd_u64), 0); // The count tells apart inputs that only differ by trailing zeros.
+    
+    for(int j = 0; j < 2; j++)
+    { // The finalizer of MurmurHash3, so that every input bit can reach every bit of the result.
+        ofd_u64 h = hash[j];
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ull;
+        h ^= h >> 33;
+        hash[j] = h;
+    }
 }
 
-ofd_static void* ofd_array_add_fast(Ofd_Array* array)
+
+#ifdef OFD_ALLOCATION_STATS
+#define OFD_ALLOCATION_HEADER_SIZE 16 // The size and the tag of the allocation, this keeps memory 16-byte aligned.
+
+static Ofd_Allocation_Stats ofd_allocation_stats;
+static ofd_b8 ofd_allocations_are_counted; // This only changes while no other thread runs, see ofd_begin_stats().
+
+ofd_static ofd_u64 ofd_atomic_add_u64(ofd_u64* value, ofd_u64 amount)
+{ // This returns the new value.
+    #if defined(OFD_USE_WIN32_THREADS)
+    return InterlockedExchangeAdd64(ofd_cast(value, volatile LONG64*), amount) + amount;
+    #elif defined(OFD_USE_PTHREADS)
+    return __sync_add_and_fetch(value, amount);
+    #else
+    *value += amount;
+    return *value;
+    #endif
+}
+
+ofd_static void ofd_atomic_max_u64(ofd_u64* value, ofd_u64 candidate)
 {
-    if(array->max_count == array->count) ofd_array_grow(array, array->count + 1);
-    
-    void* data = array->data + array->count * array->item_size;
-    array->count++;
+    #if defined(OFD_USE_WIN32_THREADS)
+    ofd_u64 current = InterlockedCompareExchange64(ofd_cast(value, volatile LONG64*), 0, 0); // An atomic read.
+    #elif defined(OFD_USE_PTHREADS)
+    ofd_u64 current = __sync_val_compare_and_swap(value, 0, 0); // An atomic read.
+    #else
+    ofd_u64 current = *value;
+    #endif
     
-    return data;
+    while(candidate > current)
+    {
+        #if defined(OFD_USE_WIN32_THREADS)
+        ofd_u64 previous = InterlockedCompareExchange64(ofd_cast(value, volatile LONG64*), candidate, current);
+        #elif defined(OFD_USE_PTHREADS)
+        ofd_u64 previous = __sync_val_compare_and_swap(value, current, candidate);
+        #else
+        ofd_u64 previous = current;
+        *value = candidate;
+        #endif
+        
+        if(previous == current) break;
+        current = previous; // Another thread got there first.
+    }
 }
 
-ofd_static void* ofd_array_add_fast_multiple(Ofd_Array* array, int count)
+ofd_static void* ofd_counted_allocate(int size, int tag)
 {
-    if(array->max_count == array->count) ofd_array_grow(array, array->count + count);
+    ofd_u64* header = ofd_cast(ofd_allocate(OFD_ALLOCATION_HEADER_SIZE + size), ofd_u64*);
+    header[0] = 0; // What ofd_counted_free() takes off the live bytes, nothing unless we count this allocation.
+    header[1] = tag;
     
-    void* data = array->data + array->count * array->item_size;
-    array->count += count;
+    if(!ofd_allocations_are_counted) return ofd_cast(header, char*) + OFD_ALLOCATION_HEADER_SIZE;
     
-    return data;
+    header[0] = size;
+    
+    Ofd_Allocation_Counts* counts = ofd_allocation_stats.tags + tag;
+    ofd_atomic_add_u64(&counts->num_allocations,     1);
+    ofd_atomic_add_u64(&counts->num_allocated_bytes, size);
+    
+    ofd_u64 num_live_bytes = ofd_atomic_add_u64(&ofd_allocation_stats.num_live_bytes, size);
+    ofd_atomic_max_u64(&ofd_allocation_stats.peak_live_bytes, num_live_bytes);
+    
+    return ofd_cast(header, char*) + OFD_ALLOCATION_HEADER_SIZE;
 }
 
-ofd_static void ofd_array_add_string(Ofd_Array* destination, Ofd_String source)
+ofd_static void ofd_counted_free(void* memory)
 {
-    int new_count = destination->count + source.count;
+    if(!memory) return;
     
-    if(destination->max_count < new_count) ofd_array_grow(destination, new_count);
+    ofd_u64* header = ofd_cast(ofd_cast(memory, char*) - OFD_ALLOCATION_HEADER_SIZE, ofd_u64*);
+    if(header[0]) ofd_atomic_add_u64(&ofd_allocation_stats.num_live_bytes, 0 - header[0]);
     
-    ofd_copy(destination->data + destination->count, source.data, source.count);
-    destination->count = new_count;
+    ofd_free(header);
 }
 
-ofd_static void ofd_array_add_array(Ofd_Array* destination, Ofd_Array* source)
+ofd_static void ofd_count_copied_bytes(int size, int tag)
 {
-    ofd_assert(destination->item_size == source->item_size);
-    
-    int new_count = destination->count + source->count;
-    
-    if(destination->max_count < new_count) ofd_array_grow(destination, new_count);
+    if(!ofd_allocations_are_counted) return;
     
-    ofd_copy(destination->data + destination->count * destination->item_size, source->data, source->count * destination->item_size);
-    destination->count = new_count;
+    Ofd_Allocation_Counts* counts = ofd_allocation_stats.tags + tag;
+    ofd_atomic_add_u64(&counts->num_copies,       1);
+    ofd_atomic_add_u64(&counts->num_copied_bytes, size);
 }
 
-ofd_static void ofd_free_array(Ofd_Array* array)
+#define ofd_tagged_allocate(_size, _tag) ofd_counted_allocate(_size, _tag)
+#define ofd_tagged_free(_memory)         ofd_counted_free(_memory)
+#define ofd_count_copy(_size, _tag)      ofd_count_copied_bytes(_size, _tag)
+#else
+#define ofd_tagged_allocate(_size, _tag) ofd_allocate(_size)
+#define ofd_tagged_free(_memory)         ofd_free(_memory)
+#define ofd_count_copy(_size, _tag)
+#endif // OFD_ALLOCATION_STATS
+
+ofd_static void ofd_count_allocations(ofd_b8 count)
 {
-    if(!array->data) return;
+    #ifdef OFD_ALLOCATION_STATS
+    ofd_allocations_are_counted = count;
+    #else
+    (void)count;
+    #endif
+}
+
+ofd_static void ofd_get_allocation_stats(Ofd_Allocation_Stats* result)
+{
+    #ifdef OFD_ALLOCATION_STATS
+    *result = ofd_allocation_stats;
+    #else
+    Ofd_Allocation_Stats empty_stats = {0};
+    *result = empty_stats;
+    #endif
+}
+
+ofd_static void ofd_reset_allocation_stats(void)
+{
+    #ifdef OFD_ALLOCATION_STATS
+    Ofd_Allocation_Counts empty_counts = {0};
+    for(int tag = 0; tag < OFD_ALLOCATION_TAG_COUNT; tag++) ofd_allocation_stats.tags[tag] = empty_counts;
     
-    ofd_free(array->data);
-    array->max_count = 0;
-    array->count     = 0;
-    array->data      = NULL;
+    ofd_allocation_stats.peak_live_bytes = ofd_allocation_stats.num_live_bytes;
+    #endif
 }
 
 
-#ifndef OFD_NO_FILE_IO
-ofd_static ofd_b8 ofd_read_whole_file(char* filepath, Ofd_String* result)
+#define OFD_ARENA_ALIGNMENT         8
+#define OFD_ARENA_BLOCK_HEADER_SIZE ofd_cast((sizeof(Ofd_Arena_Block) + 15) & ~15, int) // Keep the block data 16-byte aligned.
+#define OFD_ARENA_BLOCK_DATA(_block) (ofd_cast(_block, char*) + OFD_ARENA_BLOCK_HEADER_SIZE)
+
+ofd_static void ofd_arena_init(Ofd_Arena* arena, int block_size)
 {
-    result->data  = NULL;
-    result->count = 0;
+    arena->current_block = NULL;
+    arena->free_blocks   = NULL;
+    arena->block_size    = block_size > 0? block_size : OFD_ARENA_DEFAULT_BLOCK_SIZE;
+}
+
+ofd_static void* ofd_arena_allocate(Ofd_Arena* arena, int size)
+{
+    Ofd_Arena_Block* block = arena->current_block;
     
-    ofd_b8 status = ofd_false;
+    int offset = 0;
+    if(block) offset = (block->used + OFD_ARENA_ALIGNMENT - 1) & ~(OFD_ARENA_ALIGNMENT - 1);
     
-    FILE* f = fopen(filepath, "rb");
-    if(f)
+    if(!block || offset + size > block->size)
     {
-        status = ofd_true;
+        // Get a new block. START
+        block = NULL;
         
-        fseek(f, 0, SEEK_END);
-        result->count = ftell(f);
-        rewind(f);
-        
-        result->data = ofd_allocate(result->count);
-        int num_bytes_read = fread(result->data, 1, result->count, f);
-        if(num_bytes_read != result->count)
-        { // We failed to read the file.
-            ofd_free(result->data);
-            result->count = 0;
+        Ofd_Arena_Block** free_block = &arena->free_blocks;
+        while(*free_block)
+        { // Try to reuse a block that was released earlier.
+            if((*free_block)->size >= size)
+            {
+                block       = *free_block;
+                *free_block = block->previous;
+                break;
+            }
             
-            ofd_printf("Failed to correctly read file '%s'.\n", filepath);
-            status = ofd_false;
+            free_block = &(*free_block)->previous;
         }
         
-        fclose(f);
+        if(!block)
+        {
+            int block_size = ofd_max(size, arena->block_size);
+            block = ofd_tagged_allocate(OFD_ARENA_BLOCK_HEADER_SIZE + block_size, OFD_ALLOCATION_ARENA);
+            block->size = block_size;
+        }
+        
+        block->previous      = arena->current_block;
+        block->used          = 0;
+        arena->current_block = block;
+        
+        offset = 0;
+        // Get a new block. END
     }
-    else ofd_printf("Failed to open file '%s'.\n", filepath);
     
-    return status;
+    block->used = offset + size;
+    return OFD_ARENA_BLOCK_DATA(block) + offset;
 }
 
-ofd_static ofd_b8 ofd_write_whole_file(char* filepath, void* data, int count)
+ofd_static void* ofd_arena_resize(Ofd_Arena* arena, void* memory, int old_size, int new_size)
 {
-    ofd_b8 status = ofd_false;
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: if memory is the last allocation made in the arena and there is enough room left we grow it in place.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     
-    FILE* f = fopen(filepath, "wb");
-    if(f)
+    Ofd_Arena_Block* block = arena->current_block;
+    if(memory && block)
     {
-        status = ofd_true;
-        
-        int num_bytes_written = fwrite(data, 1, count, f);
-        if(num_bytes_written != count)
-        { // We failed to write the file.
-            ofd_printf("Failed to correctly write file '%s'.\n", filepath);
-            status = ofd_false;
+        char* block_data = OFD_ARENA_BLOCK_DATA(block);
+        if(ofd_cast(memory, char*) + old_size == block_data + block->used)
+        {
+            int offset = ofd_cast(memory, char*) - block_data;
+            if(offset + new_size <= block->size)
+            {
+                block->used = offset + new_size;
+                return memory;
+            }
         }
-        
-        fclose(f);
     }
-    else ofd_printf("Failed to create file '%s'.\n", filepath);
     
-    return status;
+    void* new_memory = ofd_arena_allocate(arena, new_size);
+    if(memory) ofd_copy(new_memory, memory, ofd_min(old_size, new_size));
+    
+    return new_memory;
 }
-#endif // OFD_NO_FILE_IO
-
 
-ofd_static void ofd_colour_to_string(Ofd_Colour colour, char* result)
+ofd_static void ofd_arena_release(Ofd_Arena* arena, void* memory, int size)
 {
-    if(colour.a < 0.999f)
-    {
-        ofd_sprintf(result, "#%02x%02x%02x%02x", ofd_cast(colour.r * 255.0f, int), ofd_cast(colour.g * 255.0f, int), ofd_cast(colour.b * 255.0f, int), ofd_cast(colour.a * 255.0f, int));
-    }
-    else
-    {
-        ofd_sprintf(result, "#%02x%02x%02x", ofd_cast(colour.r * 255.0f, int), ofd_cast(colour.g * 255.0f, int), ofd_cast(colour.b * 255.0f, int));
-    }
+    ///////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: memory is only given back if it is the last allocation made in the arena, otherwise this
+    // does nothing and the memory is released along with the rest of the arena.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    Ofd_Arena_Block* block = arena->current_block;
+    if(!memory || !block) return;
+    
+    char* block_data = OFD_ARENA_BLOCK_DATA(block);
+    if(ofd_cast(memory, char*) + size == block_data + block->used) block->used = ofd_cast(memory, char*) - block_data;
 }
 
-
-ofd_static ofd_b8 ofd_filter_plain_text(Ofd_String* text)
+ofd_static Ofd_Arena_Marker ofd_arena_get_marker(Ofd_Arena* arena)
 {
-    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    // NOTE: we assume the string is just a view into data. This routine returns ofd_true if the string was changed.
-    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    Ofd_Arena_Marker marker;
+    marker.block = arena->current_block;
+    marker.used  = arena->current_block? arena->current_block->used : 0;
     
-    Ofd_Array elements_to_filter;
-    ofd_array_init(&elements_to_filter, sizeof(Ofd_Element_To_Filter));
-    
-    int new_count = text->count;
-    
-    char* c     = text->data;
-    char* limit = text->data + text->count;
+    return marker;
+}
+
+ofd_static void ofd_arena_reset_to_marker(Ofd_Arena* arena, Ofd_Arena_Marker marker)
+{
+    while(arena->current_block != marker.block)
+    { // Put blocks allocated after the marker aside so that they can be reused.
+        Ofd_Arena_Block* block = arena->current_block;
+        arena->current_block = block->previous;
+        
+        block->previous    = arena->free_blocks;
+        arena->free_blocks = block;
+    }
     
-    while(c < limit)
+    if(arena->current_block) arena->current_block->used = marker.used;
+}
+
+ofd_static void ofd_free_arena(Ofd_Arena* arena)
+{
+    Ofd_Arena_Block* lists[] = {arena->current_block, arena->free_blocks};
+    for(int i = 0; i < ofd_array_count(lists); i++)
     {
-        if(*c == '<')
-        {
-            Ofd_Element_To_Filter* element = ofd_array_add_fast(&elements_to_filter);
-            element->text.data  = c;
-            element->text.count = 1;
-            element->type       = OFD_LESS_THAN_BRACKET;
-            
-            new_count += 3 - 1;
-            
-            c++;
-            continue;
-        }
-        else if(*c == '>')
-        {
-            Ofd_Element_To_Filter* element = ofd_array_add_fast(&elements_to_filter);
-            element->text.data  = c;
-            element->text.count = 1;
-            element->type       = OFD_GREATER_THAN_BRACKET;
-            
-            new_count += 3 - 1;
-            
-            c++;
-            continue;
-        }
-        
-        ofd_b8 is_a_link = ofd_false;
-        if(c + 7 <= limit) is_a_link |= (ofd_memcmp(c, "http://",  7) == 0);
-        if(c + 8 <= limit) is_a_link |= (ofd_memcmp(c, "https://", 8) == 0);
-        
-        if(is_a_link)
+        Ofd_Arena_Block* block = lists[i];
+        while(block)
         {
-            Ofd_String link = {c};
-            while(c < limit)
-            { // Retrieve the full link.
-                char character = *c;
-                if(character == ' ' || character == '\t' || character == '\n' || character == '\r' || character == '"') break;
-                
-                link.count++;
-                c++;
-            }
-            
-            
-            Ofd_Element_To_Filter* element = ofd_array_add_fast(&elements_to_filter);
-            element->text = link;
-            element->type = OFD_LINK;
-            
-            new_count += link.count + ofd_strlen("<a class='ofd-external-link' target='_blank' href=''></a>");
-            
-            continue;
+            Ofd_Arena_Block* previous = block->previous;
+            ofd_tagged_free(block);
+            block = previous;
         }
-        
-        
-        c++;
     }
     
-    if(!elements_to_filter.count) return ofd_false; // We did not find any elements to filter so we can just return the string unchanged.
-    
-    
-    
-    
-    char* new_data = ofd_allocate(new_count);
-    int offset = 0;
+    arena->current_block = NULL;
+    arena->free_blocks   = NULL;
+}
+
+
+typedef struct
+{
+    Ofd_Job_Callback* callback;
+    void*             user_data;
+    int               num_jobs;
     
-    char* sub_text_that_needs_no_filtering_start = text->data;
+    volatile int next_job_index;
+} Ofd_Job_Queue;
+
+ofd_static int ofd_get_num_cpu_cores(void)
+{
+    int result = 1;
+    
+    #if defined(OFD_USE_WIN32_THREADS)
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+    result = system_info.dwNumberOfProcessors;
+    #elif defined(OFD_USE_PTHREADS)
+    result = sysconf(_SC_NPROCESSORS_ONLN);
+    #endif
     
-    for(int element_index = 0; element_index < elements_to_filter.count; element_index++)
-    { // Build the new text.
-        Ofd_Element_To_Filter* element = ofd_cast(elements_to_filter.data, Ofd_Element_To_Filter*) + element_index;
-        
-        
-        // Copy unfiltered text data.
-        int sub_text_that_needs_no_filtering_count = element->text.data - sub_text_that_needs_no_filtering_start;
-        ofd_copy(new_data + offset, sub_text_that_needs_no_filtering_start, sub_text_that_needs_no_filtering_count);
-        offset += sub_text_that_needs_no_filtering_count;
-        
-        sub_text_that_needs_no_filtering_start = element->text.data + element->text.count;
-        /////////////////////////////
-        
+    return ofd_max(result, 1);
+}
+
+ofd_static int ofd_take_job_index(Ofd_Job_Queue* queue)
+{
+    #if defined(OFD_USE_WIN32_THREADS)
+    return InterlockedIncrement(ofd_cast(&queue->next_job_index, volatile LONG*)) - 1;
+    #elif defined(OFD_USE_PTHREADS)
+    return __sync_fetch_and_add(&queue->next_job_index, 1);
+    #else
+    return queue->next_job_index++;
+    #endif
+}
+
+ofd_static void ofd_do_jobs(Ofd_Job_Queue* queue)
+{
+    while(1)
+    {
+        int job_index = ofd_take_job_index(queue);
+        if(job_index >= queue->num_jobs) break;
         
-        switch(element->type)
+        queue->callback(queue->user_data, job_index);
+    }
+}
+
+#if defined(OFD_USE_WIN32_THREADS)
+static DWORD WINAPI ofd_job_thread_proc(LPVOID queue)
+{
+    ofd_do_jobs(ofd_cast(queue, Ofd_Job_Queue*));
+    return 0;
+}
+#elif defined(OFD_USE_PTHREADS)
+static void* ofd_job_thread_proc(void* queue)
+{
+    ofd_do_jobs(ofd_cast(queue, Ofd_Job_Queue*));
+    return NULL;
+}
+#endif
+
+ofd_static void ofd_run_jobs(Ofd_Job_Callback* callback, void* user_data, int num_jobs)
+{
+    Ofd_Job_Queue queue;
+    queue.callback       = callback;
+    queue.user_data      = user_data;
+    queue.num_jobs       = num_jobs;
+    queue.next_job_index = 0;
+    
+    int num_threads = ofd_min(ofd_get_num_cpu_cores(), num_jobs);
+    num_threads     = ofd_min(num_threads, OFD_MAX_THREADS);
+    
+    // The calling thread takes jobs too so we only start num_threads - 1 threads. If a thread fails to start the others do its share.
+    #if defined(OFD_USE_WIN32_THREADS)
+    HANDLE threads[OFD_MAX_THREADS];
+    int num_started_threads = 0;
+    for(int i = 1; i < num_threads; i++)
+    {
+        HANDLE thread = CreateThread(NULL, 0, ofd_job_thread_proc, &queue, 0, NULL);
+        if(thread)
         {
-            case OFD_LESS_THAN_BRACKET:
-            {
-                ofd_copy(new_data + offset, "&lt", 3);
-                offset += 3;
-            } break;
-            
-            case OFD_GREATER_THAN_BRACKET:
-            {
-                ofd_copy(new_data + offset, "&gt", 3);
-                offset += 3;
-            } break;
-            
-            case OFD_LINK:
-            {
-                Ofd_String text_to_insert = Ofd_String_("<a class='ofd-external-link' target='_blank' href='");
-                ofd_copy(new_data + offset, text_to_insert.data, text_to_insert.count);
-                offset += text_to_insert.count;
-                
-                ofd_copy(new_data + offset, element->text.data, element->text.count);
-                offset += element->text.count;
-                
-                text_to_insert = Ofd_String_("'>");
-                ofd_copy(new_data + offset, text_to_insert.data, text_to_insert.count);
-                offset += text_to_insert.count;
-                
-                ofd_copy(new_data + offset, element->text.data, element->text.count);
-                offset += element->text.count;
-                
-                text_to_insert = Ofd_String_("</a>");
-                ofd_copy(new_data + offset, text_to_insert.data, text_to_insert.count);
-                offset += text_to_insert.count;
-            } break;
+            threads[num_started_threads] = thread;
+            num_started_threads++;
         }
     }
     
-    // Copy the remaining unfiltered data.
-    int sub_text_that_needs_no_filtering_count = limit - sub_text_that_needs_no_filtering_start;
-    ofd_copy(new_data + offset, sub_text_that_needs_no_filtering_start, sub_text_that_needs_no_filtering_count);
-    offset += sub_text_that_needs_no_filtering_count;
-    //////////////////////////////////////
+    ofd_do_jobs(&queue);
     
+    if(num_started_threads) WaitForMultipleObjects(num_started_threads, threads, TRUE, INFINITE);
+    for(int i = 0; i < num_started_threads; i++) CloseHandle(threads[i]);
+    #elif defined(OFD_USE_PTHREADS)
+    pthread_t threads[OFD_MAX_THREADS];
+    int num_started_threads = 0;
+    for(int i = 1; i < num_threads; i++)
+    {
+        if(pthread_create(threads + num_started_threads, NULL, ofd_job_thread_proc, &queue) == 0) num_started_threads++;
+    }
     
-    text->data  = new_data;
-    text->count = offset;
-    
-    ofd_free_array(&elements_to_filter);
+    ofd_do_jobs(&queue);
     
-    return ofd_true;
+    for(int i = 0; i < num_started_threads; i++) pthread_join(threads[i], NULL);
+    #else
+    ofd_do_jobs(&queue);
+    #endif
 }
 
-ofd_static char* ofd_skip_whitespace(char* c, char* limit)
+#if defined(OFD_USE_WIN32_THREADS)
+typedef CRITICAL_SECTION Ofd_Platform_Mutex;
+#elif defined(OFD_USE_PTHREADS)
+typedef pthread_mutex_t Ofd_Platform_Mutex;
+#else
+typedef int Ofd_Platform_Mutex;
+#endif
+
+// If this fails to compile Ofd_Mutex needs more storage for the mutex of your platform.
+typedef char Ofd_Mutex_Storage_Is_Large_Enough[sizeof(Ofd_Platform_Mutex) <= sizeof(Ofd_Mutex) ? 1 : -1];
+
+#define ofd_get_platform_mutex(_mutex) ofd_cast((_mutex)->storage, Ofd_Platform_Mutex*)
+
+ofd_static void ofd_mutex_init(Ofd_Mutex* mutex)
 {
-    while(c < limit)
+    #if defined(OFD_USE_WIN32_THREADS)
+    InitializeCriticalSection(ofd_get_platform_mutex(mutex));
+    #elif defined(OFD_USE_PTHREADS)
+    pthread_mutex_init(ofd_get_platform_mutex(mutex), NULL);
+    #else
+    *ofd_get_platform_mutex(mutex) = 0;
+    #endif
+}
+
+ofd_static void ofd_mutex_lock(Ofd_Mutex* mutex)
+{
+    #if defined(OFD_USE_WIN32_THREADS)
+    EnterCriticalSection(ofd_get_platform_mutex(mutex));
+    #elif defined(OFD_USE_PTHREADS)
+    pthread_mutex_lock(ofd_get_platform_mutex(mutex));
+    #endif
+}
+
+ofd_static void ofd_mutex_unlock(Ofd_Mutex* mutex)
+{
+    #if defined(OFD_USE_WIN32_THREADS)
+    LeaveCriticalSection(ofd_get_platform_mutex(mutex));
+    #elif defined(OFD_USE_PTHREADS)
+    pthread_mutex_unlock(ofd_get_platform_mutex(mutex));
+    #endif
+}
+
+ofd_static void ofd_free_mutex(Ofd_Mutex* mutex)
+{
+    #if defined(OFD_USE_WIN32_THREADS)
+    DeleteCriticalSection(ofd_get_platform_mutex(mutex));
+    #elif defined(OFD_USE_PTHREADS)
+    pthread_mutex_destroy(ofd_get_platform_mutex(mutex));
+    #endif
+}
+
+ofd_static ofd_u64 ofd_get_thread_id(void)
+{
+    #if defined(OFD_USE_WIN32_THREADS)
+    return GetCurrentThreadId();
+    #elif defined(OFD_USE_PTHREADS)
+    return ofd_cast(ofd_cast(pthread_self(), size_t), ofd_u64);
+    #else
+    return 0;
+    #endif
+}
+
+
+ofd_static ofd_f64 ofd_get_wall_time(void)
+{
+    #if defined(OFD_USE_WIN32_CLOCKS)
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return ofd_cast(counter.QuadPart, ofd_f64) / ofd_cast(frequency.QuadPart, ofd_f64);
+    #elif defined(OFD_USE_POSIX_CLOCKS)
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+    #else
+    return ofd_cast(clock(), ofd_f64) / CLOCKS_PER_SEC;
+    #endif
+}
+
+#if defined(OFD_USE_WIN32_CLOCKS)
+ofd_static ofd_f64 ofd_filetimes_to_seconds(FILETIME a, FILETIME b)
+{ // FILETIME counts 100 nanoseconds.
+    ofd_u64 a_ticks = (ofd_cast(a.dwHighDateTime, ofd_u64) << 32) | a.dwLowDateTime;
+    ofd_u64 b_ticks = (ofd_cast(b.dwHighDateTime, ofd_u64) << 32) | b.dwLowDateTime;
+    return (a_ticks + b_ticks) * 1e-7;
+}
+#endif
+
+ofd_static ofd_f64 ofd_get_cpu_time(void)
+{
+    #if defined(OFD_USE_WIN32_CLOCKS)
+    FILETIME creation_time, exit_time, kernel_time, user_time;
+    if(!GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time, &kernel_time, &user_time)) return 0;
+    return ofd_filetimes_to_seconds(kernel_time, user_time);
+    #elif defined(OFD_USE_POSIX_CLOCKS)
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+    #else
+    return ofd_cast(clock(), ofd_f64) / CLOCKS_PER_SEC;
+    #endif
+}
+
+ofd_static ofd_f64 ofd_get_thread_cpu_time(void)
+{
+    #if defined(OFD_USE_WIN32_CLOCKS)
+    FILETIME creation_time, exit_time, kernel_time, user_time;
+    if(!GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time)) return 0;
+    return ofd_filetimes_to_seconds(kernel_time, user_time);
+    #elif defined(OFD_USE_POSIX_CLOCKS)
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+    #else
+    return ofd_cast(clock(), ofd_f64) / CLOCKS_PER_SEC; // No per-thread clock, this is only right without threads.
+    #endif
+}
+
+
+#ifdef OFD_USE_PERF_EVENTS
+static int ofd_hardware_counter_fds[OFD_HARDWARE_COUNTER_COUNT] = {-1, -1, -1, -1}; // -1 while a counter is closed.
+#endif
+
+ofd_static ofd_b8 ofd_open_hardware_counters(void)
+{
+    ofd_b8 result = ofd_false;
+    
+    #ifdef OFD_USE_PERF_EVENTS
+    static ofd_u64 configs[OFD_HARDWARE_COUNTER_COUNT] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES};
+    
+    for(int i = 0; i < OFD_HARDWARE_COUNTER_COUNT; i++)
     {
-        char character = *c;
-        if(character != ' ' && character != '\t') return c;
-        c++;
+        if(ofd_hardware_counter_fds[i] >= 0) close(ofd_hardware_counter_fds[i]);
+        
+        struct perf_event_attr attributes = {0};
+        attributes.type           = PERF_TYPE_HARDWARE;
+        attributes.size           = sizeof(attributes);
+        attributes.config         = configs[i];
+        attributes.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attributes.inherit        = 1; // Inherited counters cannot be read as a group, so every counter is read on its own.
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv     = 1;
+        
+        ofd_hardware_counter_fds[i] = ofd_cast(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0), int);
+        if(ofd_hardware_counter_fds[i] >= 0) result = ofd_true;
     }
+    #endif
     
-    return c;
+    return result;
 }
 
-ofd_static Ofd_String ofd_get_line_view(char* c, char* lower_limit, char* upper_limit)
+ofd_static void ofd_close_hardware_counters(void)
 {
-    while(c >= lower_limit)
+    #ifdef OFD_USE_PERF_EVENTS
+    for(int i = 0; i < OFD_HARDWARE_COUNTER_COUNT; i++)
     {
-        if(*c == '\n' || *c == '\r') break;
-        c--;
+        if(ofd_hardware_counter_fds[i] >= 0) close(ofd_hardware_counter_fds[i]);
+        ofd_hardware_counter_fds[i] = -1;
     }
-    c++;
+    #endif
+}
+
+ofd_static ofd_b8 ofd_hardware_counter_is_open(Ofd_Hardware_Counter counter)
+{
+    #ifdef OFD_USE_PERF_EVENTS
+    return ofd_hardware_counter_fds[counter] >= 0;
+    #else
+    return ofd_false;
+    #endif
+}
+
+ofd_static ofd_u64 ofd_read_hardware_counter(Ofd_Hardware_Counter counter)
+{ // The count goes up from when the counter was opened, it is scaled up when the kernel had to share the hardware with other counters.
+    #ifdef OFD_USE_PERF_EVENTS
+    ofd_u64 values[3]; // The count, time enabled and time running.
+    if(ofd_hardware_counter_fds[counter] < 0 || read(ofd_hardware_counter_fds[counter], values, sizeof(values)) != sizeof(values)) return 0;
     
-    Ofd_String result = {c};
-    while(c < upper_limit)
-    {
-        if(*c == '\n' || *c == '\r') break;
-        c++;
-    }
+    if(values[2] == 0)         return 0;
+    if(values[2] == values[1]) return values[0];
+    return ofd_cast(ofd_cast(values[0], ofd_f64) * values[1] / values[2], ofd_u64);
+    #else
+    (void)counter;
+    return 0;
+    #endif
+}
+
+
+static Ofd_Trace* ofd_trace; // NULL while the trace is off.
+
+ofd_static void ofd_begin_trace(Ofd_Trace* trace)
+{
+    ofd_array_init(&trace->spans,   sizeof(Ofd_Trace_Span));
+    ofd_array_init(&trace->strings, 1);
+    ofd_mutex_init(&trace->mutex);
     
-    result.count = c - result.data;
-    return result;
+    trace->start_time       = ofd_get_wall_time();
+    trace->phase_start_time = trace->start_time;
+    
+    ofd_trace = trace;
 }
 
-ofd_static void ofd_log_error(Ofd_Array* log_data, Ofd_String line_view, Ofd_String message)
+ofd_static void ofd_end_trace(void)
 {
-    ofd_array_add_string(log_data, Ofd_String_("*** Error ***\n"));
-    ofd_array_add_string(log_data, line_view);
-    ofd_array_add_string(log_data, Ofd_String_("\n\n"));
-    ofd_array_add_string(log_data, message);
-    ofd_array_add_string(log_data, Ofd_String_("\n\n"));
+    ofd_trace = NULL;
 }
 
-ofd_static char* ofd_parse_link(char* c, char* limit, Ofd_Array* link_references, Ofd_String* result_name, Ofd_String* result_address, Ofd_String* result_title, Ofd_Array* additional_css, Ofd_Array* log_data)
+ofd_static void ofd_free_trace(Ofd_Trace* trace)
 {
-    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    // NOTE: c should point to the first '['. If this turns out to no be an actual link, this routine returns NULL; Otherwise it returns the first character
-    // to come after the link element.
-    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    ofd_free_array(&trace->spans);
+    ofd_free_array(&trace->strings);
+    ofd_free_mutex(&trace->mutex);
+}
+
+ofd_static ofd_f64 ofd_begin_trace_span(void)
+{
+    return ofd_trace? ofd_get_wall_time() : 0;
+}
+
+ofd_static void ofd_end_trace_span(char* name, ofd_f64 start_time, Ofd_String detail, int size)
+{
+    Ofd_Trace* trace = ofd_trace;
+    if(!trace) return;
     
-    char* lower_limit = c;
+    ofd_f64 end_time  = ofd_get_wall_time();
+    ofd_u64 thread_id = ofd_get_thread_id();
     
-    ofd_array_init(additional_css, 1);
+    ofd_mutex_lock(&trace->mutex);
     
-    c++;
-    result_name->data  = c;
-    result_name->count = 0;
+    Ofd_Trace_Span* span = ofd_array_add_fast(&trace->spans);
+    span->name          = name;
+    span->detail_offset = trace->strings.count;
+    span->detail_count  = detail.count;
+    span->size          = size;
+    span->thread_id     = thread_id;
+    span->start_time    = start_time;
+    span->end_time      = end_time;
     
-    int nesting_level = 1;
+    if(detail.count) ofd_array_add_string(&trace->strings, detail);
     
-    while(c < limit)
+    ofd_mutex_unlock(&trace->mutex);
+}
+
+ofd_static void ofd_end_file_trace_span(char* name, ofd_f64 start_time, char* filepath, int size)
+{ // Filepaths may be NULL when documentation is generated from memory.
+    if(!ofd_trace) return;
+    
+    Ofd_String detail = {filepath, filepath? ofd_cast(ofd_strlen(filepath), int) : 0};
+    ofd_end_trace_span(name, start_time, detail, size);
+}
+
+ofd_static void ofd_writer_add_json_string(Ofd_Writer* writer, Ofd_String string)
+{
+    ofd_writer_add_string(writer, Ofd_String_("\""));
+    
+    char* text_start = string.data;
+    for(int i = 0; i < string.count; i++)
     {
-        if(*c == '[')
-        {
-            nesting_level++;
-        }
-        else if(*c == ']')
-        {
-            nesting_level--;
-            if(!nesting_level)
-            {
-                c++;
-                break;
-            }
-        }
+        ofd_u8 character = string.data[i];
+        if(character >= 0x20 && character != '"' && character != '\\') continue;
         
-        result_name->count++;
-        c++;
+        ofd_writer_add(writer, text_start, string.data + i - text_start);
+        
+        char escape[8];
+        ofd_sprintf(escape, "\\u%04x", character);
+        ofd_writer_add_string(writer, Ofd_String_(escape));
+        
+        text_start = string.data + i + 1;
     }
     
-    c = ofd_skip_whitespace(c, limit);
-    if(c == limit) return NULL; // This does not appear to be a link after all.
+    ofd_writer_add(writer, text_start, string.data + string.count - text_start);
+    ofd_writer_add_string(writer, Ofd_String_("\""));
+}
+
+ofd_static void ofd_write_trace(Ofd_Trace* trace, Ofd_Writer* writer)
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: every span becomes a complete event ("ph":"X") with its start and duration in microseconds. Viewers nest spans of the same
+    // lane by time so the order they were recorded in (when they ended) does not matter. Lanes are numbered from 1 in the order threads
+    // first show up.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     
+    char buffer[256];
     
-    if(*c == '[')
+    Ofd_Array thread_ids;
+    ofd_array_init(&thread_ids, sizeof(ofd_u64));
+    
+    ofd_writer_add_string(writer, Ofd_String_("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"));
+    
+    for(int span_index = 0; span_index < trace->spans.count; span_index++)
     {
-        // This link uses a reference. START
-        // @ We should log errors!!!
-        c++;
-        Ofd_String ref_id = {c};
-        while(c < limit)
+        Ofd_Trace_Span* span = ofd_cast(trace->spans.data, Ofd_Trace_Span*) + span_index;
+        
+        // Find the lane of the span. START
+        int lane = 0;
+        while(lane < thread_ids.count)
         {
-            char character = *c;
-            if(character == ']') break;
-            if(character == '\n' || character == '\r')
-            {
-                Ofd_String line_view = ofd_get_line_view(c, lower_limit, limit);
-                ofd_log_error(log_data, line_view, Ofd_String_("This does not look like a valid link reference."));
-                return NULL; // This does not look like a valid link reference.
-            }
-            
-            c++;
-        }
-        
-        ref_id.count = c - ref_id.data;
-        c++; // Skip ']'.
-        
-        Ofd_Link_Reference* reference = NULL;
-        for(int i = 0; i < link_references->count; i++)
-        {
-            Ofd_Link_Reference* ref = ofd_cast(link_references->data, Ofd_Link_Reference*) + i;
-            if(ofd_strings_match(ref->id, ref_id))
-            {
-                reference = ref;
-                break;
-            }
+            if(ofd_cast(thread_ids.data, ofd_u64*)[lane] == span->thread_id) break;
+            lane++;
         }
         
-        if(!reference)
+        if(lane == thread_ids.count)
         {
-            Ofd_String line_view = ofd_get_line_view(c, lower_limit, limit);
-            ofd_log_error(log_data, line_view, Ofd_String_("The reference to this link could no be found. Make sure to declare a reference *before* using it."));
-            return NULL; // The reference for this link could not be found.
+            ofd_u64* thread_id = ofd_array_add_fast(&thread_ids);
+            *thread_id = span->thread_id;
+            
+            ofd_sprintf(buffer, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"Thread %d\"}},\n", lane + 1, lane + 1);
+            ofd_writer_add_string(writer, Ofd_String_(buffer));
         }
+        // Find the lane of the span. END
         
-        *result_address = reference->link_address;
-        *result_title   = reference->link_title;
-        
-        if(reference->additional_css.count)
-        {
-            char* css = ofd_array_add_fast_multiple(additional_css, reference->additional_css.count);
-            ofd_copy(css, reference->additional_css.data, reference->additional_css.count);
-        }
-        // This link uses a reference. END
         
-        return c;
-    }
-    
-    
-    if(*c == '(')
-    { // This is definitely a link.
-        c++;
+        ofd_writer_add_string(writer, Ofd_String_("{\"name\":"));
+        ofd_writer_add_json_string(writer, Ofd_String_(span->name));
         
-        result_address->data  = c;
-        result_address->count = 0;
-        result_title->count   = 0;
+        ofd_sprintf(buffer, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{", lane + 1,
+                    (span->start_time - trace->start_time) * 1e6, (span->end_time - span->start_time) * 1e6);
+        ofd_writer_add_string(writer, Ofd_String_(buffer));
         
-        while(c < limit)
-        { // Retrieve the link address.
-            char character = *c;
-            if(character == ' ' || character == '\t' || character == ')') break;
-            
-            result_address->count++;
-            c++; 
+        if(span->detail_count)
+        {
+            Ofd_String detail = {trace->strings.data + span->detail_offset, span->detail_count};
+            ofd_writer_add_string(writer, Ofd_String_("\"detail\":"));
+            ofd_writer_add_json_string(writer, detail);
+            if(span->size >= 0) ofd_writer_add_string(writer, Ofd_String_(","));
         }
         
-        if(c < limit && *c != ')')
-        { // There is more to parse.
-            while(c < limit)
-            {
-                c = ofd_skip_whitespace(c, limit);
-                if(c == limit) break;
-                
-                char character = *c;
-                
-                if(character == '"')
-                {
-                    // Retrieve a title. START
-                    c++;
-                    result_title->data  = c;
-                    result_title->count = 0;
-                    while(c < limit)
-                    { // Get the link title.
-                        if(*c == '"')
-                        {
-                            c++;
-                            break;
-                        }
-                        
-                        result_title->count++;
-                        c++;
-                    }
-                    // Retrieve a title. END
-                    
-                    continue;
-                }
-                
-                
-                if(character == 'w' || character == 'h' || character == 'r')
-                {
-                    // Parse additional CSS. START
-                    if(c + 1 < limit && c[1] == '=') c++;
-                    if(c + 1 < limit && c[1] == '"')
-                    {
-                        c += 2;
-                        
-                        Ofd_String css = {c};
-                        while(c < limit)
-                        {
-                            if(*c == '"')
-                            {
-                                c++;
-                                break;
-                            }
-                            
-                            css.count++;
-                            c++;
-                        }
-                        
-                        if     (character == 'w') ofd_array_add_string(additional_css, Ofd_String_("width: "));
-                        else if(character == 'h') ofd_array_add_string(additional_css, Ofd_String_("height: "));
-                        else if(character == 'r') ofd_array_add_string(additional_css, Ofd_String_("border-radius: "));
-                        
-                        ofd_array_add_string(additional_css, css);
-                        ofd_array_add_string(additional_css, Ofd_String_(";"));
-                        
-                        continue;
-                    }
-                    // Parse additional CSS. END
-                }
-                
-                
-                if(character == ')')
-                { // This is the end of the link.
-                    c++;
-                    break;
-                }
-                
-                c++;
-            }
+        if(span->size >= 0)
+        {
+            ofd_sprintf(buffer, "\"bytes\":%d", span->size);
+            ofd_writer_add_string(writer, Ofd_String_(buffer));
         }
-        else c += (c != limit);
         
-        
-        return c;
+        ofd_writer_add_string(writer, (span_index + 1 < trace->spans.count)? Ofd_String_("}},\n") : Ofd_String_("}}\n"));
     }
     
+    ofd_writer_add_string(writer, Ofd_String_("]}\n"));
     
-    return NULL;
+    ofd_free_array(&thread_ids);
 }
 
-ofd_static char* ofd_maybe_handle_a_horizontal_rule(char* c, char* limit, char indicator, Ofd_Array* result_html, Ofd_String* text_to_spill)
-{
-    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    // NOTE: if this does not turn out to be a horizontal rule this routine returns NULL, otherwise it returns the next character to parse.
-    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    
-    int num_indicators_in_a_row = 0;
-    while(c < limit)
-    {
-        if(*c != indicator) break;
-        
-        num_indicators_in_a_row++;
-        c++;
-    }
-    
-    if(num_indicators_in_a_row >= 3 && (c == limit || *c == '\n' || *c == '\r'))
-    {
-        ofd_array_add_string(result_html, *text_to_spill);
-        text_to_spill->count = 0;
-        
-        ofd_array_add_string(result_html, Ofd_String_("<div class='ofd-horizontal-rule'></div>"));
-        
-        if(c < limit)
-        { // Go to the next line.
-            if(*c == '\n') c++;
-            if(c < limit && *c == '\r') c++;
-        }
-        
-        return c;
-    }
-    
-    
-    return NULL;
-}
 
-ofd_static char* ofd_get_next_character_like_in_line(char* c, char* limit, char wanted, char** result_line_end)
+ofd_static void ofd_array_grow(Ofd_Array* array, int new_count)
 {
-    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    // NOTE: if a suitable character is found this routine returns the address at which the character was found, otherwise it returns NULL. If the end of
-    // the line is reached result_line_end takes its address.
-    // We skip code blocks and escaped characters.
-    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    ofd_assert(array->max_count < new_count);
     
-    *result_line_end = NULL;
+    int new_max_count = new_count * 2;
     
-    ofd_b8 ignore_next_character  = ofd_false;
-    char* code_block_start = NULL;
-    int code_block_start_count = 0;
+    int new_size = new_max_count * array->item_size;
     
-    while(c < limit)
+    if(array->arena)
     {
-        char character = *c;
-        if(character == '\n' || character == '\r')
-        {
-            *result_line_end = c;
-            break; // We reached the end of the line.
-        }
+        char* old_data = array->data;
         
-        if(!ignore_next_character)
-        {
-            if(character == '\\') ignore_next_character = (code_block_start == NULL);
-            else if(character == '`')
-            {
-                if(code_block_start)
-                { // Check if we reached the end of a code block.
-                    if(c + code_block_start_count <= limit)
-                    {
-                        char* tmp_c = c;
-                        while(tmp_c < limit)
-                        {
-                            if(*tmp_c != '`') break;
-                            tmp_c++;
-                        }
-                        
-                        int num_backticks = tmp_c - c;
-                        if(num_backticks == code_block_start_count)
-                        {
-                            c += code_block_start_count;
-                            
-                            code_block_start       = NULL;
-                            code_block_start_count = 0;
-                            continue; // We reached the end of a code block.
-                        }
-                        
-                        c += num_backticks;
-                        continue;
-                    }
-                }
-                else
-                {
-                    // Handle a code block start. START
-                    code_block_start       = c;
-                    code_block_start_count = 0;
-                    while(c < limit && code_block_start_count < OFD_MAX_CODE_BLOCK_INDICATOR_COUNT)
-                    {
-                        if(*c != '`') break;
-                        
-                        code_block_start_count++;
-                        c++;
-                    }
-                    // Handle a code block start. END
-                    
-                    continue;
-                }
-            }
-            else if(character == wanted && !code_block_start) return c;
+        array->data = ofd_arena_resize(array->arena, array->data, array->max_count * array->item_size, new_size);
+        if(old_data && array->data != old_data)
+        { // It could not grow in place.
+            ofd_count_copy(array->max_count * array->item_size, array->allocation_tag);
         }
-        else ignore_next_character = ofd_false;
         
-        c++;
+        array->max_count = new_max_count;
+        return;
     }
     
-    return NULL;
+    char* new_data = ofd_tagged_allocate(new_size, array->allocation_tag);
+    
+    if(array->data)
+    { // memcpy() on NULL lets the compiler assume array->data is not NULL, which breaks allocators that check for it in ofd_free().
+        ofd_copy(new_data, array->data, array->count * array->item_size);
+        ofd_count_copy(array->count * array->item_size, array->allocation_tag);
+        ofd_tagged_free(array->data);
+    }
+    array->data      = new_data;
+    array->max_count = new_max_count;
 }
 
-
-ofd_static void ofd_syntax_insert_token(Ofd_Array* result_html, Ofd_String token)
+ofd_static void ofd_array_init(Ofd_Array* array, int item_size)
 {
-    ofd_b8 got_filtered = ofd_filter_plain_text(&token);
-    ofd_array_add_string(result_html, token);
-    if(got_filtered) ofd_free(token.data);
+    array->data           = NULL;
+    array->item_size      = item_size;
+    array->count          = 0;
+    array->max_count      = 0;
+    array->allocation_tag = OFD_ALLOCATION_ARRAY;
+    array->arena          = NULL;
 }
 
-ofd_static void ofd_syntax_spill_basic_text(Ofd_Array* result_html, Ofd_String* basic_text, const Ofd_String* keywords, int num_keywords)
+ofd_static void ofd_array_init_in_arena(Ofd_Array* array, int item_size, Ofd_Arena* arena)
 {
-    ofd_b8 got_a_keyword = ofd_false;
-    for(int i = 0; i < num_keywords; i++)
-    {
-        if(ofd_strings_match(keywords[i], *basic_text))
-        {
-            got_a_keyword = ofd_true;
-            
-            ofd_array_add_string(result_html, Ofd_String_("<div class='ofd-syntax ofd-syntax-keyword'>"));
-            ofd_syntax_insert_token(result_html, *basic_text);
-            ofd_array_add_string(result_html, Ofd_String_("</div>"));
-            
-            basic_text->count = 0;
-            return;
-        }
-    }
-    
-    if(!got_a_keyword)
-    {
-        ofd_syntax_insert_token(result_html, *basic_text);
-        basic_text->count = 0;
-    }
+    ofd_array_init(array, item_size);
+    array->arena = arena;
 }
 
-ofd_static void ofd_syntax_spill_basic_text_no_keywords(Ofd_Array* result_html, Ofd_String* basic_text)
+ofd_static void ofd_array_init_with_space(Ofd_Array* array, int item_size, int num_items_to_preallocate)
 {
-    ofd_syntax_insert_token(result_html, *basic_text);
-    basic_text->count = 0;
+    array->data           = ofd_tagged_allocate(num_items_to_preallocate * item_size, OFD_ALLOCATION_ARRAY);
+    array->item_size      = item_size;
+    array->count          = 0;
+    array->max_count      = num_items_to_preallocate;
+    array->allocation_tag = OFD_ALLOCATION_ARRAY;
+    array->arena          = NULL;
 }
 
-ofd_static char* ofd_syntax_handle_string(Ofd_Array* result_html, char* c, char* limit)
+ofd_static void* ofd_array_add_fast(Ofd_Array* array)
 {
-    ////////////////////////////////////////////////////////////////////////////////////////////////////
-    // NOTE: we expect c to start on the first delimiter character of the string, e.g. on the first '"'.
-    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    if(array->max_count == array->count) ofd_array_grow(array, array->count + 1);
     
-    char delimiter = *c;
-    Ofd_String token = {c};
-    c++;
+    void* data = array->data + array->count * array->item_size;
+    array->count++;
     
-    ofd_b8 is_escaped = ofd_false;
-    while(c < limit)
+    return data;
+}
+
+ofd_static void* ofd_array_add_fast_multiple(Ofd_Array* array, int count)
+{
+    if(array->max_count < array->count + count) ofd_array_grow(array, array->count + count);
+    
+    void* data = array->data + array->count * array->item_size;
+    array->count += count;
+    
+    return data;
+}
+
+ofd_static void ofd_array_add_string(Ofd_Array* destination, Ofd_String source)
+{
+    int new_count = destination->count + source.count;
+    
+    if(destination->max_count < new_count) ofd_array_grow(destination, new_count);
+    
+    ofd_copy(destination->data + destination->count, source.data, source.count);
+    destination->count = new_count;
+}
+
+ofd_static void ofd_array_add_array(Ofd_Array* destination, Ofd_Array* source)
+{
+    ofd_assert(destination->item_size == source->item_size);
+    
+    int new_count = destination->count + source->count;
+    
+    if(destination->max_count < new_count) ofd_array_grow(destination, new_count);
+    
+    ofd_copy(destination->data + destination->count * destination->item_size, source->data, source->count * destination->item_size);
+    destination->count = new_count;
+}
+
+ofd_static void ofd_free_array(Ofd_Array* array)
+{
+    if(!array->data) return;
+    
+    if(array->arena) ofd_arena_release(array->arena, array->data, array->max_count * array->item_size);
+    else             ofd_tagged_free(array->data);
+    
+    array->max_count = 0;
+    array->count     = 0;
+    array->data      = NULL;
+}
+
+
+#ifndef OFD_NO_FILE_IO
+ofd_static ofd_b8 ofd_read_whole_file(char* filepath, Ofd_String* result)
+{
+    result->data  = NULL;
+    result->count = 0;
+    
+    ofd_b8 status = ofd_false;
+    
+    FILE* f = fopen(filepath, "rb");
+    if(f)
     {
-        if(is_escaped)
+        status = ofd_true;
+        
+        long size = -1;
+        if(fseek(f, 0, SEEK_END) == 0) size = ftell(f);
+        
+        if(size >= 0)
         {
-            is_escaped = ofd_false;
-            c++;
-            continue;
+            result->count = size;
+            rewind(f);
+            
+            result->data = ofd_tagged_allocate(result->count, OFD_ALLOCATION_FILES);
+            int num_bytes_read = fread(result->data, 1, result->count, f);
+            if(num_bytes_read != result->count) status = ofd_false;
+        }
+        else
+        { // We cannot know the size in advance (this is a pipe for example) so we read until the end.
+            Ofd_Array data;
+            ofd_array_init_with_space(&data, 1, 64 * 1024);
+            data.allocation_tag = OFD_ALLOCATION_FILES;
+            
+            int num_bytes_read;
+            do
+            {
+                char* destination = ofd_array_add_fast_multiple(&data, 4096);
+                num_bytes_read = fread(destination, 1, 4096, f);
+                data.count -= 4096 - num_bytes_read;
+            } while(num_bytes_read == 4096);
+            
+            result->data  = data.data;
+            result->count = data.count;
+            
+            if(ferror(f)) status = ofd_false;
         }
         
-        if(*c == '\\') is_escaped = ofd_true;
-        else if(*c == delimiter)
-        {
-            c++;
-            break;
+        if(!status)
+        { // We failed to read the file.
+            ofd_tagged_free(result->data);
+            result->data  = NULL;
+            result->count = 0;
+            
+            ofd_printf("Failed to correctly read file '%s'.\n", filepath);
         }
         
-        c++;
+        fclose(f);
     }
+    else ofd_printf("Failed to open file '%s'.\n", filepath);
     
-    token.count = c - token.data;
+    return status;
+}
+
+ofd_static ofd_b8 ofd_write_whole_file(char* filepath, void* data, int count)
+{
+    ofd_b8 status = ofd_false;
     
-    ofd_array_add_string(result_html, Ofd_String_("<div class='ofd-syntax ofd-syntax-string'>"));
-    ofd_syntax_insert_token(result_html, token);
-    ofd_array_add_string(result_html, Ofd_String_("</div>"));
+    FILE* f = fopen(filepath, "wb");
+    if(f)
+    {
+        status = ofd_true;
+        
+        int num_bytes_written = fwrite(data, 1, count, f);
+        if(num_bytes_written != count)
+        { // We failed to write the file.
+            ofd_printf("Failed to correctly write file '%s'.\n", filepath);
+            status = ofd_false;
+        }
+        
+        fclose(f);
+    }
+    else ofd_printf("Failed to create file '%s'.\n", filepath);
     
-    return c;
+    return status;
 }
 
-ofd_static char* ofd_syntax_handle_number(Ofd_Array* result_html, char* c, char* limit)
+ofd_static ofd_b8 ofd_map_whole_file(char* filepath, Ofd_String* result, ofd_b8* result_is_mapped)
 {
-    Ofd_String token = {c};
-    while(c < limit)
+    *result_is_mapped = ofd_false;
+    
+    #ifdef OFD_USE_MMAP
+    int file_descriptor = open(filepath, O_RDONLY);
+    if(file_descriptor >= 0)
     {
-        char character = *c;
+        struct stat file_info;
+        ofd_b8 can_be_mapped = (fstat(file_descriptor, &file_info) == 0 && S_ISREG(file_info.st_mode) && file_info.st_size > 0 && file_info.st_size <= 0x7FFFFFFF);
+        
+        void* data = can_be_mapped? mmap(NULL, file_info.st_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0) : MAP_FAILED;
+        close(file_descriptor); // The mapping stays valid after this.
         
-        if(
-            character != '.' &&
-            character != '_' &&
-            !(character >= '0' && character <= '9') &&
-            !(character >= 'a' && character <= 'z') &&
-            !(character >= 'A' && character <= 'Z')
-        )
+        if(data != MAP_FAILED)
         {
-            break;
+            madvise(data, file_info.st_size, MADV_SEQUENTIAL); // We go through the file once from start to end.
+            
+            result->data      = data;
+            result->count     = file_info.st_size;
+            *result_is_mapped = ofd_true;
+            
+            return ofd_true;
         }
-        
-        c++;
+    }
+    #endif // OFD_USE_MMAP
+    
+    return ofd_read_whole_file(filepath, result);
+}
+
+ofd_static void ofd_release_whole_file(Ofd_String* file, ofd_b8 is_mapped)
+{
+    #ifdef OFD_USE_MMAP
+    if(is_mapped) munmap(file->data, file->count);
+    else          ofd_tagged_free(file->data);
+    #else
+    ofd_tagged_free(file->data);
+    #endif // OFD_USE_MMAP
+    
+    file->data  = NULL;
+    file->count = 0;
+}
+#endif // OFD_NO_FILE_IO
+
+
+ofd_static void ofd_writer_init(Ofd_Writer* writer, Ofd_Write_Callback* callback, void* user_data)
+{
+    writer->callback     = callback;
+    writer->user_data    = user_data;
+    writer->buffer_count = 0;
+    writer->failed       = ofd_false;
+    writer->file         = NULL;
+    writer->num_bytes    = 0;
+    
+    writer->replaced_filepath  = NULL;
+    writer->temporary_filepath = NULL;
+}
+
+ofd_static ofd_b8 ofd_write_to_array(void* user_data, void* data, int count)
+{
+    Ofd_Array* array = ofd_cast(user_data, Ofd_Array*);
+    
+    char* destination = ofd_array_add_fast_multiple(array, count);
+    ofd_copy(destination, data, count);
+    
+    return ofd_true;
+}
+
+ofd_static void ofd_writer_init_with_array(Ofd_Writer* writer, Ofd_Array* array)
+{
+    ofd_writer_init(writer, ofd_write_to_array, array);
+}
+
+#ifndef OFD_NO_FILE_IO
+ofd_static ofd_b8 ofd_write_to_file(void* user_data, void* data, int count)
+{
+    Ofd_Writer* writer = ofd_cast(user_data, Ofd_Writer*);
+    
+    int num_bytes_written = fwrite(data, 1, count, ofd_cast(writer->file, FILE*));
+    return num_bytes_written == count;
+}
+
+ofd_static ofd_b8 ofd_writer_init_with_file(Ofd_Writer* writer, char* filepath)
+{
+    ofd_writer_init(writer, ofd_write_to_file, writer);
+    
+    writer->file = fopen(filepath, "wb");
+    if(!writer->file)
+    {
+        ofd_printf("Failed to create file '%s'.\n", filepath);
+        writer->failed = ofd_true;
     }
     
+    return !writer->failed;
+}
+
+ofd_static ofd_b8 ofd_writer_init_with_file_replacement(Ofd_Writer* writer, char* filepath)
+{
+    char* temporary_filepath = ofd_tagged_allocate(ofd_strlen(filepath) + 5, OFD_ALLOCATION_FILES);
+    ofd_sprintf(temporary_filepath, "%s.tmp", filepath);
     
-    token.count = c - token.data;
+    ofd_b8 status = ofd_writer_init_with_file(writer, temporary_filepath);
     
-    ofd_array_add_string(result_html, Ofd_String_("<div class='ofd-syntax ofd-syntax-number'>"));
-    ofd_syntax_insert_token(result_html, token);
-    ofd_array_add_string(result_html, Ofd_String_("</div>"));
+    writer->replaced_filepath  = filepath;
+    writer->temporary_filepath = temporary_filepath;
     
-    return c;
+    return status;
 }
+#endif // OFD_NO_FILE_IO
 
+ofd_static ofd_b8 ofd_writer_flush(Ofd_Writer* writer)
+{
+    if(writer->buffer_count && !writer->failed)
+    {
+        if(!writer->callback(writer->user_data, writer->buffer, writer->buffer_count)) writer->failed = ofd_true;
+    }
+    
+    writer->buffer_count = 0;
+    
+    return !writer->failed;
+}
 
-ofd_static void ofd_apply_c_syntax_highlighting(Ofd_Array* result_html, Ofd_String text, Ofd_String single_line_comment_start, Ofd_String multi_line_comment_start, Ofd_String multi_line_comment_end, const Ofd_String* keywords, int num_keywords, Ofd_Syntax_Flags flags)
+ofd_static void ofd_writer_add(Ofd_Writer* writer, void* data, int count)
 {
-    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    // NOTE: if the language does not support a certain type of commenting style just set the corresponding comment indicator to a blank value, i.e. "".
-    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    writer->num_bytes += count;
+    if(writer->failed) return;
     
-    ofd_b8 supports_nested_multiline_comments = (flags & OFD_SUPPORTS_NESTED_MULTI_LINE_COMMENTS) != 0;
+    if(writer->buffer_count + count > OFD_WRITER_BUFFER_SIZE) ofd_writer_flush(writer);
     
-    char* c           = text.data;
-    char* limit       = text.data + text.count;
-    char* lower_limit = text.data;
+    if(count >= OFD_WRITER_BUFFER_SIZE)
+    { // Big enough to not go through the buffer.
+        if(!writer->failed && !writer->callback(writer->user_data, data, count)) writer->failed = ofd_true;
+        return;
+    }
+    
+    ofd_copy(writer->buffer + writer->buffer_count, data, count);
+    writer->buffer_count += count;
+}
+
+ofd_static void ofd_writer_add_string(Ofd_Writer* writer, Ofd_String string)
+{
+    ofd_writer_add(writer, string.data, string.count);
+}
+
+ofd_static ofd_b8 ofd_close_writer(Ofd_Writer* writer)
+{
+    ofd_writer_flush(writer);
+    
+    #ifndef OFD_NO_FILE_IO
+    if(writer->file)
+    {
+        if(fclose(ofd_cast(writer->file, FILE*)) != 0) writer->failed = ofd_true;
+        writer->file = NULL;
+    }
+    
+    if(writer->temporary_filepath)
+    {
+        #if defined(_WIN32) || defined(_WIN64)
+        if(!writer->failed) remove(writer->replaced_filepath); // rename() does not replace files on Windows.
+        #endif
+        
+        if(!writer->failed && rename(writer->temporary_filepath, writer->replaced_filepath) != 0) writer->failed = ofd_true;
+        if(writer->failed) remove(writer->temporary_filepath);
+        
+        ofd_tagged_free(writer->temporary_filepath);
+        writer->temporary_filepath = NULL;
+    }
+    #endif // OFD_NO_FILE_IO
+    
+    return !writer->failed;
+}
+
+
+ofd_static void ofd_colour_to_string(Ofd_Colour colour, char* result)
+{
+    if(colour.a < 0.999f)
+    {
+        ofd_sprintf(result, "#%02x%02x%02x%02x", ofd_cast(colour.r * 255.0f, int), ofd_cast(colour.g * 255.0f, int), ofd_cast(colour.b * 255.0f, int), ofd_cast(colour.a * 255.0f, int));
+    }
+    else
+    {
+        ofd_sprintf(result, "#%02x%02x%02x", ofd_cast(colour.r * 255.0f, int), ofd_cast(colour.g * 255.0f, int), ofd_cast(colour.b * 255.0f, int));
+    }
+}
+
+
+ofd_static char* ofd_find_character_to_filter(char* c, char* limit)
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: this returns the address of the first '<', '>' or 'h' (which could start an auto-link), or limit if none is found.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    #ifdef OFD_USE_SSE2
+    __m128i less_than    = _mm_set1_epi8('<');
+    __m128i greater_than = _mm_set1_epi8('>');
+    __m128i h            = _mm_set1_epi8('h');
+    
+    while(c + 16 <= limit)
+    {
+        __m128i bytes   = _mm_loadu_si128(ofd_cast(c, __m128i*));
+        __m128i matches = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, less_than), _mm_cmpeq_epi8(bytes, greater_than)), _mm_cmpeq_epi8(bytes, h));
+        
+        int mask = _mm_movemask_epi8(matches);
+        if(mask) return c + ofd_get_first_set_bit(mask);
+        
+        c += 16;
+    }
+    #endif
+    
+    while(c < limit)
+    {
+        char character = *c;
+        if(character == '<' || character == '>' || character == 'h') return c;
+        c++;
+    }
+    
+    return c;
+}
+
+ofd_static void ofd_array_add_filtered_text(Ofd_Array* destination, Ofd_String text)
+{
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: this adds text to destination while escaping '<' and '>' and turning http(s):// addresses into links.
+    // Text that needs no filtering is copied in one go.
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     
-    Ofd_String basic_text        = {c};
-    Ofd_String current_directive = {0};
+    char* c     = text.data;
+    char* limit = text.data + text.count;
     
+    Ofd_String text_that_needs_no_filtering = {c};
+    
+    int allocation_tag = destination->allocation_tag; // Growth caused by filtering is counted apart, see Ofd_Allocation_Stats.
+    destination->allocation_tag = OFD_ALLOCATION_FILTER;
     
     while(c < limit)
     {
-        if(single_line_comment_start.count && c + single_line_comment_start.count <= limit && ofd_memcmp(c, single_line_comment_start.data, single_line_comment_start.count) == 0)
+        c = ofd_find_character_to_filter(c, limit);
+        if(c == limit) break;
+        
+        char character = *c;
+        if(character == 'h')
         {
-            // Handle a single line comment. START
-            ofd_syntax_spill_basic_text(result_html, &basic_text, keywords, num_keywords);
+            ofd_b8 is_a_link = ofd_false;
+            if(c + 7 <= limit) is_a_link |= (ofd_memcmp(c, "http://",  7) == 0);
+            if(c + 8 <= limit) is_a_link |= (ofd_memcmp(c, "https://", 8) == 0);
             
-            Ofd_String token = {c};
-            c += single_line_comment_start.count;
-            while(c < limit)
+            if(!is_a_link)
             {
-                if(*c == '\n' || *c == '\r') break;
                 c++;
+                continue;
             }
-            
-            token.count = c - token.data;
-            
-            ofd_array_add_string(result_html, Ofd_String_("<div class='ofd-syntax ofd-syntax-comment'>"));
-            ofd_syntax_insert_token(result_html, token);
-            ofd_array_add_string(result_html, Ofd_String_("</div>"));
-            // Handle a single line comment. END
-            
-            continue;
         }
         
-        if(multi_line_comment_start.count && c + multi_line_comment_start.count <= limit && ofd_memcmp(c, multi_line_comment_start.data, multi_line_comment_start.count) == 0)
+        text_that_needs_no_filtering.count = c - text_that_needs_no_filtering.data;
+        ofd_array_add_string(destination, text_that_needs_no_filtering);
+        
+        switch(character)
         {
-            // Handle a multi-line comment. START
-            ofd_syntax_spill_basic_text(result_html, &basic_text, keywords, num_keywords);
+            case '<':
+            {
+                ofd_array_add_string(destination, Ofd_String_("&lt"));
+                c++;
+            } break;
             
-            int imbrication_level = 1;
+            case '>':
+            {
+                ofd_array_add_string(destination, Ofd_String_("&gt"));
+                c++;
+            } break;
             
-            Ofd_String token = {c};
-            c += multi_line_comment_start.count;
-            while(c < limit)
+            case 'h':
             {
-                if(c + multi_line_comment_end.count <= limit && ofd_memcmp(c, multi_line_comment_end.data, multi_line_comment_end.count) == 0)
-                { // Check for the end of the comment.
-                    c += multi_line_comment_end.count;
-                    imbrication_level--;
-                    if(!imbrication_level) break; // This is the end of the multi-line comment.
-                    
-                    continue;
+                // Add a link. START
+                Ofd_String link = {c};
+                while(c < limit)
+                { // Retrieve the full link.
+                    character = *c;
+                    if(character == ' ' || character == '\t' || character == '\n' || character == '\r' || character == '"') break;
+                    c++;
                 }
                 
-                if(supports_nested_multiline_comments)
-                {
-                    if(c + multi_line_comment_start.count <= limit && ofd_memcmp(c, multi_line_comment_start.data, multi_line_comment_start.count) == 0)
-                    { // Check for a nested multi-line comment.
-                        c += multi_line_comment_start.count;
-                        imbrication_level++;
-                        continue;
-                    }
-                }
+                link.count = c - link.data;
                 
+                ofd_array_add_string(destination, Ofd_String_("<a class='ofd-external-link' target='_blank' href='"));
+                ofd_array_add_string(destination, link);
+                ofd_array_add_string(destination, Ofd_String_("'>"));
+                ofd_array_add_string(destination, link);
+                ofd_array_add_string(destination, Ofd_String_("</a>"));
+                // Add a link. END
+            } break;
+        }
+        
+        text_that_needs_no_filtering.data = c;
+    }
+    
+    text_that_needs_no_filtering.count = limit - text_that_needs_no_filtering.data;
+    ofd_array_add_string(destination, text_that_needs_no_filtering);
+    
+    destination->allocation_tag = allocation_tag;
+}
+
+ofd_static char* ofd_skip_whitespace(char* c, char* limit)
+{
+    while(c < limit)
+    {
+        char character = *c;
+        if(character != ' ' && character != '\t') return c;
+        c++;
+    }
+    
+    return c;
+}
+
+ofd_static Ofd_String ofd_get_line_view(char* c, char* lower_limit, char* upper_limit)
+{
+    while(c >= lower_limit)
+    {
+        if(*c == '\n' || *c == '\r') break;
+        c--;
+    }
+    c++;
+    
+    Ofd_String result = {c};
+    while(c < upper_limit)
+    {
+        if(*c == '\n' || *c == '\r') break;
+        c++;
+    }
+    
+    result.count = c - result.data;
+    return result;
+}
+
+ofd_static void ofd_log_error(Ofd_Array* log_data, Ofd_String line_view, Ofd_String message)
+{
+    ofd_array_add_string(log_data, Ofd_String_("*** Error ***\n"));
+    ofd_array_add_string(log_data, line_view);
+    ofd_array_add_string(log_data, Ofd_String_("\n\n"));
+    ofd_array_add_string(log_data, message);
+    ofd_array_add_string(log_data, Ofd_String_("\n\n"));
+}
+
+ofd_static void ofd_link_reference_table_init(Ofd_Link_Reference_Table* table, Ofd_Link_Reference_Table* parent, Ofd_Arena* arena)
+{
+    ofd_array_init_in_arena(&table->references, sizeof(Ofd_Link_Reference), arena);
+    ofd_array_init_in_arena(&table->slots,      sizeof(int),                arena);
+    table->parent  = parent;
+    table->lookups = NULL;
+}
+
+ofd_static Ofd_Link_Reference* ofd_find_link_reference(Ofd_Link_Reference_Table* table, Ofd_String id)
+{
+    unsigned int hash = ofd_hash_string(id);
+    
+    if(table->lookups)
+    {
+        Ofd_String* lookup = ofd_array_add_fast(table->lookups);
+        *lookup = id;
+    }
+    
+    for(; table; table = table->parent)
+    {
+        if(!table->slots.count) continue;
+        
+        int* slots    = ofd_cast(table->slots.data, int*);
+        int slot_mask = table->slots.count - 1;
+        for(int slot_index = hash & slot_mask; slots[slot_index]; slot_index = (slot_index + 1) & slot_mask)
+        {
+            Ofd_Link_Reference* reference = ofd_cast(table->references.data, Ofd_Link_Reference*) + slots[slot_index] - 1;
+            if(ofd_strings_match(reference->id, id)) return reference;
+        }
+    }
+    
+    return NULL;
+}
+
+ofd_static Ofd_Link_Reference* ofd_add_link_reference(Ofd_Link_Reference_Table* table, Ofd_Link_Reference reference)
+{
+    Ofd_Link_Reference* result = ofd_array_add_fast(&table->references);
+    *result = reference;
+    
+    if(table->references.count * 4 > table->slots.count * 3)
+    {
+        // Make the index bigger. START
+        int num_slots = ofd_max(table->slots.count * 2, 64);
+        
+        ofd_free_array(&table->slots);
+        int* slots = ofd_array_add_fast_multiple(&table->slots, num_slots);
+        for(int i = 0; i < num_slots; i++) slots[i] = 0;
+        
+        for(int i = 0; i < table->references.count - 1; i++)
+        {
+            Ofd_Link_Reference* reference_to_move = ofd_cast(table->references.data, Ofd_Link_Reference*) + i;
+            
+            int slot_index = ofd_hash_string(reference_to_move->id) & (num_slots - 1);
+            while(slots[slot_index]) slot_index = (slot_index + 1) & (num_slots - 1);
+            slots[slot_index] = i + 1;
+        }
+        // Make the index bigger. END
+    }
+    
+    int* slots    = ofd_cast(table->slots.data, int*);
+    int slot_mask = table->slots.count - 1;
+    
+    int slot_index = ofd_hash_string(reference.id) & slot_mask;
+    while(slots[slot_index]) slot_index = (slot_index + 1) & slot_mask;
+    slots[slot_index] = table->references.count;
+    
+    return result;
+}
+
+ofd_static char* ofd_parse_link(char* c, char* limit, Ofd_Link_Reference_Table* link_references, Ofd_String* result_name, Ofd_String* result_address, Ofd_String* result_title, Ofd_Array* additional_css, Ofd_Arena* arena, Ofd_Array* log_data)
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: c should point to the first '['. If this turns out to no be an actual link, this routine returns NULL; Otherwise it returns the first character
+    // to come after the link element.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    char* lower_limit = c;
+    
+    ofd_array_init_in_arena(additional_css, 1, arena);
+    additional_css->allocation_tag = OFD_ALLOCATION_LINK_CSS;
+    
+    c++;
+    result_name->data  = c;
+    result_name->count = 0;
+    
+    int nesting_level = 1;
+    
+    while(c < limit)
+    {
+        if(*c == '[')
+        {
+            nesting_level++;
+        }
+        else if(*c == ']')
+        {
+            nesting_level--;
+            if(!nesting_level)
+            {
+                c++;
+                break;
+            }
+        }
+        
+        result_name->count++;
+        c++;
+    }
+    
+    c = ofd_skip_whitespace(c, limit);
+    if(c == limit) return NULL; // This does not appear to be a link after all.
+    
+    
+    if(*c == '[')
+    {
+        // This link uses a reference. START
+        // @ We should log errors!!!
+        c++;
+        Ofd_String ref_id = {c};
+        while(c < limit)
+        {
+            char character = *c;
+            if(character == ']') break;
+            if(character == '\n' || character == '\r')
+            {
+                Ofd_String line_view = ofd_get_line_view(c, lower_limit, limit);
+                ofd_log_error(log_data, line_view, Ofd_String_("This does not look like a valid link reference."));
+                return NULL; // This does not look like a valid link reference.
+            }
+            
+            c++;
+        }
+        
+        ref_id.count = c - ref_id.data;
+        c++; // Skip ']'.
+        
+        Ofd_Link_Reference* reference = ofd_find_link_reference(link_references, ref_id);
+        if(!reference)
+        {
+            Ofd_String line_view = ofd_get_line_view(c, lower_limit, limit);
+            ofd_log_error(log_data, line_view, Ofd_String_("The reference to this link could not be found."));
+            return NULL; // The reference for this link could not be found.
+        }
+        
+        *result_address = reference->link_address;
+        *result_title   = reference->link_title;
+        
+        if(reference->additional_css.count)
+        {
+            char* css = ofd_array_add_fast_multiple(additional_css, reference->additional_css.count);
+            ofd_copy(css, reference->additional_css.data, reference->additional_css.count);
+        }
+        // This link uses a reference. END
+        
+        return c;
+    }
+    
+    
+    if(*c == '(')
+    { // This is definitely a link.
+        c++;
+        
+        result_address->data  = c;
+        result_address->count = 0;
+        result_title->count   = 0;
+        
+        while(c < limit)
+        { // Retrieve the link address.
+            char character = *c;
+            if(character == ' ' || character == '\t' || character == ')') break;
+            
+            result_address->count++;
+            c++; 
+        }
+        
+        if(c < limit && *c != ')')
+        { // There is more to parse.
+            while(c < limit)
+            {
+                c = ofd_skip_whitespace(c, limit);
+                if(c == limit) break;
                 
                 char character = *c;
-                switch(character)
+                
+                if(character == '"')
                 {
-                    case '"':
-                    {
-                        // Skip a string. START
+                    // Retrieve a title. START
+                    c++;
+                    result_title->data  = c;
+                    result_title->count = 0;
+                    while(c < limit)
+                    { // Get the link title.
+                        if(*c == '"')
+                        {
+                            c++;
+                            break;
+                        }
+                        
+                        result_title->count++;
                         c++;
+                    }
+                    // Retrieve a title. END
+                    
+                    continue;
+                }
+                
+                
+                if(character == 'w' || character == 'h' || character == 'r')
+                {
+                    // Parse additional CSS. START
+                    if(c + 1 < limit && c[1] == '=') c++;
+                    if(c + 1 < limit && c[1] == '"')
+                    {
+                        c += 2;
                         
-                        ofd_b8 is_escaped = ofd_false;
+                        Ofd_String css = {c};
                         while(c < limit)
                         {
-                            if(is_escaped)
-                            {
-                                is_escaped = ofd_false;
-                                c++;
-                                continue;
-                            }
-                            
-                            if(*c == '\\') is_escaped = ofd_true;
-                            else if(*c == '"')
+                            if(*c == '"')
                             {
                                 c++;
-                                break; // We reached the end of the string.
+                                break;
                             }
                             
+                            css.count++;
                             c++;
                         }
-                        // Skip a string. END
-                    } break;
-                    
-                    default:
-                    {
-                        c++;
-                    } break;
+                        
+                        if     (character == 'w') ofd_array_add_string(additional_css, Ofd_String_("width: "));
+                        else if(character == 'h') ofd_array_add_string(additional_css, Ofd_String_("height: "));
+                        else if(character == 'r') ofd_array_add_string(additional_css, Ofd_String_("border-radius: "));
+                        
+                        ofd_array_add_string(additional_css, css);
+                        ofd_array_add_string(additional_css, Ofd_String_(";"));
+                        
+                        continue;
+                    }
+                    // Parse additional CSS. END
+                }
+                
+                
+                if(character == ')')
+                { // This is the end of the link.
+                    c++;
+                    break;
                 }
+                
+                c++;
             }
-            
-            token.count = c - token.data;
-            
-            ofd_array_add_string(result_html, Ofd_String_("<div class='ofd-syntax ofd-syntax-comment'>"));
-            ofd_syntax_insert_token(result_html, token);
-            ofd_array_add_string(result_html, Ofd_String_("</div>"));
-            // Handle a multi-line comment. END
-            
-            continue;
         }
+        else c += (c != limit);
         
         
-        char character = *c;
-        switch(character)
+        return c;
+    }
+    
+    
+    return NULL;
+}
+
+ofd_static char* ofd_parse_link_reference(char* c, char* limit, Ofd_Link_Reference* result, Ofd_Arena* arena)
+{
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: c should point to the '[' of what may be a link reference ("[id]: address "title" w="..." h="..." r="...""). If this
+    // is not one this returns NULL, otherwise it returns the start of the next line. The additional CSS goes to arena.
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    char* tmp_c = c;
+    tmp_c++;
+    result->id.data = tmp_c;
+    
+    while(tmp_c < limit)
+    {
+        char character = *tmp_c;
+        if(character == ']') break;
+        tmp_c++;
+    }
+    
+    result->id.count = tmp_c - result->id.data;
+    if(tmp_c + 1 >= limit || tmp_c[1] != ':') return NULL; // This is not a reference.
+    
+    
+    Ofd_String* link_address   = &result->link_address;
+    Ofd_String* link_title     = &result->link_title;
+    Ofd_Array*  additional_css = &result->additional_css;
+    
+    link_address->count = 0;
+    link_title->count   = 0;
+    ofd_array_init_in_arena(additional_css, 1, arena);
+    additional_css->allocation_tag = OFD_ALLOCATION_LINK_CSS;
+    
+    c = tmp_c;
+    c += 2; // Skip ']:'.
+    c = ofd_skip_whitespace(c, limit);
+    
+    // Retrieve the address. START
+    link_address->data = c;
+    while(c < limit)
+    {
+        char character = *c;
+        if(character == ' ' || character == '\t' || character == '\n' || character == '\r') break;
+        c++;
+    }
+    
+    link_address->count = c - link_address->data;
+    // Retrieve the address. END
+    
+    c = ofd_skip_whitespace(c, limit);
+    
+    while(c < limit)
+    {
+        char character = *c;
+        if(character == '\n' || character == '\r') break;
+        
+        if(character == '"')
         {
-            case '{':
-            case '}':
-            case '(':
-            case ')':
-            case '[':
-            case ']':
-            case '?':
-            case ':':
-            case ';':
+            // Parse a link title. START
+            c++;
+            link_title->data = c;
+            while(c < limit)
             {
-                ofd_syntax_spill_basic_text(result_html, &basic_text, keywords, num_keywords);
-                
-                Ofd_String token = {c};
-                while(c < limit)
-                {
-                    if(*c != character) break;
-                    c++;
-                }
-                
-                token.count = c - token.data;
-                
-                ofd_array_add_string(result_html, Ofd_String_("<div class='ofd-syntax ofd-syntax-structure'>"));
-                ofd_syntax_insert_token(result_html, token);
-                ofd_array_add_string(result_html, Ofd_String_("</div>"));
-            } break;
+                character = *c;
+                if(character == '\n' || character == '\r' || character == '"') break;
+                c++;
+            }
             
+            link_title->count = c - link_title->data;
+            if(c < limit && *c =='"') c++;
+            // Parse a link title. END
             
-            case '#':
+            continue;
+        }
+        
+        if(character == 'w' || character == 'h' || character == 'r')
+        {
+            // Parse additional CSS. START
+            char original_character = character;
+            
+            while(c < limit)
             {
-                // Handle a compiler directive. START
-                ofd_syntax_spill_basic_text(result_html, &basic_text, keywords, num_keywords);
-                
-                Ofd_String token = {c};
+                character = *c;
+                if(character == '"' || character == '\n' || character == '\r') break;
+                c++;
+            }
+            
+            if(c == limit) break;
+            
+            if(*c == '"')
+            {
+                c++;
+                Ofd_String css = {c};
                 while(c < limit)
                 {
                     character = *c;
-                    if(character == ' ' || character == '\t' || character == '\n' || character == '\r' || character == '(' || character == '[' || character == '{')
-                    {
-                        break;
-                    }
-                    
-                    token.count++;
+                    if(character == '"' || character == '\n' || character == '\r') break;
                     c++;
                 }
                 
-                current_directive = token;
-                
-                ofd_array_add_string(result_html, Ofd_String_("<div class='ofd-syntax ofd-syntax-directive'>"));
-                ofd_syntax_insert_token(result_html, token);
-                ofd_array_add_string(result_html, Ofd_String_("</div>"));
-                // Handle a compiler directive. END
-            } break;
-            
-            
-            case '<':
-            {
-                ofd_syntax_spill_basic_text(result_html, &basic_text, keywords, num_keywords);
+                if(c == limit) break;
                 
-                if(ofd_string_matches(current_directive, "#include"))
+                if(*c == '"')
                 {
-                    // Handle a filepath for an #include directive. START
-                    Ofd_String token = {c};
-                    while(c < limit)
+                    css.count = c - css.data;
+                    switch(original_character)
                     {
-                        character = *c;
-                        if(character == '>')
+                        case 'w':
                         {
-                            token.count++;
-                            c++;
-                            break;
-                        }
-                        if(character == '\n' || character == '\r') break;
+                            ofd_array_add_string(additional_css, Ofd_String_("width:"));
+                        } break;
                         
-                        token.count++;
-                        c++;
+                        case 'h':
+                        {
+                            ofd_array_add_string(additional_css, Ofd_String_("height:"));
+                        } break;
+                        
+                        case 'r':
+                        {
+                            ofd_array_add_string(additional_css, Ofd_String_("border-radius:"));
+                        } break;
                     }
                     
-                    ofd_array_add_string(result_html, Ofd_String_("<div class='ofd-syntax ofd-syntax-string'>"));
-                    ofd_syntax_insert_token(result_html, token);
-                    ofd_array_add_string(result_html, Ofd_String_("</div>"));
-                    // Handle a filepath for an #include directive. END
+                    ofd_array_add_string(additional_css, css);
+                    ofd_array_add_string(additional_css, Ofd_String_(";"));
                     
-                    break;
-                }
-                
-                goto do_the_default_thing;
-            } break;
-            
-            
-            case '\n':
-            case '\r':
-            {
-                // Handle new lines. START
-                ofd_syntax_spill_basic_text(result_html, &basic_text, keywords, num_keywords);
-                
-                Ofd_String token = {c};
-                while(c < limit)
-                {
-                    if(*c != '\r' && *c != '\n') break;
                     c++;
+                    continue;
                 }
-                
-                token.count = c - token.data;
-                ofd_array_add_string(result_html, token);
-                
-                current_directive.count = 0;
-                // Handle new lines. END
-            } break;
-            
-            case ' ':
-            case '\t':
+            }
+            // Parse additional CSS. END
+        }
+        
+        c++;
+    }
+    
+    
+    c = ofd_skip_whitespace(c, limit);
+    if(c < limit)
+    { // Skip new line.
+        if(*c == '\n')
+        {
+            c++;
+            if(c < limit && *c == '\r') c++;
+        }
+        else if(*c == '\r') c++;
+    }
+    
+    return c;
+}
+
+ofd_static void ofd_find_link_references(char* c, char* limit, Ofd_Link_Reference_Table* link_references, Ofd_Arena* arena)
+{
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: this quickly goes through markdown and adds every link reference it finds to link_references, so that links can use
+    // references that are defined after them. It skips what ofd_parse_markdown() does not look into (code blocks, embedded HTML
+    // and escaped characters). When an ID is defined several times the first definition wins.
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    while(c < limit)
+    {
+        switch(*c)
+        {
+            case '`':
             {
-                // Handle whitespace. START
-                ofd_syntax_spill_basic_text(result_html, &basic_text, keywords, num_keywords);
-                
-                Ofd_String token = {c};
-                while(c < limit)
+                int backtick_count = 0;
+                while(c < limit && *c == '`')
                 {
-                    if(*c != ' ' && *c != '\t') break;
+                    backtick_count++;
                     c++;
                 }
                 
-                token.count = c - token.data;
-                ofd_array_add_string(result_html, token);
-                // Handle whitespace. END
-            } break;
-            
-            
-            case '"':
-            case '\'':
-            {
-                ofd_syntax_spill_basic_text(result_html, &basic_text, keywords, num_keywords);
-                
-                int static_keyword_count = ofd_strlen("'static");
+                if(backtick_count > OFD_MAX_CODE_BLOCK_INDICATOR_COUNT) break; // This is not a code block.
                 
-                if((flags & OFD_THIS_IS_RUST) && c + static_keyword_count <= limit)
-                { // 'static is an actual keyword in Rust so we need to account for that.
-                    if(ofd_memcmp(c, "'static", static_keyword_count) == 0)
+                while(c < limit)
+                { // Skip to the end of the code block.
+                    if(*c != '`')
                     {
-                        ofd_array_add_string(result_html, Ofd_String_("<div class='ofd-syntax ofd-syntax-keyword'>'static</div>"));
-                        c += static_keyword_count;
-                        break;
+                        c++;
+                        continue;
                     }
+                    
+                    char* backticks_start = c;
+                    while(c < limit && *c == '`') c++;
+                    
+                    if(c - backticks_start == backtick_count) break;
                 }
-                
-                c = ofd_syntax_handle_string(result_html, c, limit);
             } break;
             
-            case '`':
+            case '<':
             {
-                ofd_syntax_spill_basic_text(result_html, &basic_text, keywords, num_keywords);
-                
-                if(flags & OFD_BACKTICK_IS_A_STRING) c = ofd_syntax_handle_string(result_html, c, limit);
-                else goto do_the_default_thing;
+                if(c + 3 <= limit && ofd_memcmp(c, "</>", 3) == 0)
+                {
+                    c += 3;
+                    while(c + 3 <= limit && ofd_memcmp(c, "</>", 3) != 0) c++;
+                    c = ofd_min(c + 3, limit);
+                }
+                else c++;
             } break;
             
-            
-            case '=':
-            case '>':
-            case '+':
-            case '-':
-            case '*':
-            case '/':
-            case '%':
-            case '^':
-            case '$':
-            case '!':
-            case ',':
-            case '|':
-            case '&':
-            case '~':
-            case '@':
             case '\\':
             {
-                if(basic_text.count)
-                {
-                    for(int i = 0; i < basic_text.count; i++)
-                    {
-                        if(basic_text.data[i] == character) goto do_the_default_thing; // This is already a special character so no need to spill it.
-                    }
-                    
-                    ofd_syntax_spill_basic_text(result_html, &basic_text, keywords, num_keywords);
-                }
-                
-                goto do_the_default_thing;
+                c = ofd_min(c + 2, limit);
             } break;
             
-            
-            default:
+            case '[':
             {
-                do_the_default_thing:;
-                
-                ofd_b8 this_is_a_number = (character >= '0' && character <= '9');
-                if(character == '.' && c + 1 < limit && (c[1] >= '0' && c[1] <= '9')) this_is_a_number = ofd_true;
-                if(c != lower_limit)
+                Ofd_Link_Reference reference;
+                char* reference_end = ofd_parse_link_reference(c, limit, &reference, arena);
+                if(!reference_end)
                 {
-                    char previous_char = *(c - 1);
-                    if((previous_char >= 'a' && previous_char <= 'z') || (previous_char >= 'A' && previous_char <= 'Z')) this_is_a_number = ofd_false;
-                }
-                
-                if(this_is_a_number)
-                { // Handle a number.
-                    ofd_syntax_spill_basic_text(result_html, &basic_text, keywords, num_keywords);
-                    c = ofd_syntax_handle_number(result_html, c, limit);
-                    
+                    c++;
                     break;
                 }
                 
+                if(!ofd_find_link_reference(link_references, reference.id)) ofd_add_link_reference(link_references, reference);
                 
-                if(!basic_text.count) basic_text.data = c;
-                basic_text.count++;
+                c = reference_end;
+            } break;
+            
+            default:
+            {
                 c++;
             } break;
         }
     }
-    
-    ofd_syntax_spill_basic_text(result_html, &basic_text, keywords, num_keywords);
 }
 
-ofd_static void ofd_apply_syntax_highlighting(Ofd_Array* result_html, Ofd_String text, Ofd_String language)
+ofd_static char* ofd_maybe_handle_a_horizontal_rule(char* c, char* limit, char indicator, Ofd_Array* result_html, Ofd_String* text_to_spill)
 {
-    if(ofd_string_matches(language, "8"))
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: if this does not turn out to be a horizontal rule this routine returns NULL, otherwise it returns the next character to parse.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    int num_indicators_in_a_row = 0;
+    while(c < limit)
     {
-        const Ofd_String bytes_keywords[] = {
-            OFD_STRING("b8"),
-            OFD_STRING("break"),
-            OFD_STRING("cast"),
-            OFD_STRING("Code"),
-            OFD_STRING("continue"),
-            OFD_STRING("f32"),
-            OFD_STRING("false"),
-            OFD_STRING("for"),
-            OFD_STRING("else"),
-            OFD_STRING("enum"),
-            OFD_STRING("enum_flags"),
-            OFD_STRING("if"),
-            OFD_STRING("return"),
-            OFD_STRING("s8"),
-            OFD_STRING("s16"),
-            OFD_STRING("s32"),
-            OFD_STRING("s64"),
-            OFD_STRING("size_of"),
-            OFD_STRING("String"),
-            OFD_STRING("struct"),
-            OFD_STRING("switch"),
-            OFD_STRING("true"),
-            OFD_STRING("Type"),
-            OFD_STRING("type_of"),
-            OFD_STRING("u8"),
-            OFD_STRING("u16"),
-            OFD_STRING("u32"),
-            OFD_STRING("u64"),
-            OFD_STRING("while"),
-        };
+        if(*c != indicator) break;
         
-        ofd_apply_c_syntax_highlighting(result_html, text, Ofd_String_("//"), Ofd_String_("/*"), Ofd_String_("*/"), bytes_keywords, ofd_array_count(bytes_keywords), OFD_SUPPORTS_NESTED_MULTI_LINE_COMMENTS);
+        num_indicators_in_a_row++;
+        c++;
     }
-    else if(ofd_string_matches(language, "jai"))
+    
+    if(num_indicators_in_a_row >= 3 && (c == limit || *c == '\n' || *c == '\r'))
     {
-        const Ofd_String jai_keywords[] = {
-            OFD_STRING("Any"),
-            OFD_STRING("asm"),
-            OFD_STRING("bool"),
+        ofd_array_add_string(result_html, *text_to_spill);
+        text_to_spill->count = 0;
+        
+        ofd_array_add_string(result_html, Ofd_String_("<div class='ofd-horizontal-rule'></div>"));
+        
+        if(c < limit)
+        { // Go to the next line.
+            if(*c == '\n') c++;
+            if(c < limit && *c == '\r') c++;
+        }
+        
+        return c;
+    }
+    
+    
+    return NULL;
+}
+
+ofd_static char* ofd_get_next_character_like_in_line(char* c, char* limit, char wanted, char** result_line_end)
+{
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: if a suitable character is found this routine returns the address at which the character was found, otherwise it returns NULL. If the end of
+    // the line is reached result_line_end takes its address.
+    // We skip code blocks and escaped characters.
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    *result_line_end = NULL;
+    
+    ofd_b8 ignore_next_character  = ofd_false;
+    char* code_block_start = NULL;
+    int code_block_start_count = 0;
+    
+    while(c < limit)
+    {
+        char character = *c;
+        if(character == '\n' || character == '\r')
+        {
+            *result_line_end = c;
+            break; // We reached the end of the line.
+        }
+        
+        if(!ignore_next_character)
+        {
+            if(character == '\\') ignore_next_character = (code_block_start == NULL);
+            else if(character == '`')
+            {
+                if(code_block_start)
+                { // Check if we reached the end of a code block.
+                    if(c + code_block_start_count <= limit)
+                    {
+                        char* tmp_c = c;
+                        while(tmp_c < limit)
+                        {
+                            if(*tmp_c != '`') break;
+                            tmp_c++;
+                        }
+                        
+                        int num_backticks = tmp_c - c;
+                        if(num_backticks == code_block_start_count)
+                        {
+                            c += code_block_start_count;
+                            
+                            code_block_start       = NULL;
+                            code_block_start_count = 0;
+                            continue; // We reached the end of a code block.
+                        }
+                        
+                        c += num_backticks;
+                        continue;
+                    }
+                }
+                else
+                {
+                    // Handle a code block start. START
+                    code_block_start       = c;
+                    code_block_start_count = 0;
+                    while(c < limit && code_block_start_count < OFD_MAX_CODE_BLOCK_INDICATOR_COUNT)
+                    {
+                        if(*c != '`') break;
+                        
+                        code_block_start_count++;
+                        c++;
+                    }
+                    // Handle a code block start. END
+                    
+                    continue;
+                }
+            }
+            else if(character == wanted && !code_block_start) return c;
+        }
+        else ignore_next_character = ofd_false;
+        
+        c++;
+    }
+    
+    return NULL;
+}
+
+
+static const ofd_u8 OFD_MARKDOWN_SPECIAL_CHARACTERS[256] = { // Characters that have their own case in ofd_parse_markdown().
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x00
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x10
+    0, 1, 0, 1, 0, 0, 0, 0, 0, 0, 1, 1, 0, 1, 1, 0, // 0x20
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, // 0x30
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x40
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 1, // 0x50
+    1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x60
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, // 0x70
+    // Bytes above 0x7f are all 0.
+};
+
+ofd_static char* ofd_find_markdown_special_character(char* c, char* limit)
+{
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: this returns the address of the first character that could start a markdown element, or limit if there is none.
+    // Everything before it is plain text. Keep this in sync with the cases in ofd_parse_markdown().
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    #ifdef OFD_USE_AVX2
+    while(c + 32 <= limit)
+    {
+        __m256i bytes   = _mm256_loadu_si256(ofd_cast(c, __m256i*));
+        __m256i matches = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('#'));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('`')));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('~')));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('<')));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('>')));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('*')));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('_')));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('-')));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('+')));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('.')));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('[')));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('!')));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('|')));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\\')));
+        
+        unsigned int mask = _mm256_movemask_epi8(matches);
+        if(mask) return c + ofd_get_first_set_bit(mask);
+        
+        c += 32;
+    }
+    #endif
+    
+    #ifdef OFD_USE_SSE2
+    while(c + 16 <= limit)
+    {
+        __m128i bytes   = _mm_loadu_si128(ofd_cast(c, __m128i*));
+        __m128i matches = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('#'));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('`')));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('~')));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('<')));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('>')));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('*')));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('_')));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('-')));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('+')));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('.')));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('[')));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('!')));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('|')));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\\')));
+        
+        int mask = _mm_movemask_epi8(matches);
+        if(mask) return c + ofd_get_first_set_bit(mask);
+        
+        c += 16;
+    }
+    #endif
+    
+    while(c < limit)
+    {
+        if(OFD_MARKDOWN_SPECIAL_CHARACTERS[ofd_cast(*c, ofd_u8)]) return c;
+        c++;
+    }
+    
+    return c;
+}
+
+#ifndef OFD_COMPACT_SYNTAX_MARKUP
+static const Ofd_String OFD_SYNTAX_OPENING_TAGS[OFD_SYNTAX_CLASS_COUNT] = {
+    OFD_STRING("<div class='ofd-syntax ofd-syntax-comment'>"),
+    OFD_STRING("<div class='ofd-syntax ofd-syntax-string'>"),
+    OFD_STRING("<div class='ofd-syntax ofd-syntax-number'>"),
+    OFD_STRING("<div class='ofd-syntax ofd-syntax-structure'>"),
+    OFD_STRING("<div class='ofd-syntax ofd-syntax-keyword'>"),
+    OFD_STRING("<div class='ofd-syntax ofd-syntax-directive'>"),
+};
+
+static const char* OFD_SYNTAX_CSS_SELECTORS[OFD_SYNTAX_CLASS_COUNT] = {".ofd-syntax-comment", ".ofd-syntax-string", ".ofd-syntax-number", ".ofd-syntax-structure", ".ofd-syntax-keyword", ".ofd-syntax-directive"};
+
+#define OFD_SYNTAX_CLOSING_TAG "</div>"
+#else
+static const Ofd_String OFD_SYNTAX_OPENING_TAGS[OFD_SYNTAX_CLASS_COUNT] = {
+    OFD_STRING("<span class=ofd-c>"),
+    OFD_STRING("<span class=ofd-s>"),
+    OFD_STRING("<span class=ofd-n>"),
+    OFD_STRING("<span class=ofd-p>"),
+    OFD_STRING("<span class=ofd-k>"),
+    OFD_STRING("<span class=ofd-d>"),
+};
+
+static const char* OFD_SYNTAX_CSS_SELECTORS[OFD_SYNTAX_CLASS_COUNT] = {".ofd-c", ".ofd-s", ".ofd-n", ".ofd-p", ".ofd-k", ".ofd-d"};
+
+#define OFD_SYNTAX_CLOSING_TAG "</span>"
+#endif
+
+ofd_static void ofd_syntax_begin_token(Ofd_Array* result_html, Ofd_Syntax_Class syntax_class)
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: with compact markup, if the last thing written is a token of the same class (possibly followed by whitespace) then we
+    // reopen it instead of starting a new one. Token contents are filtered so the last '<' before its closing tag is its opening tag.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    Ofd_String opening_tag = OFD_SYNTAX_OPENING_TAGS[syntax_class];
+    
+    #ifdef OFD_COMPACT_SYNTAX_MARKUP
+    Ofd_String closing_tag = OFD_STRING(OFD_SYNTAX_CLOSING_TAG);
+    
+    char* lower_limit = result_html->data;
+    char* limit       = result_html->data + result_html->count;
+    
+    char* whitespace = limit;
+    while(whitespace > lower_limit && (whitespace[-1] == ' ' || whitespace[-1] == '\t' || whitespace[-1] == '\n' || whitespace[-1] == '\r')) whitespace--;
+    
+    char* token_end = whitespace - ofd_min(closing_tag.count, whitespace - lower_limit); // result_html can still be empty, with no data.
+    if(whitespace - token_end == closing_tag.count && ofd_memcmp(token_end, closing_tag.data, closing_tag.count) == 0)
+    {
+        char* scan_limit = (token_end - lower_limit > OFD_SYNTAX_MAX_MERGED_TOKEN_SIZE)? token_end - OFD_SYNTAX_MAX_MERGED_TOKEN_SIZE : lower_limit;
+        
+        char* token_start = token_end;
+        while(token_start > scan_limit && token_start[-1] != '<') token_start--;
+        
+        char* tag = token_start - 1;
+        if(tag >= lower_limit && *tag == '<' && tag + opening_tag.count <= token_end && ofd_memcmp(tag, opening_tag.data, opening_tag.count) == 0)
+        { // Remove the closing tag, the whitespace that followed it becomes part of the token.
+            for(char* c = whitespace; c < limit; c++) c[-closing_tag.count] = *c;
+            result_html->count -= closing_tag.count;
+            return;
+        }
+    }
+    #endif
+    
+    ofd_array_add_string(result_html, opening_tag);
+}
+
+ofd_static void ofd_syntax_end_token(Ofd_Array* result_html)
+{
+    ofd_array_add_string(result_html, Ofd_String_(OFD_SYNTAX_CLOSING_TAG));
+}
+
+ofd_static void ofd_syntax_add_token(Ofd_Array* result_html, Ofd_Syntax_Class syntax_class, Ofd_String token)
+{
+    #ifdef OFD_COMPACT_SYNTAX_MARKUP
+    // Whitespace looks the same whatever its class so we do not wrap it. START
+    int num_whitespace_characters = 0;
+    while(num_whitespace_characters < token.count)
+    {
+        char character = token.data[num_whitespace_characters];
+        if(character != ' ' && character != '\t' && character != '\n' && character != '\r') break;
+        
+        num_whitespace_characters++;
+    }
+    
+    if(num_whitespace_characters == token.count)
+    {
+        ofd_array_add_string(result_html, token);
+        return;
+    }
+    // Whitespace looks the same whatever its class so we do not wrap it. END
+    #endif
+    
+    ofd_syntax_begin_token(result_html, syntax_class);
+    ofd_syntax_insert_token(result_html, token);
+    ofd_syntax_end_token(result_html);
+}
+
+ofd_static void ofd_syntax_insert_token(Ofd_Array* result_html, Ofd_String token)
+{
+    ofd_array_add_filtered_text(result_html, token);
+}
+
+ofd_static void ofd_keyword_set_init(Ofd_Keyword_Set* set, const Ofd_String* keywords, int num_keywords)
+{
+    set->keywords     = keywords;
+    set->num_keywords = num_keywords;
+    set->length_mask  = 0;
+    set->is_hashed    = (num_keywords <= OFD_KEYWORD_SET_SIZE / 2);
+    
+    for(int i = 0; i < OFD_KEYWORD_SET_SIZE; i++) set->slots[i] = 0;
+    
+    for(int i = 0; i < num_keywords; i++)
+    {
+        set->length_mask |= 1u << ofd_min(keywords[i].count, 31);
+        
+        if(set->is_hashed)
+        {
+            int slot_index = ofd_hash_string(keywords[i]) & (OFD_KEYWORD_SET_SIZE - 1);
+            while(set->slots[slot_index]) slot_index = (slot_index + 1) & (OFD_KEYWORD_SET_SIZE - 1);
+            set->slots[slot_index] = i + 1;
+        }
+    }
+}
+
+ofd_static ofd_b8 ofd_keyword_set_contains(Ofd_Keyword_Set* set, Ofd_String word)
+{
+    if(!(set->length_mask & (1u << ofd_min(word.count, 31)))) return ofd_false;
+    
+    if(!set->is_hashed)
+    {
+        for(int i = 0; i < set->num_keywords; i++)
+        {
+            if(ofd_strings_match(set->keywords[i], word)) return ofd_true;
+        }
+        
+        return ofd_false;
+    }
+    
+    int slot_index = ofd_hash_string(word) & (OFD_KEYWORD_SET_SIZE - 1);
+    while(set->slots[slot_index])
+    {
+        if(ofd_strings_match(set->keywords[set->slots[slot_index] - 1], word)) return ofd_true;
+        slot_index = (slot_index + 1) & (OFD_KEYWORD_SET_SIZE - 1);
+    }
+    
+    return ofd_false;
+}
+
+ofd_static void ofd_syntax_spill_basic_text(Ofd_Array* result_html, Ofd_String* basic_text, Ofd_Keyword_Set* keywords)
+{
+    if(ofd_keyword_set_contains(keywords, *basic_text))
+    {
+        ofd_syntax_add_token(result_html, OFD_SYNTAX_CLASS_KEYWORD, *basic_text);
+    }
+    else ofd_syntax_insert_token(result_html, *basic_text);
+    
+    basic_text->count = 0;
+}
+
+ofd_static void ofd_syntax_spill_basic_text_no_keywords(Ofd_Array* result_html, Ofd_String* basic_text)
+{
+    ofd_syntax_insert_token(result_html, *basic_text);
+    basic_text->count = 0;
+}
+
+ofd_static char* ofd_syntax_find_first_of(char* c, char* limit, char a, char b, char d)
+{
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: this returns the address of the first a, b or d, or limit if there is none. Pass the same character twice to
+    // look for fewer of them. Long comments and strings are skipped with this so they go by 16 or 32 bytes at a time.
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    #ifdef OFD_USE_AVX2
+    while(c + 32 <= limit)
+    {
+        __m256i bytes   = _mm256_loadu_si256(ofd_cast(c, __m256i*));
+        __m256i matches = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(a));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(b)));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(d)));
+        
+        unsigned int mask = _mm256_movemask_epi8(matches);
+        if(mask) return c + ofd_get_first_set_bit(mask);
+        
+        c += 32;
+    }
+    #endif
+    
+    #ifdef OFD_USE_SSE2
+    while(c + 16 <= limit)
+    {
+        __m128i bytes   = _mm_loadu_si128(ofd_cast(c, __m128i*));
+        __m128i matches = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(a));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(b)));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(d)));
+        
+        unsigned int mask = _mm_movemask_epi8(matches);
+        if(mask) return c + ofd_get_first_set_bit(mask);
+        
+        c += 16;
+    }
+    #endif
+    
+    while(c < limit)
+    {
+        char character = *c;
+        if(character == a || character == b || character == d) return c;
+        
+        c++;
+    }
+    
+    return limit;
+}
+
+ofd_static char* ofd_syntax_skip_string(char* c, char* limit, char delimiter, ofd_b8 is_last_chunk, ofd_b8* result_reached_the_end)
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: we expect c to be inside a string, e.g. right after its first '"'. This returns the address right after the
+    // closing delimiter and sets *result_reached_the_end, or it returns where the text stops. If the text stops on a '\\'
+    // and more of it is coming we stop on that '\\' instead since we need the next character to skip it.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    *result_reached_the_end = ofd_false;
+    
+    while(c < limit)
+    {
+        c = ofd_syntax_find_first_of(c, limit, delimiter, '\\', '\\');
+        if(c == limit) break;
+        
+        if(*c == delimiter)
+        {
+            *result_reached_the_end = ofd_true;
+            return c + 1;
+        }
+        
+        if(c + 1 == limit && !is_last_chunk) return c;
+        
+        c += 2; // Skip the escaped character.
+    }
+    
+    return limit;
+}
+
+ofd_static char* ofd_syntax_handle_string(Ofd_Array* result_html, char* c, char* limit)
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: we expect c to start on the first delimiter character of the string, e.g. on the first '"'.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    Ofd_String token = {c};
+    
+    ofd_b8 reached_the_end;
+    c = ofd_syntax_skip_string(c + 1, limit, *c, ofd_true, &reached_the_end);
+    
+    token.count = c - token.data;
+    
+    ofd_syntax_add_token(result_html, OFD_SYNTAX_CLASS_STRING, token);
+    
+    return c;
+}
+
+ofd_static Ofd_Syntax_Match ofd_syntax_match(char* c, char* limit, Ofd_String wanted, ofd_b8 is_last_chunk)
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: this tells whether the text at c starts with wanted. If the text stops before we can tell and more of it is
+    // coming the answer is OFD_SYNTAX_NEEDS_MORE_TEXT.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    if(c + wanted.count <= limit) return (ofd_memcmp(c, wanted.data, wanted.count) == 0)? OFD_SYNTAX_MATCH : OFD_SYNTAX_NO_MATCH;
+    
+    if(!is_last_chunk && ofd_memcmp(c, wanted.data, limit - c) == 0) return OFD_SYNTAX_NEEDS_MORE_TEXT;
+    
+    return OFD_SYNTAX_NO_MATCH;
+}
+
+ofd_static void ofd_syntax_finish_token(Ofd_Highlighter_State* state, Ofd_Array* result_html, char* token_start, char* token_end)
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: this ends the comment or string the highlighter is in, its opening tag is already written.
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    
+    Ofd_String token = {token_start, ofd_cast(token_end - token_start, int)};
+    ofd_syntax_insert_token(result_html, token);
+    ofd_syntax_end_token(result_html);
+    
+    state->mode = OFD_HIGHLIGHTING_CODE;
+}
+
+ofd_static char* ofd_syntax_write_unfinished_token(Ofd_Array* result_html, char* token_start, char* c)
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: when a chunk stops in the middle of a comment or a string we write what we have of it up to its last whitespace:
+    // ofd_array_add_filtered_text() turns addresses into links and those must not be cut in two. This returns where we stopped.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    char* token_end = c;
+    while(token_end > token_start)
+    {
+        char character = token_end[-1];
+        if(character == ' ' || character == '\t' || character == '\n' || character == '\r') break;
+        
+        token_end--;
+    }
+    
+    Ofd_String token = {token_start, ofd_cast(token_end - token_start, int)};
+    ofd_syntax_insert_token(result_html, token);
+    
+    return token_end;
+}
+
+
+static const ofd_u8 OFD_SYNTAX_NUMBER_CHARACTERS[256] = { // '.', '_', digits and letters, which covers 0x1f, 1e-3f, 1_000 and so on.
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x00
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x10
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, // 0x20
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, // 0x30
+    0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x40
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 1, // 0x50
+    0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x60
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, // 0x70
+    // Bytes above 0x7f are all 0.
+};
+
+ofd_static char* ofd_syntax_handle_number(Ofd_Array* result_html, char* c, char* limit)
+{
+    Ofd_String token = {c};
+    while(c < limit && OFD_SYNTAX_NUMBER_CHARACTERS[ofd_cast(*c, ofd_u8)]) c++;
+    
+    token.count = c - token.data;
+    
+    ofd_syntax_add_token(result_html, OFD_SYNTAX_CLASS_NUMBER, token);
+    
+    return c;
+}
+
+
+ofd_static void ofd_init_syntax_character_classes(Ofd_Language* language)
+{
+    ofd_u8* classes = language->character_classes;
+    
+    for(int i = 0; i < 256; i++) classes[i] = OFD_SYNTAX_CHARACTER_OTHER;
+    
+    for(int i = 'a'; i <= 'z'; i++) classes[i] = OFD_SYNTAX_CHARACTER_LETTER;
+    for(int i = 'A'; i <= 'Z'; i++) classes[i] = OFD_SYNTAX_CHARACTER_LETTER;
+    for(int i = '0'; i <= '9'; i++) classes[i] = OFD_SYNTAX_CHARACTER_DIGIT;
+    
+    const char* structure_characters = "{}()[]?:;";
+    const char* operator_characters  = "=>+-*/%^$!,|&~@\\";
+    for(const char* c = structure_characters; *c; c++) classes[ofd_cast(*c, ofd_u8)] = OFD_SYNTAX_CHARACTER_STRUCTURE;
+    for(const char* c = operator_characters;  *c; c++) classes[ofd_cast(*c, ofd_u8)] = OFD_SYNTAX_CHARACTER_OPERATOR;
+    
+    classes['.']  = OFD_SYNTAX_CHARACTER_DOT;
+    classes['#']  = (language->flags & OFD_NO_DIRECTIVES)? OFD_SYNTAX_CHARACTER_OPERATOR : OFD_SYNTAX_CHARACTER_DIRECTIVE;
+    classes['<']  = OFD_SYNTAX_CHARACTER_LESS_THAN;
+    classes['\n'] = OFD_SYNTAX_CHARACTER_NEW_LINE;
+    classes['\r'] = OFD_SYNTAX_CHARACTER_NEW_LINE;
+    classes[' ']  = OFD_SYNTAX_CHARACTER_WHITESPACE;
+    classes['\t'] = OFD_SYNTAX_CHARACTER_WHITESPACE;
+    classes['`']  = OFD_SYNTAX_CHARACTER_BACKTICK;
+    
+    Ofd_String string_delimiters = language->string_delimiters.data ? language->string_delimiters : Ofd_String_("\"'");
+    for(int i = 0; i < string_delimiters.count; i++)
+    {
+        ofd_u8 delimiter = ofd_cast(string_delimiters.data[i], ofd_u8);
+        if(classes[delimiter] != OFD_SYNTAX_CHARACTER_NEW_LINE && classes[delimiter] != OFD_SYNTAX_CHARACTER_WHITESPACE) classes[delimiter] = OFD_SYNTAX_CHARACTER_QUOTE;
+    }
+    
+    for(int i = '0'; i <= '9'; i++) classes[i] |= OFD_SYNTAX_CHARACTER_CONTINUES_A_NUMBER;
+    if(language->number_characters.data)
+    {
+        for(int i = 0; i < language->number_characters.count; i++) classes[ofd_cast(language->number_characters.data[i], ofd_u8)] |= OFD_SYNTAX_CHARACTER_CONTINUES_A_NUMBER;
+    }
+    else
+    {
+        for(int i = 0; i < 256; i++)
+        {
+            if(OFD_SYNTAX_NUMBER_CHARACTERS[i]) classes[i] |= OFD_SYNTAX_CHARACTER_CONTINUES_A_NUMBER;
+        }
+    }
+    
+    if(language->single_line_comment_start.count) classes[ofd_cast(language->single_line_comment_start.data[0], ofd_u8)] |= OFD_SYNTAX_CHARACTER_STARTS_A_COMMENT;
+    if(language->multi_line_comment_start.count)  classes[ofd_cast(language->multi_line_comment_start.data[0],  ofd_u8)] |= OFD_SYNTAX_CHARACTER_STARTS_A_COMMENT;
+}
+
+
+ofd_static char* ofd_highlight_c_like_chunk(Ofd_Highlighter_State* state, Ofd_Array* result_html, Ofd_String text, ofd_b8 is_last_chunk)
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: the highlight callback of languages that are similar to C, see Ofd_Highlight_Callback. The language must have been prepared,
+    // which ofd_register_language() does, because the dispatch below goes through its character classes. Only the first character of
+    // a comment indicator is in there so we only compare whole indicators on those.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    Ofd_Language* language = state->language;
+    
+    Ofd_String single_line_comment_start = language->single_line_comment_start;
+    Ofd_String multi_line_comment_start  = language->multi_line_comment_start;
+    Ofd_String multi_line_comment_end    = language->multi_line_comment_end;
+    Ofd_Keyword_Set* keywords            = &language->keyword_set;
+    Ofd_Syntax_Flags flags               = language->flags;
+    const ofd_u8* classes                = language->character_classes;
+    
+    ofd_b8 supports_nested_multiline_comments = (flags & OFD_SUPPORTS_NESTED_MULTI_LINE_COMMENTS) != 0;
+    
+    // The characters that can stop a multi-line comment, '"' stands in for the ones that do not exist.
+    char multi_line_comment_end_character    = multi_line_comment_end.count ? multi_line_comment_end.data[0] : '"';
+    char nested_multi_line_comment_character = (supports_nested_multiline_comments && multi_line_comment_start.count) ? multi_line_comment_start.data[0] : '"';
+    
+    Ofd_String static_keyword = OFD_STRING("'static");
+    
+    char* c           = text.data + state->num_scanned_characters;
+    char* limit       = text.data + text.count;
+    char* lower_limit = text.data;
+    char* token_start = text.data; // The part of the comment or string we are in that is not written yet.
+    
+    Ofd_String basic_text = {c};
+    
+    // An operator that is already in basic_text does not spill it. Rather than scanning basic_text for it we remember in which
+    // basic text each operator was last added: basic_text_id changes every time basic_text starts over.
+    int basic_text_id = 0;
+    int operator_basic_text_ids[256] = {0};
+    
+    
+    while(c < limit)
+    {
+        // Go on with a comment or a string. START
+        if(state->mode == OFD_HIGHLIGHTING_SINGLE_LINE_COMMENT)
+        {
+            c = ofd_syntax_find_first_of(c, limit, '\n', '\r', '\r');
+            if(c < limit) ofd_syntax_finish_token(state, result_html, token_start, c);
+            
+            continue;
+        }
+        
+        if(state->mode == OFD_HIGHLIGHTING_MULTI_LINE_COMMENT)
+        {
+            Ofd_Syntax_Match end_match = ofd_syntax_match(c, limit, multi_line_comment_end, is_last_chunk);
+            if(end_match == OFD_SYNTAX_NEEDS_MORE_TEXT) goto wait_for_more_text;
+            if(end_match == OFD_SYNTAX_MATCH)
+            { // Check for the end of the comment.
+                c += multi_line_comment_end.count;
+                state->imbrication_level--;
+                if(!state->imbrication_level) ofd_syntax_finish_token(state, result_html, token_start, c); // This is the end of the multi-line comment.
+                
+                continue;
+            }
+            
+            if(supports_nested_multiline_comments)
+            {
+                Ofd_Syntax_Match start_match = ofd_syntax_match(c, limit, multi_line_comment_start, is_last_chunk);
+                if(start_match == OFD_SYNTAX_NEEDS_MORE_TEXT) goto wait_for_more_text;
+                if(start_match == OFD_SYNTAX_MATCH)
+                { // Check for a nested multi-line comment.
+                    c += multi_line_comment_start.count;
+                    state->imbrication_level++;
+                    continue;
+                }
+            }
+            
+            if(*c == '"')
+            { // Skip strings, the end of the comment does not count in there.
+                state->mode = OFD_HIGHLIGHTING_STRING_IN_A_COMMENT;
+                c++;
+            }
+            else c = ofd_syntax_find_first_of(c + 1, limit, multi_line_comment_end_character, nested_multi_line_comment_character, '"');
+            
+            continue;
+        }
+        
+        if(state->mode == OFD_HIGHLIGHTING_STRING || state->mode == OFD_HIGHLIGHTING_STRING_IN_A_COMMENT)
+        {
+            char delimiter = (state->mode == OFD_HIGHLIGHTING_STRING)? state->string_delimiter : '"';
+            
+            ofd_b8 reached_the_end;
+            c = ofd_syntax_skip_string(c, limit, delimiter, is_last_chunk, &reached_the_end);
+            
+            if(reached_the_end)
+            {
+                if(state->mode == OFD_HIGHLIGHTING_STRING) ofd_syntax_finish_token(state, result_html, token_start, c);
+                else                                       state->mode = OFD_HIGHLIGHTING_MULTI_LINE_COMMENT;
+            }
+            else if(c < limit) goto wait_for_more_text; // We stopped on a '\\'.
+            
+            continue;
+        }
+        // Go on with a comment or a string. END
+        
+        
+        char character      = *c;
+        int character_class = classes[ofd_cast(character, ofd_u8)];
+        
+        if(character_class & OFD_SYNTAX_CHARACTER_STARTS_A_COMMENT)
+        {
+            // Multi-line comments go first, they can start like single-line ones (--[[ and -- in Lua).
+            Ofd_Syntax_Match multi_line_match = multi_line_comment_start.count ? ofd_syntax_match(c, limit, multi_line_comment_start, is_last_chunk) : OFD_SYNTAX_NO_MATCH;
+            if(multi_line_match == OFD_SYNTAX_NEEDS_MORE_TEXT) goto wait_for_more_text;
+            if(multi_line_match == OFD_SYNTAX_MATCH)
+            {
+                ofd_syntax_spill_basic_text(result_html, &basic_text, keywords);
+                ofd_syntax_begin_token(result_html, OFD_SYNTAX_CLASS_COMMENT);
+                
+                token_start = c;
+                c += multi_line_comment_start.count;
+                state->mode              = OFD_HIGHLIGHTING_MULTI_LINE_COMMENT;
+                state->imbrication_level = 1;
+                
+                continue;
+            }
+            
+            Ofd_Syntax_Match single_line_match = single_line_comment_start.count ? ofd_syntax_match(c, limit, single_line_comment_start, is_last_chunk) : OFD_SYNTAX_NO_MATCH;
+            if(single_line_match == OFD_SYNTAX_NEEDS_MORE_TEXT) goto wait_for_more_text;
+            if(single_line_match == OFD_SYNTAX_MATCH)
+            {
+                ofd_syntax_spill_basic_text(result_html, &basic_text, keywords);
+                ofd_syntax_begin_token(result_html, OFD_SYNTAX_CLASS_COMMENT);
+                
+                token_start = c;
+                c += single_line_comment_start.count;
+                state->mode = OFD_HIGHLIGHTING_SINGLE_LINE_COMMENT;
+                
+                continue;
+            }
+        }
+        
+        
+        switch(character_class & ~(OFD_SYNTAX_CHARACTER_STARTS_A_COMMENT | OFD_SYNTAX_CHARACTER_CONTINUES_A_NUMBER))
+        {
+            case OFD_SYNTAX_CHARACTER_STRUCTURE:
+            {
+                ofd_syntax_spill_basic_text(result_html, &basic_text, keywords);
+                
+                Ofd_String token = {c};
+                while(c < limit)
+                {
+                    if(*c != character) break;
+                    c++;
+                }
+                
+                if(c == limit && !is_last_chunk)
+                {
+                    c = token.data;
+                    goto wait_for_more_text;
+                }
+                
+                token.count = c - token.data;
+                
+                ofd_syntax_add_token(result_html, OFD_SYNTAX_CLASS_STRUCTURE, token);
+            } break;
+            
+            
+            case OFD_SYNTAX_CHARACTER_DIRECTIVE:
+            {
+                // Handle a compiler directive. START
+                ofd_syntax_spill_basic_text(result_html, &basic_text, keywords);
+                
+                Ofd_String token = {c};
+                while(c < limit)
+                {
+                    character = *c;
+                    if(character == ' ' || character == '\t' || character == '\n' || character == '\r' || character == '(' || character == '[' || character == '{')
+                    {
+                        break;
+                    }
+                    
+                    token.count++;
+                    c++;
+                }
+                
+                if(c == limit && !is_last_chunk)
+                {
+                    c = token.data;
+                    goto wait_for_more_text;
+                }
+                
+                state->directive_is_include = ofd_string_matches(token, "#include");
+                
+                ofd_syntax_add_token(result_html, OFD_SYNTAX_CLASS_DIRECTIVE, token);
+                // Handle a compiler directive. END
+            } break;
+            
+            
+            case OFD_SYNTAX_CHARACTER_LESS_THAN:
+            {
+                ofd_syntax_spill_basic_text(result_html, &basic_text, keywords);
+                
+                if(state->directive_is_include)
+                {
+                    // Handle a filepath for an #include directive. START
+                    Ofd_String token = {c};
+                    ofd_b8 reached_the_end = ofd_false;
+                    while(c < limit)
+                    {
+                        character = *c;
+                        if(character == '>')
+                        {
+                            token.count++;
+                            c++;
+                            reached_the_end = ofd_true;
+                            break;
+                        }
+                        if(character == '\n' || character == '\r')
+                        {
+                            reached_the_end = ofd_true;
+                            break;
+                        }
+                        
+                        token.count++;
+                        c++;
+                    }
+                    
+                    if(!reached_the_end && !is_last_chunk)
+                    {
+                        c = token.data;
+                        goto wait_for_more_text;
+                    }
+                    
+                    ofd_syntax_add_token(result_html, OFD_SYNTAX_CLASS_STRING, token);
+                    // Handle a filepath for an #include directive. END
+                    
+                    break;
+                }
+                
+                goto do_the_default_thing;
+            } break;
+            
+            
+            case OFD_SYNTAX_CHARACTER_NEW_LINE:
+            {
+                // Handle new lines. START
+                ofd_syntax_spill_basic_text(result_html, &basic_text, keywords);
+                
+                Ofd_String token = {c};
+                while(c < limit)
+                {
+                    if(*c != '\r' && *c != '\n') break;
+                    c++;
+                }
+                
+                token.count = c - token.data;
+                ofd_array_add_string(result_html, token);
+                
+                state->directive_is_include = ofd_false;
+                // Handle new lines. END
+            } break;
+            
+            case OFD_SYNTAX_CHARACTER_WHITESPACE:
+            {
+                // Handle whitespace. START
+                ofd_syntax_spill_basic_text(result_html, &basic_text, keywords);
+                
+                Ofd_String token = {c};
+                while(c < limit)
+                {
+                    if(*c != ' ' && *c != '\t') break;
+                    c++;
+                }
+                
+                token.count = c - token.data;
+                ofd_array_add_string(result_html, token);
+                // Handle whitespace. END
+            } break;
+            
+            
+            case OFD_SYNTAX_CHARACTER_QUOTE:
+            {
+                ofd_syntax_spill_basic_text(result_html, &basic_text, keywords);
+                
+                if(flags & OFD_THIS_IS_RUST)
+                { // 'static is an actual keyword in Rust so we need to account for that.
+                    Ofd_Syntax_Match static_match = ofd_syntax_match(c, limit, static_keyword, is_last_chunk);
+                    if(static_match == OFD_SYNTAX_NEEDS_MORE_TEXT) goto wait_for_more_text;
+                    if(static_match == OFD_SYNTAX_MATCH)
+                    {
+                        ofd_syntax_begin_token(result_html, OFD_SYNTAX_CLASS_KEYWORD);
+                        ofd_array_add_string(result_html, static_keyword);
+                        ofd_syntax_end_token(result_html);
+                        c += static_keyword.count;
+                        break;
+                    }
+                }
+                
+                ofd_syntax_begin_token(result_html, OFD_SYNTAX_CLASS_STRING);
+                
+                token_start = c;
+                c++;
+                state->mode             = OFD_HIGHLIGHTING_STRING;
+                state->string_delimiter = character;
+            } break;
+            
+            case OFD_SYNTAX_CHARACTER_BACKTICK:
+            {
+                ofd_syntax_spill_basic_text(result_html, &basic_text, keywords);
+                
+                if(!(flags & OFD_BACKTICK_IS_A_STRING)) goto do_the_default_thing;
+                
+                ofd_syntax_begin_token(result_html, OFD_SYNTAX_CLASS_STRING);
+                
+                token_start = c;
+                c++;
+                state->mode             = OFD_HIGHLIGHTING_STRING;
+                state->string_delimiter = character;
+            } break;
+            
+            
+            case OFD_SYNTAX_CHARACTER_OPERATOR:
+            {
+                if(basic_text.count)
+                {
+                    // If this is already in basic_text it is already a special character so no need to spill it.
+                    if(operator_basic_text_ids[ofd_cast(character, ofd_u8)] != basic_text_id) ofd_syntax_spill_basic_text(result_html, &basic_text, keywords);
+                }
+                
+                if(!basic_text.count)
+                {
+                    basic_text.data = c;
+                    basic_text_id++;
+                }
+                basic_text.count++;
+                c++;
+                
+                operator_basic_text_ids[ofd_cast(character, ofd_u8)] = basic_text_id;
+            } break;
+            
+            
+            default:
+            {
+                do_the_default_thing:;
+                
+                ofd_b8 this_is_a_number = (character >= '0' && character <= '9');
+                if(character == '.')
+                {
+                    if(c + 1 == limit && !is_last_chunk) goto wait_for_more_text;
+                    if(c + 1 < limit && (c[1] >= '0' && c[1] <= '9')) this_is_a_number = ofd_true;
+                }
+                
+                char previous_char = (c != lower_limit)? c[-1] : state->previous_character;
+                if((previous_char >= 'a' && previous_char <= 'z') || (previous_char >= 'A' && previous_char <= 'Z')) this_is_a_number = ofd_false;
+                
+                if(this_is_a_number)
+                { // Handle a number.
+                    char* number_end = c;
+                    while(number_end < limit && (classes[ofd_cast(*number_end, ofd_u8)] & OFD_SYNTAX_CHARACTER_CONTINUES_A_NUMBER)) number_end++;
+                    
+                    if(number_end == limit && !is_last_chunk) goto wait_for_more_text;
+                    
+                    ofd_syntax_spill_basic_text(result_html, &basic_text, keywords);
+                    
+                    Ofd_String token = {c, ofd_cast(number_end - c, int)};
+                    ofd_syntax_add_token(result_html, OFD_SYNTAX_CLASS_NUMBER, token);
+                    c = number_end;
+                    
+                    break;
+                }
+                
+                
+                if(!basic_text.count)
+                {
+                    basic_text.data = c;
+                    basic_text_id++;
+                }
+                basic_text.count++;
+                c++;
+                
+                // Take the rest of the word in one go. START
+                while(c < limit)
+                {
+                    int next_class = classes[ofd_cast(*c, ofd_u8)] & ~OFD_SYNTAX_CHARACTER_CONTINUES_A_NUMBER;
+                    if(next_class != OFD_SYNTAX_CHARACTER_LETTER && next_class != OFD_SYNTAX_CHARACTER_OTHER)
+                    { // A digit right after a letter is part of a name, anything else goes through the switch.
+                        int previous_class = classes[ofd_cast(c[-1], ofd_u8)] & ~OFD_SYNTAX_CHARACTER_CONTINUES_A_NUMBER;
+                        if(next_class != OFD_SYNTAX_CHARACTER_DIGIT || previous_class != OFD_SYNTAX_CHARACTER_LETTER) break;
+                    }
+                    
+                    basic_text.count++;
+                    c++;
+                }
+                // Take the rest of the word in one go. END
+            } break;
+        }
+    }
+    
+    wait_for_more_text:;
+    
+    if(!is_last_chunk)
+    {
+        state->num_scanned_characters = 0;
+        if(state->mode == OFD_HIGHLIGHTING_CODE) return basic_text.count ? basic_text.data : c;
+        
+        char* result = ofd_syntax_write_unfinished_token(result_html, token_start, c);
+        state->num_scanned_characters = c - result;
+        
+        return result;
+    }
+    
+    if(state->mode != OFD_HIGHLIGHTING_CODE) ofd_syntax_finish_token(state, result_html, token_start, limit);
+    ofd_syntax_spill_basic_text(result_html, &basic_text, keywords);
+    
+    return limit;
+}
+
+ofd_static void ofd_apply_c_syntax_highlighting(Ofd_Array* result_html, Ofd_String text, Ofd_String single_line_comment_start, Ofd_String multi_line_comment_start, Ofd_String multi_line_comment_end, const Ofd_String* keywords, int num_keywords, Ofd_Syntax_Flags flags)
+{
+    Ofd_Language language = {0}; // Preparing this takes a few hundred hashes at most, we then get one hash per word instead of comparing it to every keyword.
+    language.single_line_comment_start = single_line_comment_start;
+    language.multi_line_comment_start  = multi_line_comment_start;
+    language.multi_line_comment_end    = multi_line_comment_end;
+    language.keywords                  = keywords;
+    language.num_keywords              = num_keywords;
+    language.flags                     = flags;
+    
+    ofd_prepare_language(&language);
+    
+    ofd_highlight_text(result_html, text, &language);
+}
+
+
+typedef struct
+{
+    Ofd_Language languages[OFD_MAX_LANGUAGES];
+    int          num_languages;
+    
+    Ofd_String    alias_slots[OFD_LANGUAGE_ALIASES_SLOTS];
+    unsigned char alias_languages[OFD_LANGUAGE_ALIASES_SLOTS]; // Index + 1 of the language in languages, 0 for an empty slot.
+    
+    ofd_b8 builtins_are_registered;
+} Ofd_Language_Registry;
+
+static Ofd_Language_Registry ofd_language_registry; // Fill this before parsing markdown on several threads, see ofd_register_language().
+
+ofd_static void ofd_prepare_language(Ofd_Language* language)
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: this builds the keyword set, the character classes and the definition hash of language from its other fields.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    ofd_keyword_set_init(&language->keyword_set, language->keywords, language->num_keywords);
+    ofd_init_syntax_character_classes(language);
+    
+    // Hash the definition. START
+    Ofd_String strings[OFD_MAX_LANGUAGE_ALIASES + 5] = {language->single_line_comment_start, language->multi_line_comment_start, language->multi_line_comment_end, language->string_delimiters, language->number_characters};
+    for(int i = 0; i < OFD_MAX_LANGUAGE_ALIASES; i++) strings[5 + i] = language->aliases[i];
+    
+    ofd_u64 hash = ofd_hash_64(OFD_HASH_64_START, &language->flags, sizeof(language->flags));
+    for(int i = 0; i < ofd_array_count(strings); i++)
+    {
+        hash = ofd_hash_64(hash, strings[i].data, strings[i].count);
+        hash = ofd_hash_64(hash, "", 1); // Separate strings so that "ab" + "c" and "a" + "bc" give different hashes.
+    }
+    
+    for(int i = 0; i < language->num_keywords; i++)
+    {
+        hash = ofd_hash_64(hash, language->keywords[i].data, language->keywords[i].count);
+        hash = ofd_hash_64(hash, "", 1);
+    }
+    
+    language->definition_hash = hash;
+    // Hash the definition. END
+}
+
+ofd_static Ofd_Language* ofd_register_language(Ofd_Language* language)
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: this copies language into the registry and prepares it, see ofd_prepare_language(). It returns NULL if the registry is full.
+    // The registry is shared by every thread and is not locked: register your languages before generating any documentation.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    ofd_register_builtin_languages();
+    
+    Ofd_Language_Registry* registry = &ofd_language_registry;
+    if(registry->num_languages >= OFD_MAX_LANGUAGES) return NULL;
+    
+    Ofd_Language* result = &registry->languages[registry->num_languages];
+    registry->num_languages++;
+    
+    *result = *language;
+    ofd_prepare_language(result);
+    
+    for(int i = 0; i < OFD_MAX_LANGUAGE_ALIASES; i++)
+    {
+        Ofd_String alias = result->aliases[i];
+        if(!alias.count) continue;
+        
+        int slot_index = ofd_hash_string(alias) & (OFD_LANGUAGE_ALIASES_SLOTS - 1);
+        while(registry->alias_languages[slot_index] && !ofd_strings_match(registry->alias_slots[slot_index], alias))
+        {
+            slot_index = (slot_index + 1) & (OFD_LANGUAGE_ALIASES_SLOTS - 1);
+        }
+        
+        registry->alias_slots[slot_index]     = alias;
+        registry->alias_languages[slot_index] = registry->num_languages;
+    }
+    
+    return result;
+}
+
+ofd_static Ofd_Language* ofd_find_language(Ofd_String alias)
+{
+    ofd_register_builtin_languages();
+    
+    Ofd_Language_Registry* registry = &ofd_language_registry;
+    
+    int slot_index = ofd_hash_string(alias) & (OFD_LANGUAGE_ALIASES_SLOTS - 1);
+    while(registry->alias_languages[slot_index])
+    {
+        if(ofd_strings_match(registry->alias_slots[slot_index], alias)) return &registry->languages[registry->alias_languages[slot_index] - 1];
+        slot_index = (slot_index + 1) & (OFD_LANGUAGE_ALIASES_SLOTS - 1);
+    }
+    
+    return NULL;
+}
+
+ofd_static void ofd_register_builtin_languages(void)
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: this does nothing after the first call. Languages registered afterwards replace the built-in ones with the same alias.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    if(ofd_language_registry.builtins_are_registered) return;
+    ofd_language_registry.builtins_are_registered = ofd_true;
+    
+    
+    {
+        static const Ofd_String bytes_keywords[] = {
+            OFD_STRING("b8"),
+            OFD_STRING("break"),
+            OFD_STRING("cast"),
+            OFD_STRING("Code"),
+            OFD_STRING("continue"),
+            OFD_STRING("f32"),
+            OFD_STRING("false"),
+            OFD_STRING("for"),
+            OFD_STRING("else"),
+            OFD_STRING("enum"),
+            OFD_STRING("enum_flags"),
+            OFD_STRING("if"),
+            OFD_STRING("return"),
+            OFD_STRING("s8"),
+            OFD_STRING("s16"),
+            OFD_STRING("s32"),
+            OFD_STRING("s64"),
+            OFD_STRING("size_of"),
+            OFD_STRING("String"),
+            OFD_STRING("struct"),
+            OFD_STRING("switch"),
+            OFD_STRING("true"),
+            OFD_STRING("Type"),
+            OFD_STRING("type_of"),
+            OFD_STRING("u8"),
+            OFD_STRING("u16"),
+            OFD_STRING("u32"),
+            OFD_STRING("u64"),
+            OFD_STRING("while"),
+        };
+        
+        Ofd_Language language = {{OFD_STRING("8")}, OFD_STRING("//"), OFD_STRING("/*"), OFD_STRING("*/"), bytes_keywords, ofd_array_count(bytes_keywords), {0}, {0}, OFD_SUPPORTS_NESTED_MULTI_LINE_COMMENTS};
+        ofd_register_language(&language);
+    }
+    
+    {
+        static const Ofd_String jai_keywords[] = {
+            OFD_STRING("Any"),
+            OFD_STRING("asm"),
+            OFD_STRING("bool"),
             OFD_STRING("break"),
             OFD_STRING("case"),
             OFD_STRING("cast"),
@@ -1753,11 +4405,12 @@ ofd_static void ofd_apply_syntax_highlighting(Ofd_Array* result_html, Ofd_String
             OFD_STRING("xx"),
         };
         
-        ofd_apply_c_syntax_highlighting(result_html, text, Ofd_String_("//"), Ofd_String_("/*"), Ofd_String_("*/"), jai_keywords, ofd_array_count(jai_keywords), OFD_SUPPORTS_NESTED_MULTI_LINE_COMMENTS);
+        Ofd_Language language = {{OFD_STRING("jai")}, OFD_STRING("//"), OFD_STRING("/*"), OFD_STRING("*/"), jai_keywords, ofd_array_count(jai_keywords), {0}, {0}, OFD_SUPPORTS_NESTED_MULTI_LINE_COMMENTS};
+        ofd_register_language(&language);
     }
-    else if(ofd_string_matches(language, "c") || ofd_string_matches(language, "cpp") || ofd_string_matches(language, "c++"))
+    
     {
-        const Ofd_String c_keywords[] = { // Taken from https://en.cppreference.com/w/cpp/keyword
+        static const Ofd_String c_keywords[] = { // Taken from https://en.cppreference.com/w/cpp/keyword
             OFD_STRING("alignas"),
             OFD_STRING("alignof"),
             OFD_STRING("and"),
@@ -1857,11 +4510,12 @@ ofd_static void ofd_apply_syntax_highlighting(Ofd_Array* result_html, Ofd_String
             OFD_STRING("xor_eq"),
         };
         
-        ofd_apply_c_syntax_highlighting(result_html, text, Ofd_String_("//"), Ofd_String_("/*"), Ofd_String_("*/"), c_keywords, ofd_array_count(c_keywords), 0);
+        Ofd_Language language = {{OFD_STRING("c"), OFD_STRING("cpp"), OFD_STRING("c++")}, OFD_STRING("//"), OFD_STRING("/*"), OFD_STRING("*/"), c_keywords, ofd_array_count(c_keywords), {0}, {0}, 0};
+        ofd_register_language(&language);
     }
-    else if(ofd_string_matches(language, "go"))
+    
     {
-        const Ofd_String go_keywords[] = { // Taken from https://go.dev/ref/spec
+        static const Ofd_String go_keywords[] = { // Taken from https://go.dev/ref/spec
             OFD_STRING("break"),
             OFD_STRING("default"),
             OFD_STRING("func"),
@@ -1889,11 +4543,12 @@ ofd_static void ofd_apply_syntax_highlighting(Ofd_Array* result_html, Ofd_String
             OFD_STRING("var"),
         };
         
-        ofd_apply_c_syntax_highlighting(result_html, text, Ofd_String_("//"), Ofd_String_("/*"), Ofd_String_("*/"), go_keywords, ofd_array_count(go_keywords), OFD_BACKTICK_IS_A_STRING);
+        Ofd_Language language = {{OFD_STRING("go")}, OFD_STRING("//"), OFD_STRING("/*"), OFD_STRING("*/"), go_keywords, ofd_array_count(go_keywords), {0}, {0}, OFD_BACKTICK_IS_A_STRING};
+        ofd_register_language(&language);
     }
-    else if(ofd_string_matches(language, "rs") || ofd_string_matches(language, "rust"))
+    
     {
-        const Ofd_String rust_keywords[] = { // Taken from https://doc.rust-lang.org/reference/keywords.html
+        static const Ofd_String rust_keywords[] = { // Taken from https://doc.rust-lang.org/reference/keywords.html
             OFD_STRING("as"),
             OFD_STRING("break"),
             OFD_STRING("const"),
@@ -1936,11 +4591,12 @@ ofd_static void ofd_apply_syntax_highlighting(Ofd_Array* result_html, Ofd_String
             OFD_STRING("union"),
         };
         
-        ofd_apply_c_syntax_highlighting(result_html, text, Ofd_String_("//"), Ofd_String_("/*"), Ofd_String_("*/"), rust_keywords, ofd_array_count(rust_keywords), OFD_THIS_IS_RUST | OFD_SUPPORTS_NESTED_MULTI_LINE_COMMENTS);
+        Ofd_Language language = {{OFD_STRING("rs"), OFD_STRING("rust")}, OFD_STRING("//"), OFD_STRING("/*"), OFD_STRING("*/"), rust_keywords, ofd_array_count(rust_keywords), {0}, {0}, OFD_THIS_IS_RUST | OFD_SUPPORTS_NESTED_MULTI_LINE_COMMENTS};
+        ofd_register_language(&language);
     }
-    else if(ofd_string_matches(language, "cs") || ofd_string_matches(language, "c#"))
+    
     {
-        const Ofd_String cs_keywords[] = { // Taken from https://learn.microsoft.com/en-us/dotnet/csharp/language-reference/keywords/
+        static const Ofd_String cs_keywords[] = { // Taken from https://learn.microsoft.com/en-us/dotnet/csharp/language-reference/keywords/
             OFD_STRING("abstract"),
             OFD_STRING("as"),
             OFD_STRING("base"),
@@ -2020,11 +4676,12 @@ ofd_static void ofd_apply_syntax_highlighting(Ofd_Array* result_html, Ofd_String
             OFD_STRING("while"),
         };
         
-        ofd_apply_c_syntax_highlighting(result_html, text, Ofd_String_("//"), Ofd_String_("/*"), Ofd_String_("*/"), cs_keywords, ofd_array_count(cs_keywords), 0);
+        Ofd_Language language = {{OFD_STRING("cs"), OFD_STRING("c#")}, OFD_STRING("//"), OFD_STRING("/*"), OFD_STRING("*/"), cs_keywords, ofd_array_count(cs_keywords), {0}, {0}, 0};
+        ofd_register_language(&language);
     }
-    else if(ofd_string_matches(language, "java"))
+    
     {
-        const Ofd_String java_keywords[] = { // Taken from https://docs.oracle.com/javase/tutorial/java/nutsandbolts/_keywords.html
+        static const Ofd_String java_keywords[] = { // Taken from https://docs.oracle.com/javase/tutorial/java/nutsandbolts/_keywords.html
             OFD_STRING("abstract"),
             OFD_STRING("assert"),
             OFD_STRING("boolean"),
@@ -2077,11 +4734,12 @@ ofd_static void ofd_apply_syntax_highlighting(Ofd_Array* result_html, Ofd_String
             OFD_STRING("while"),
         };
         
-        ofd_apply_c_syntax_highlighting(result_html, text, Ofd_String_("//"), Ofd_String_("/*"), Ofd_String_("*/"), java_keywords, ofd_array_count(java_keywords), 0);
+        Ofd_Language language = {{OFD_STRING("java")}, OFD_STRING("//"), OFD_STRING("/*"), OFD_STRING("*/"), java_keywords, ofd_array_count(java_keywords), {0}, {0}, 0};
+        ofd_register_language(&language);
     }
-    else if(ofd_string_matches(language, "perl"))
+    
     {
-        const Ofd_String perl_keywords[] = { // Taken from https://learn.perl.org/docs/keywords.html
+        static const Ofd_String perl_keywords[] = { // Taken from https://learn.perl.org/docs/keywords.html
             OFD_STRING("__DATA__"),
             OFD_STRING("__END__"),
             OFD_STRING("__FILE__"),
@@ -2124,11 +4782,12 @@ ofd_static void ofd_apply_syntax_highlighting(Ofd_Array* result_html, Ofd_String
             OFD_STRING("y"),
         };
         
-        ofd_apply_c_syntax_highlighting(result_html, text, Ofd_String_("#"), Ofd_String_(""), Ofd_String_(""), perl_keywords, ofd_array_count(perl_keywords), 0);
+        Ofd_Language language = {{OFD_STRING("perl")}, OFD_STRING("#"), OFD_STRING(""), OFD_STRING(""), perl_keywords, ofd_array_count(perl_keywords), {0}, {0}, 0};
+        ofd_register_language(&language);
     }
-    else if(ofd_string_matches(language, "py") || ofd_string_matches(language, "python"))
+    
     {
-        const Ofd_String py_keywords[] = {
+        static const Ofd_String py_keywords[] = {
             OFD_STRING("and"),
             OFD_STRING("as"),
             OFD_STRING("assert"),
@@ -2162,12 +4821,12 @@ ofd_static void ofd_apply_syntax_highlighting(Ofd_Array* result_html, Ofd_String
             OFD_STRING("yield"),
         };
         
-        
-        ofd_apply_c_syntax_highlighting(result_html, text, Ofd_String_("#"), Ofd_String_("\"\"\""), Ofd_String_("\"\"\""), py_keywords, ofd_array_count(py_keywords), 0);
+        Ofd_Language language = {{OFD_STRING("py"), OFD_STRING("python")}, OFD_STRING("#"), OFD_STRING("\"\"\""), OFD_STRING("\"\"\""), py_keywords, ofd_array_count(py_keywords), {0}, {0}, 0};
+        ofd_register_language(&language);
     }
-    else if(ofd_string_matches(language, "js") || ofd_string_matches(language, "javascript"))
+    
     {
-        const Ofd_String js_keywords[] = { // Taken from https://www.programiz.com/javascript/keywords-identifiers
+        static const Ofd_String js_keywords[] = { // Taken from https://www.programiz.com/javascript/keywords-identifiers
             OFD_STRING("await"),
             OFD_STRING("break"),
             OFD_STRING("case"),
@@ -2216,11 +4875,12 @@ ofd_static void ofd_apply_syntax_highlighting(Ofd_Array* result_html, Ofd_String
             OFD_STRING("yield"),
         };
         
-        ofd_apply_c_syntax_highlighting(result_html, text, Ofd_String_("//"), Ofd_String_("/*"), Ofd_String_("*/"), js_keywords, ofd_array_count(js_keywords), 0);
+        Ofd_Language language = {{OFD_STRING("js"), OFD_STRING("javascript")}, OFD_STRING("//"), OFD_STRING("/*"), OFD_STRING("*/"), js_keywords, ofd_array_count(js_keywords), {0}, {0}, 0};
+        ofd_register_language(&language);
     }
-    else if(ofd_string_matches(language, "ts") || ofd_string_matches(language, "typescript"))
+    
     {
-        const Ofd_String ts_keywords[] = { // Taken from https://github.com/microsoft/TypeScript/issues/2536
+        static const Ofd_String ts_keywords[] = { // Taken from https://github.com/microsoft/TypeScript/issues/2536
             OFD_STRING("break"),
             OFD_STRING("case"),
             OFD_STRING("catch"),
@@ -2283,11 +4943,12 @@ ofd_static void ofd_apply_syntax_highlighting(Ofd_Array* result_html, Ofd_String
             OFD_STRING("of"),
         };
         
-        ofd_apply_c_syntax_highlighting(result_html, text, Ofd_String_("//"), Ofd_String_("/*"), Ofd_String_("*/"), ts_keywords, ofd_array_count(ts_keywords), 0);
+        Ofd_Language language = {{OFD_STRING("ts"), OFD_STRING("typescript")}, OFD_STRING("//"), OFD_STRING("/*"), OFD_STRING("*/"), ts_keywords, ofd_array_count(ts_keywords), {0}, {0}, 0};
+        ofd_register_language(&language);
     }
-    else if(ofd_string_matches(language, "php"))
+    
     {
-        const Ofd_String php_keywords[] = { // Taken from https://www.php.net/manual/en/reserved.keywords.php
+        static const Ofd_String php_keywords[] = { // Taken from https://www.php.net/manual/en/reserved.keywords.php
             OFD_STRING("__halt_compiler"),
             OFD_STRING("abstract"),
             OFD_STRING("and"),
@@ -2360,11 +5021,12 @@ ofd_static void ofd_apply_syntax_highlighting(Ofd_Array* result_html, Ofd_String
             OFD_STRING("yield"),
         };
         
-        ofd_apply_c_syntax_highlighting(result_html, text, Ofd_String_("//"), Ofd_String_("/*"), Ofd_String_("*/"), php_keywords, ofd_array_count(php_keywords), 0);
+        Ofd_Language language = {{OFD_STRING("php")}, OFD_STRING("//"), OFD_STRING("/*"), OFD_STRING("*/"), php_keywords, ofd_array_count(php_keywords), {0}, {0}, 0};
+        ofd_register_language(&language);
     }
-    else if(ofd_string_matches(language, "bat"))
+    
     {
-        const Ofd_String bat_keywords[] = { // Taken from https://en.m.wikibooks.org/wiki/Windows_Batch_Scripting#Built-in_commands
+        static const Ofd_String bat_keywords[] = { // Taken from https://en.m.wikibooks.org/wiki/Windows_Batch_Scripting#Built-in_commands
             OFD_STRING("ASSOC"),
             OFD_STRING("BREAK"),
             OFD_STRING("CALL"),
@@ -2455,11 +5117,12 @@ ofd_static void ofd_apply_syntax_highlighting(Ofd_Array* result_html, Ofd_String
             OFD_STRING("vol"),
         };
         
-        ofd_apply_c_syntax_highlighting(result_html, text, Ofd_String_("REM"), Ofd_String_(""), Ofd_String_(""), bat_keywords, ofd_array_count(bat_keywords), 0);
+        Ofd_Language language = {{OFD_STRING("bat")}, OFD_STRING("REM"), OFD_STRING(""), OFD_STRING(""), bat_keywords, ofd_array_count(bat_keywords), {0}, {0}, 0};
+        ofd_register_language(&language);
     }
-    else if(ofd_string_matches(language, "sh") || ofd_string_matches(language, "bash"))
+    
     {
-        const Ofd_String sh_keywords[] = { // Taken from https://www.gnu.org/software/bash/manual/html_node/Reserved-Words.html
+        static const Ofd_String sh_keywords[] = { // Taken from https://www.gnu.org/software/bash/manual/html_node/Reserved-Words.html
             OFD_STRING("case"),
             OFD_STRING("coproc"),
             OFD_STRING("do"),
@@ -2479,172 +5142,878 @@ ofd_static void ofd_apply_syntax_highlighting(Ofd_Array* result_html, Ofd_String
             OFD_STRING("while"),
         };
         
-        ofd_apply_c_syntax_highlighting(result_html, text, Ofd_String_("#"), Ofd_String_(""), Ofd_String_(""), sh_keywords, ofd_array_count(sh_keywords), 0);
+        Ofd_Language language = {{OFD_STRING("sh"), OFD_STRING("bash")}, OFD_STRING("#"), OFD_STRING(""), OFD_STRING(""), sh_keywords, ofd_array_count(sh_keywords), {0}, {0}, 0};
+        ofd_register_language(&language);
+    }
+    
+    {
+        static const Ofd_String json_keywords[] = {
+            OFD_STRING("false"),
+            OFD_STRING("true"),
+        };
+        
+        Ofd_Language language = {{OFD_STRING("json")}, OFD_STRING("//"), OFD_STRING("/*"), OFD_STRING("*/"), json_keywords, ofd_array_count(json_keywords), {0}, {0}, 0};
+        ofd_register_language(&language);
+    }
+    
+    {
+        Ofd_Language language = {{OFD_STRING("css")}, OFD_STRING(""), OFD_STRING("/*"), OFD_STRING("*/"), NULL, 0, {0}, {0}, 0};
+        ofd_register_language(&language);
+    }
+    
+    {
+        Ofd_Language language = {{OFD_STRING("xml"), OFD_STRING("html")}};
+        language.highlight = ofd_highlight_xml_chunk;
+        ofd_register_language(&language);
+    }
+}
+
+ofd_static void ofd_syntax_spill_xml_text(Ofd_Highlighter_State* state, Ofd_Array* result_html, Ofd_String* basic_text)
+{
+    if(state->we_are_inside_a_tag)
+    {
+        ofd_syntax_add_token(result_html, OFD_SYNTAX_CLASS_KEYWORD, *basic_text);
+        basic_text->count = 0;
+    }
+    else
+    {
+        ofd_syntax_spill_basic_text_no_keywords(result_html, basic_text);
+    }
+}
+
+ofd_static char* ofd_highlight_xml_chunk(Ofd_Highlighter_State* state, Ofd_Array* result_html, Ofd_String text, ofd_b8 is_last_chunk)
+{
+    // Parse XML. START
+    Ofd_String comment_start = OFD_STRING("<!--");
+    Ofd_String comment_end   = OFD_STRING("-->");
+    
+    char* c           = text.data + state->num_scanned_characters;
+    char* limit       = text.data + text.count;
+    char* token_start = text.data; // The part of the comment or string we are in that is not written yet.
+    
+    Ofd_String basic_text = {c};
+    
+    while(c < limit)
+    {
+        // Go on with a comment or a string. START
+        if(state->mode == OFD_HIGHLIGHTING_MULTI_LINE_COMMENT)
+        {
+            Ofd_Syntax_Match end_match = ofd_syntax_match(c, limit, comment_end, is_last_chunk);
+            if(end_match == OFD_SYNTAX_NEEDS_MORE_TEXT) goto wait_for_more_text;
+            if(end_match == OFD_SYNTAX_MATCH)
+            {
+                c += comment_end.count;
+                ofd_syntax_finish_token(state, result_html, token_start, c);
+            }
+            else c = ofd_syntax_find_first_of(c + 1, limit, '-', '-', '-');
+            
+            continue;
+        }
+        
+        if(state->mode == OFD_HIGHLIGHTING_STRING)
+        {
+            ofd_b8 reached_the_end;
+            c = ofd_syntax_skip_string(c, limit, state->string_delimiter, is_last_chunk, &reached_the_end);
+            
+            if(reached_the_end)  ofd_syntax_finish_token(state, result_html, token_start, c);
+            else if(c < limit) goto wait_for_more_text; // We stopped on a '\\'.
+            
+            continue;
+        }
+        // Go on with a comment or a string. END
+        
+        
+        char character = *c;
+        switch(character)
+        {
+            case '<':
+            {
+                if(!is_last_chunk && (c + 1 == limit || ofd_syntax_match(c, limit, comment_start, ofd_false) == OFD_SYNTAX_NEEDS_MORE_TEXT))
+                { // We need to see what follows the '<'.
+                    goto wait_for_more_text;
+                }
+                
+                ofd_syntax_spill_xml_text(state, result_html, &basic_text);
+                
+                if(ofd_syntax_match(c, limit, comment_start, is_last_chunk) == OFD_SYNTAX_MATCH)
+                {
+                    ofd_syntax_begin_token(result_html, OFD_SYNTAX_CLASS_COMMENT);
+                    
+                    token_start = c;
+                    c += comment_start.count;
+                    state->mode = OFD_HIGHLIGHTING_MULTI_LINE_COMMENT;
+                    
+                    break;
+                }
+                
+                
+                state->we_are_inside_a_tag = ofd_true;
+                
+                ofd_syntax_begin_token(result_html, OFD_SYNTAX_CLASS_STRUCTURE);
+                ofd_array_add_string(result_html, Ofd_String_("&lt"));
+                
+                if(c + 1 < limit && c[1] == '/')
+                {
+                    c++;
+                    ofd_array_add_string(result_html, Ofd_String_("/"));
+                }
+                
+                ofd_syntax_end_token(result_html);
+                
+                c++;
+            } break;
+            
+            case '>':
+            {
+                ofd_syntax_spill_xml_text(state, result_html, &basic_text);
+                
+                state->we_are_inside_a_tag = ofd_false;
+                
+                ofd_syntax_begin_token(result_html, OFD_SYNTAX_CLASS_STRUCTURE);
+                ofd_array_add_string(result_html, Ofd_String_("&gt"));
+                ofd_syntax_end_token(result_html);
+                c++;
+            } break;
+            
+            
+            case '"':
+            case '\'':
+            {
+                ofd_syntax_spill_xml_text(state, result_html, &basic_text);
+                
+                ofd_syntax_begin_token(result_html, OFD_SYNTAX_CLASS_STRING);
+                
+                token_start = c;
+                c++;
+                state->mode             = OFD_HIGHLIGHTING_STRING;
+                state->string_delimiter = character;
+            } break;
+            
+            
+            default:
+            {
+                if(!basic_text.count) basic_text.data = c;
+                basic_text.count++;
+                c++;
+            } break;
+        }
+    }
+    
+    wait_for_more_text:;
+    
+    if(!is_last_chunk)
+    {
+        state->num_scanned_characters = 0;
+        if(state->mode == OFD_HIGHLIGHTING_CODE) return basic_text.count ? basic_text.data : c;
+        
+        char* result = ofd_syntax_write_unfinished_token(result_html, token_start, c);
+        state->num_scanned_characters = c - result;
+        
+        return result;
+    }
+    
+    if(state->mode != OFD_HIGHLIGHTING_CODE) ofd_syntax_finish_token(state, result_html, token_start, limit);
+    ofd_syntax_spill_xml_text(state, result_html, &basic_text);
+    // Parse XML. END
+    
+    return limit;
+}
+
+ofd_static void ofd_begin_highlighting(Ofd_Highlighter_State* state, Ofd_Language* language)
+{
+    Ofd_Highlighter_State empty_state = {0};
+    *state = empty_state;
+    state->language = language;
+    
+    ofd_array_init(&state->pending, 1);
+}
+
+ofd_static void ofd_run_highlighter(Ofd_Highlighter_State* state, Ofd_Array* result_html, Ofd_String text, ofd_b8 is_last_chunk)
+{
+    Ofd_Highlight_Callback* highlight = state->language->highlight ? state->language->highlight : ofd_highlight_c_like_chunk;
+    
+    char* rest = highlight(state, result_html, text, is_last_chunk);
+    if(is_last_chunk) return;
+    
+    if(rest > text.data) state->previous_character = rest[-1];
+    
+    // Keep the rest for the next chunk. START
+    int rest_count = ofd_cast(text.data + text.count - rest, int);
+    if(text.data == state->pending.data)
+    {
+        for(int i = 0; i < rest_count; i++) state->pending.data[i] = rest[i]; // This can overlap.
+        state->pending.count = rest_count;
+    }
+    else
+    {
+        Ofd_String rest_string = {rest, rest_count};
+        state->pending.count = 0;
+        ofd_array_add_string(&state->pending, rest_string);
+    }
+    // Keep the rest for the next chunk. END
+}
+
+ofd_static void ofd_feed_highlighter(Ofd_Highlighter_State* state, Ofd_Array* result_html, Ofd_String chunk)
+{
+    Ofd_String text = chunk;
+    if(state->pending.count)
+    {
+        ofd_array_add_string(&state->pending, chunk);
+        text.data  = state->pending.data;
+        text.count = state->pending.count;
+    }
+    
+    ofd_run_highlighter(state, result_html, text, ofd_false);
+}
+
+ofd_static void ofd_finish_highlighting(Ofd_Highlighter_State* state, Ofd_Array* result_html)
+{
+    Ofd_String text = {state->pending.data, state->pending.count};
+    ofd_run_highlighter(state, result_html, text, ofd_true);
+    
+    ofd_free_array(&state->pending);
+}
+
+ofd_static void ofd_highlight_text(Ofd_Array* result_html, Ofd_String text, Ofd_Language* language)
+{
+    Ofd_Highlighter_State state;
+    ofd_begin_highlighting(&state, language);
+    
+    ofd_run_highlighter(&state, result_html, text, ofd_true); // The whole text is the last chunk, nothing gets copied.
+}
+
+
+#ifndef OFD_NO_FILE_IO
+typedef struct
+{
+    ofd_u64 key[2];
+    ofd_u32 offset; // From the start of the blobs in the cache file.
+    ofd_u32 size;
+    ofd_u32 last_used;
+    ofd_u32 padding;
+} Ofd_Cache_File_Entry;
+
+typedef struct
+{
+    char    magic[8];
+    ofd_u32 num_entries;
+    ofd_u32 clock; // Incremented every time the cache is opened, entries remember the last time they were used.
+} Ofd_Cache_File_Header;
+
+#define OFD_HIGHLIGHT_CACHE_MAGIC "OFDHC001"
+#define OFD_FILE_CACHE_MAGIC      "OFDFC002"
+
+typedef struct
+{
+    ofd_u64 key[2];
+    char*   blob;   // This points into the cache file, or to memory of its own if the entry was added during this run.
+    int     size;
+    ofd_u32 last_used;
+    ofd_b8  is_new;
+} Ofd_Cache_Entry;
+
+typedef struct
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: a cache keeps blobs on disk between runs, looked up by a 128-bit key. The highlight cache keeps highlighted code blocks and
+    // the file cache keeps parsed markdown files, see ofd_open_highlight_cache() and ofd_open_file_cache(). A cache opened without a
+    // directory has no filepath and only lives in memory.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    ofd_b8 is_open;
+    char*  name;  // For messages, e.g. "highlight cache".
+    char*  magic; // OFD_HIGHLIGHT_CACHE_MAGIC or OFD_FILE_CACHE_MAGIC, it tells the cache files apart.
+    int    allocation_tag;
+    char*  filepath;
+    int    max_size;
+    
+    Ofd_String file;
+    ofd_b8     file_is_mapped;
+    
+    ofd_u32   clock;
+    Ofd_Array entries; // Ofd_Cache_Entry.
+    Ofd_Array slots;   // Index + 1 of an entry, 0 for an empty slot. The number of slots is a power of two.
+    ofd_b8    blobs_changed; // If this is false the cache file only needs its entries to be updated when we close the cache.
+    
+    Ofd_Mutex mutex;
+} Ofd_Cache;
+
+static Ofd_Cache ofd_highlight_cache;
+static Ofd_Cache ofd_file_cache;
+
+ofd_static void ofd_close_cache(Ofd_Cache* cache);
+
+ofd_static void ofd_get_highlight_cache_key(Ofd_Language* language, Ofd_String text, ofd_u64* result)
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: a 128-bit hash makes up the key, we never compare block texts so collisions must be unlikely. It is computed
+    // on every block of every build so it has to stay well below the cost of highlighting, see ofd_hash_128().
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    ofd_u64 header[2] = {ofd_cast(OFD_HIGHLIGHTER_VERSION, ofd_u64) << 32 | ofd_cast(text.count, ofd_u32), language->definition_hash};
+    #ifndef OFD_COMPACT_SYNTAX_MARKUP
+    header[0] |= 1ull << 63;
+    #endif
+    
+    result[0] = OFD_HASH_128_START_0;
+    result[1] = OFD_HASH_128_START_1;
+    ofd_mix_hash_128(result, header[0], header[1]);
+    ofd_hash_128(result, text.data, text.count);
+}
+
+ofd_static Ofd_Cache_Entry* ofd_find_cache_entry(Ofd_Cache* cache, ofd_u64* key)
+{
+    int* slots    = ofd_cast(cache->slots.data, int*);
+    int slot_mask = cache->slots.count - 1;
+    
+    int slot_index = ofd_cast(key[0], int) & slot_mask;
+    while(slots[slot_index])
+    {
+        Ofd_Cache_Entry* entry = ofd_cast(cache->entries.data, Ofd_Cache_Entry*) + slots[slot_index] - 1;
+        if(entry->key[0] == key[0] && entry->key[1] == key[1]) return entry;
+        
+        slot_index = (slot_index + 1) & slot_mask;
+    }
+    
+    return NULL;
+}
+
+ofd_static void ofd_resize_cache_slots(Ofd_Cache* cache, int num_slots)
+{
+    ofd_free_array(&cache->slots);
+    ofd_array_init_with_space(&cache->slots, sizeof(int), num_slots);
+    cache->slots.count = num_slots;
+    
+    int* slots = ofd_cast(cache->slots.data, int*);
+    for(int i = 0; i < num_slots; i++) slots[i] = 0;
+    
+    for(int i = 0; i < cache->entries.count; i++)
+    {
+        Ofd_Cache_Entry* entry = ofd_cast(cache->entries.data, Ofd_Cache_Entry*) + i;
+        
+        int slot_index = ofd_cast(entry->key[0], int) & (num_slots - 1);
+        while(slots[slot_index]) slot_index = (slot_index + 1) & (num_slots - 1);
+        slots[slot_index] = i + 1;
+    }
+}
+
+ofd_static void ofd_add_cache_entry(Ofd_Cache* cache, Ofd_Cache_Entry entry)
+{
+    if((cache->entries.count + 1) * 4 > cache->slots.count * 3) ofd_resize_cache_slots(cache, cache->slots.count * 2);
+    
+    Ofd_Cache_Entry* new_entry = ofd_array_add_fast(&cache->entries);
+    *new_entry = entry;
+    
+    int* slots    = ofd_cast(cache->slots.data, int*);
+    int slot_mask = cache->slots.count - 1;
+    
+    int slot_index = ofd_cast(entry.key[0], int) & slot_mask;
+    while(slots[slot_index]) slot_index = (slot_index + 1) & slot_mask;
+    slots[slot_index] = cache->entries.count;
+}
+
+ofd_static ofd_b8 ofd_open_cache(Ofd_Cache* cache, char* directory, char* filename, char* magic, char* name, int max_size, int allocation_tag)
+{
+    if(cache->is_open) ofd_close_cache(cache);
+    
+    char* filepath           = NULL; // Stays NULL for a cache that only lives in memory.
+    ofd_b8 cache_file_exists = ofd_false;
+    if(directory)
+    {
+        #if defined(_WIN32) || defined(_WIN64)
+        _mkdir(directory);
+        #else
+        mkdir(directory, 0777);
+        #endif // Failing here is fine, the directory most likely exists already. We find out below otherwise.
+        
+        int filepath_size = ofd_strlen(directory) + ofd_strlen(filename) + 2;
+        filepath          = ofd_tagged_allocate(filepath_size, allocation_tag);
+        ofd_sprintf(filepath, "%s/%s", directory, filename);
+        
+        FILE* f = fopen(filepath, "ab"); // Make sure we will be able to save the cache, this does not change the file.
+        if(!f)
+        {
+            ofd_printf("Failed to open the %s '%s'.\n", name, filepath);
+            ofd_tagged_free(filepath);
+            return ofd_false;
+        }
+        
+        cache_file_exists = (fseek(f, 0, SEEK_END) == 0 && ftell(f) > 0);
+        fclose(f);
+    }
+    
+    
+    Ofd_Cache empty_cache = {0};
+    *cache = empty_cache;
+    cache->is_open        = ofd_true;
+    cache->name           = name;
+    cache->magic          = magic;
+    cache->allocation_tag = allocation_tag;
+    cache->filepath       = filepath;
+    cache->max_size       = max_size;
+    
+    ofd_array_init(&cache->entries, sizeof(Ofd_Cache_Entry));
+    ofd_array_init(&cache->slots,   sizeof(int));
+    ofd_resize_cache_slots(cache, 1024);
+    ofd_mutex_init(&cache->mutex);
+    
+    if(cache_file_exists && ofd_map_whole_file(filepath, &cache->file, &cache->file_is_mapped))
+    {
+        // Load the entries. START
+        Ofd_Cache_File_Header header;
+        
+        int entries_size = 0;
+        ofd_b8 is_valid  = (cache->file.count >= ofd_cast(sizeof(header), int));
+        if(is_valid)
+        {
+            ofd_copy(&header, cache->file.data, sizeof(header));
+            entries_size = header.num_entries * sizeof(Ofd_Cache_File_Entry);
+            
+            is_valid = (ofd_memcmp(header.magic, cache->magic, sizeof(header.magic)) == 0 && header.num_entries <= (cache->file.count - sizeof(header)) / sizeof(Ofd_Cache_File_Entry));
+        }
+        
+        if(is_valid)
+        {
+            cache->clock = header.clock;
+            
+            char* blobs        = cache->file.data + sizeof(header) + entries_size;
+            ofd_u32 blobs_size = cache->file.count - sizeof(header) - entries_size;
+            ofd_u32 offset     = 0;
+            
+            for(ofd_u32 i = 0; i < header.num_entries; i++)
+            {
+                Ofd_Cache_File_Entry file_entry;
+                ofd_copy(&file_entry, cache->file.data + sizeof(header) + i * sizeof(file_entry), sizeof(file_entry));
+                
+                Ofd_Cache_Entry entry = {{file_entry.key[0], file_entry.key[1]}, blobs + file_entry.offset, ofd_cast(file_entry.size, int), file_entry.last_used, ofd_false};
+                
+                ofd_b8 is_corrupted = (file_entry.offset != offset || file_entry.size > blobs_size - offset); // Blobs are stored in the same order as entries.
+                if(is_corrupted || ofd_find_cache_entry(cache, entry.key))
+                {
+                    cache->blobs_changed = ofd_true;
+                    continue;
+                }
+                
+                ofd_add_cache_entry(cache, entry);
+                offset += file_entry.size;
+            }
+        }
+        else ofd_printf("The %s '%s' is not valid, it will be rebuilt.\n", name, filepath);
+        // Load the entries. END
     }
-    else if(ofd_string_matches(language, "json"))
+    
+    cache->clock++;
+    return ofd_true;
+}
+
+ofd_static ofd_b8 ofd_open_highlight_cache(char* directory, int max_size)
+{
+    return ofd_open_cache(&ofd_highlight_cache, directory, OFD_HIGHLIGHT_CACHE_FILENAME, OFD_HIGHLIGHT_CACHE_MAGIC, "highlight cache", max_size, OFD_ALLOCATION_HIGHLIGHT_CACHE);
+}
+
+ofd_static ofd_b8 ofd_open_file_cache(char* directory, int max_size)
+{
+    return ofd_open_cache(&ofd_file_cache, directory, OFD_FILE_CACHE_FILENAME, OFD_FILE_CACHE_MAGIC, "file cache", max_size, OFD_ALLOCATION_FILE_CACHE);
+}
+
+ofd_static ofd_b8 ofd_get_from_cache(Ofd_Cache* cache, ofd_u64* key, Ofd_String* result)
+{ // result stays valid until the cache is closed.
+    ofd_mutex_lock(&cache->mutex);
+    
+    Ofd_Cache_Entry* entry = ofd_find_cache_entry(cache, key);
+    if(entry)
     {
-        const Ofd_String json_keywords[] = {
-            OFD_STRING("false"),
-            OFD_STRING("true"),
-        };
-        
-        ofd_apply_c_syntax_highlighting(result_html, text, Ofd_String_("//"), Ofd_String_("/*"), Ofd_String_("*/"), json_keywords, ofd_array_count(json_keywords), 0);
+        entry->last_used = cache->clock;
+        result->data  = entry->blob; // Entries move when new ones are added but what they point to does not.
+        result->count = entry->size;
     }
-    else if(ofd_string_matches(language, "css"))
+    
+    ofd_mutex_unlock(&cache->mutex);
+    
+    return (entry != NULL);
+}
+
+ofd_static void ofd_add_to_cache(Ofd_Cache* cache, ofd_u64* key, Ofd_String blob)
+{
+    char* blob_copy = ofd_tagged_allocate(ofd_max(blob.count, 1), cache->allocation_tag);
+    ofd_copy(blob_copy, blob.data, blob.count);
+    
+    ofd_mutex_lock(&cache->mutex);
+    
+    ofd_b8 is_already_cached = (ofd_find_cache_entry(cache, key) != NULL); // Another thread added the same blob.
+    if(!is_already_cached)
     {
-        ofd_apply_c_syntax_highlighting(result_html, text, Ofd_String_(""), Ofd_String_("/*"), Ofd_String_("*/"), NULL, 0, 0);
+        Ofd_Cache_Entry entry = {{key[0], key[1]}, blob_copy, blob.count, cache->clock, ofd_true};
+        ofd_add_cache_entry(cache, entry);
+        cache->blobs_changed = ofd_true;
     }
-    else if(ofd_string_matches(language, "xml") || ofd_string_matches(language, "html"))
+    
+    ofd_mutex_unlock(&cache->mutex);
+    
+    if(is_already_cached) ofd_tagged_free(blob_copy);
+}
+
+ofd_static void ofd_begin_cache_run(Ofd_Cache* cache)
+{
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: for caches that stay open while the documentation is generated several times. A memory-only cache drops what the last
+    // run did not use, those are old versions of blocks and files that changed since, so it does not grow with every edit.
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    if(!cache->is_open) return;
+    
+    if(!cache->filepath)
     {
-        // Parse XML. START
-        char* c     = text.data;
-        char* limit = text.data + text.count;
+        Ofd_Cache_Entry* entries = ofd_cast(cache->entries.data, Ofd_Cache_Entry*);
+        
+        int num_kept_entries = 0;
+        for(int i = 0; i < cache->entries.count; i++)
+        {
+            if(entries[i].last_used == cache->clock) entries[num_kept_entries++] = entries[i];
+            else                                     ofd_tagged_free(entries[i].blob); // Every entry of a memory-only cache is new.
+        }
         
-        ofd_b8 we_are_inside_a_tag = ofd_false;
+        cache->entries.count = num_kept_entries;
+        ofd_resize_cache_slots(cache, cache->slots.count);
+    }
+    
+    cache->clock++;
+}
+
+ofd_static void ofd_close_cache(Ofd_Cache* cache)
+{
+    if(!cache->is_open) return;
+    
+    Ofd_Cache_Entry* entries = ofd_cast(cache->entries.data, Ofd_Cache_Entry*);
+    int num_entries = cache->entries.count;
+    
+    if(cache->filepath)
+    { // Memory-only caches have nothing to save.
+        #define OFD_CACHE_ENTRY_SIZE(_entry) ofd_cast(sizeof(Ofd_Cache_File_Entry) + (_entry)->size, ofd_u64)
         
-        Ofd_String basic_text = {c};
+        // Choose which entries to keep. START
+        ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // NOTE: we keep the entries used since the oldest run we can afford, then fill what space is left with entries of the run
+        // before it.
+        ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
         
-        while(c < limit)
+        ofd_u64 max_size = ofd_cast(ofd_max(cache->max_size, 0), ofd_u64);
+        
+        ofd_u32 oldest_run_to_keep = 0; // We look for the smallest run that makes everything used since then fit. START
+        ofd_u32 newest_run_to_drop = cache->clock + 1;
+        while(oldest_run_to_keep < newest_run_to_drop)
         {
-            char character = *c;
-            switch(character)
+            ofd_u32 run = oldest_run_to_keep + (newest_run_to_drop - oldest_run_to_keep) / 2;
+            
+            ofd_u64 size = 0;
+            for(int i = 0; i < num_entries; i++)
             {
-                case '<':
-                {
-                    if(we_are_inside_a_tag)
-                    {
-                        ofd_array_add_string(result_html, Ofd_String_("<div class='ofd-syntax ofd-syntax-keyword'>"));
-                        ofd_syntax_spill_basic_text_no_keywords(result_html, &basic_text);
-                        ofd_array_add_string(result_html, Ofd_String_("</div>"));
-                    }
-                    else
-                    {
-                        ofd_syntax_spill_basic_text_no_keywords(result_html, &basic_text);
-                    }
-                    
-                    
-                    const char* comment_start = "<!--";
-                    const char* comment_end   = "-->";
-                    int comment_start_count = ofd_strlen(comment_start);
-                    int comment_end_count   = ofd_strlen(comment_end);
-                    if(c + comment_start_count <= limit && ofd_memcmp(c, comment_start, comment_start_count) == 0)
-                    {
-                        // Handle a comment. START
-                        Ofd_String token = {c};
-                        c += comment_start_count;
-                        while(c < limit)
-                        {
-                            if(c + comment_end_count <= limit && ofd_memcmp(c, comment_end, comment_end_count) == 0)
-                            {
-                                c += comment_end_count;
-                                break;
-                            }
-                            
-                            c++;
-                        }
-                        
-                        token.count = c - token.data;
-                        
-                        ofd_array_add_string(result_html, Ofd_String_("<div class='ofd-syntax ofd-syntax-comment'>"));
-                        ofd_syntax_insert_token(result_html, token);
-                        ofd_array_add_string(result_html, Ofd_String_("</div>"));
-                        // Handle a comment. END
-                        
-                        break;
-                    }
-                    
-                    
-                    we_are_inside_a_tag = ofd_true;
-                    
-                    ofd_array_add_string(result_html, Ofd_String_("<div class='ofd-syntax ofd-syntax-structure'>&lt"));
-                    
-                    if(c + 1 < limit && c[1] == '/')
-                    {
-                        c++;
-                        ofd_array_add_string(result_html, Ofd_String_("/"));
-                    }
-                    
-                    ofd_array_add_string(result_html, Ofd_String_("</div>"));
-                    
-                    c++;
-                } break;
+                if(entries[i].last_used >= run) size += OFD_CACHE_ENTRY_SIZE(entries + i);
+            }
+            
+            if(size <= max_size) newest_run_to_drop = run;
+            else                 oldest_run_to_keep = run + 1;
+        } // We look for the smallest run that makes everything used since then fit. END
+        
+        ofd_b8* keep_entry = ofd_tagged_allocate(ofd_max(num_entries, 1), cache->allocation_tag);
+        ofd_u64 total_size = 0;
+        int num_kept_entries = 0;
+        for(int i = 0; i < num_entries; i++)
+        {
+            keep_entry[i] = (entries[i].last_used >= oldest_run_to_keep);
+            if(keep_entry[i])
+            {
+                total_size += OFD_CACHE_ENTRY_SIZE(entries + i);
+                num_kept_entries++;
+            }
+        }
+        
+        for(int i = 0; i < num_entries && oldest_run_to_keep; i++)
+        {
+            if(entries[i].last_used != oldest_run_to_keep - 1) continue;
+            
+            ofd_u64 entry_size = OFD_CACHE_ENTRY_SIZE(entries + i);
+            if(total_size + entry_size > max_size) continue;
+            
+            keep_entry[i] = ofd_true;
+            total_size += entry_size;
+            num_kept_entries++;
+        }
+        // Choose which entries to keep. END
+        
+        
+        // Save the cache. START
+        Ofd_Cache_File_Header header;
+        ofd_copy(header.magic, cache->magic, sizeof(header.magic));
+        header.num_entries = num_kept_entries;
+        header.clock       = cache->clock;
+        
+        ofd_b8 only_usage_changed = (!cache->blobs_changed && num_kept_entries == num_entries && cache->file.count);
+        
+        Ofd_Array file_entries;
+        ofd_array_init_with_space(&file_entries, sizeof(Ofd_Cache_File_Entry), ofd_max(num_kept_entries, 1));
+        
+        ofd_u32 offset = 0;
+        for(int i = 0; i < num_entries; i++)
+        {
+            if(!keep_entry[i]) continue;
+            
+            Ofd_Cache_File_Entry* file_entry = ofd_array_add_fast(&file_entries);
+            file_entry->key[0]    = entries[i].key[0];
+            file_entry->key[1]    = entries[i].key[1];
+            file_entry->offset    = offset;
+            file_entry->size      = entries[i].size;
+            file_entry->last_used = entries[i].last_used;
+            file_entry->padding   = 0;
+            
+            offset += entries[i].size;
+        }
+        
+        if(only_usage_changed)
+        { // The blobs are the same and stay in the same order, we only rewrite the header and the entries.
+            ofd_release_whole_file(&cache->file, cache->file_is_mapped); // We do not need the blobs anymore.
+            
+            FILE* f = fopen(cache->filepath, "r+b");
+            ofd_b8 status = (f != NULL);
+            if(f)
+            {
+                status &= (fwrite(&header, sizeof(header), 1, f) == 1);
+                status &= (fwrite(file_entries.data, sizeof(Ofd_Cache_File_Entry), file_entries.count, f) == ofd_cast(file_entries.count, size_t));
+                fclose(f);
+            }
+            
+            if(!status) ofd_printf("Failed to correctly write the %s '%s'.\n", cache->name, cache->filepath);
+        }
+        else
+        { // Write a new cache file next to the old one and replace it.
+            char* temporary_filepath = ofd_tagged_allocate(ofd_strlen(cache->filepath) + 5, cache->allocation_tag);
+            ofd_sprintf(temporary_filepath, "%s.tmp", cache->filepath);
+            
+            Ofd_Writer writer;
+            if(ofd_writer_init_with_file(&writer, temporary_filepath))
+            {
+                ofd_writer_add(&writer, &header, sizeof(header));
+                ofd_writer_add(&writer, file_entries.data, file_entries.count * sizeof(Ofd_Cache_File_Entry));
                 
-                case '>':
+                for(int i = 0; i < num_entries; i++)
                 {
-                    if(we_are_inside_a_tag)
-                    {
-                        ofd_array_add_string(result_html, Ofd_String_("<div class='ofd-syntax ofd-syntax-keyword'>"));
-                        ofd_syntax_spill_basic_text_no_keywords(result_html, &basic_text);
-                        ofd_array_add_string(result_html, Ofd_String_("</div>"));
-                    }
-                    else
-                    {
-                        ofd_syntax_spill_basic_text_no_keywords(result_html, &basic_text);
-                    }
-                    
-                    we_are_inside_a_tag = ofd_false;
-                    
-                    ofd_array_add_string(result_html, Ofd_String_("<div class='ofd-syntax ofd-syntax-structure'>&gt</div>"));
-                    c++;
-                } break;
+                    if(keep_entry[i]) ofd_writer_add(&writer, entries[i].blob, entries[i].size);
+                }
                 
+                ofd_b8 status = ofd_close_writer(&writer);
                 
-                case '"':
-                case '\'':
-                {
-                    if(we_are_inside_a_tag)
-                    {
-                        ofd_array_add_string(result_html, Ofd_String_("<div class='ofd-syntax ofd-syntax-keyword'>"));
-                        ofd_syntax_spill_basic_text_no_keywords(result_html, &basic_text);
-                        ofd_array_add_string(result_html, Ofd_String_("</div>"));
-                    }
-                    else
-                    {
-                        ofd_syntax_spill_basic_text_no_keywords(result_html, &basic_text);
-                    }
-                    
-                    
-                    c = ofd_syntax_handle_string(result_html, c, limit);
-                } break;
+                ofd_release_whole_file(&cache->file, cache->file_is_mapped); // Windows does not let us replace a file that is mapped.
                 
+                #if defined(_WIN32) || defined(_WIN64)
+                if(status) remove(cache->filepath); // rename() does not replace files on Windows.
+                #endif
                 
-                default:
+                if(status) status = (rename(temporary_filepath, cache->filepath) == 0);
+                if(!status)
                 {
-                    if(!basic_text.count) basic_text.data = c;
-                    basic_text.count++;
-                    c++;
-                } break;
+                    ofd_printf("Failed to correctly write the %s '%s'.\n", cache->name, cache->filepath);
+                    remove(temporary_filepath);
+                }
             }
+            
+            ofd_tagged_free(temporary_filepath);
         }
+        // Save the cache. END
         
+        #undef OFD_CACHE_ENTRY_SIZE
         
-        if(we_are_inside_a_tag)
-        {
-            ofd_array_add_string(result_html, Ofd_String_("<div class='ofd-syntax ofd-syntax-keyword'>"));
-            ofd_syntax_spill_basic_text_no_keywords(result_html, &basic_text);
-            ofd_array_add_string(result_html, Ofd_String_("</div>"));
-        }
-        else
+        ofd_tagged_free(keep_entry);
+        ofd_free_array(&file_entries);
+    }
+    
+    
+    if(cache->file.data) ofd_release_whole_file(&cache->file, cache->file_is_mapped);
+    
+    for(int i = 0; i < num_entries; i++)
+    {
+        if(entries[i].is_new) ofd_tagged_free(entries[i].blob);
+    }
+    
+    ofd_free_array(&cache->entries);
+    ofd_free_array(&cache->slots);
+    ofd_free_mutex(&cache->mutex);
+    if(cache->filepath) ofd_tagged_free(cache->filepath);
+    
+    cache->is_open = ofd_false;
+}
+
+ofd_static void ofd_close_highlight_cache(void)
+{
+    ofd_close_cache(&ofd_highlight_cache);
+}
+
+ofd_static void ofd_close_file_cache(void)
+{
+    ofd_close_cache(&ofd_file_cache);
+}
+#endif // OFD_NO_FILE_IO
+
+ofd_static void ofd_apply_syntax_highlighting_without_trace(Ofd_Array* result_html, Ofd_String text, Ofd_String language)
+{
+    Ofd_Language* found_language = ofd_find_language(language);
+    
+    if(!found_language)
+    {
+        ofd_array_add_filtered_text(result_html, text);
+        return;
+    }
+    
+    #ifndef OFD_NO_FILE_IO
+    ofd_u64 cache_key[2];
+    int html_start = result_html->count;
+    
+    if(ofd_highlight_cache.is_open)
+    {
+        ofd_get_highlight_cache_key(found_language, text, cache_key);
+        
+        Ofd_String html;
+        if(ofd_get_from_cache(&ofd_highlight_cache, cache_key, &html))
         {
-            ofd_syntax_spill_basic_text_no_keywords(result_html, &basic_text);
+            ofd_array_add_string(result_html, html);
+            return;
         }
-        // Parse XML. END
     }
-    else
+    #endif // OFD_NO_FILE_IO
+    
+    ofd_highlight_text(result_html, text, found_language);
+    
+    #ifndef OFD_NO_FILE_IO
+    if(ofd_highlight_cache.is_open)
     {
-        ofd_b8 was_filtered = ofd_filter_plain_text(&text);
-        ofd_array_add_string(result_html, text);
-        if(was_filtered) ofd_free(text.data);
+        Ofd_String html = {result_html->data + html_start, result_html->count - html_start};
+        ofd_add_to_cache(&ofd_highlight_cache, cache_key, html);
     }
+    #endif // OFD_NO_FILE_IO
+}
+
+ofd_static void ofd_apply_syntax_highlighting(Ofd_Array* result_html, Ofd_String text, Ofd_String language)
+{
+    ofd_f64 span_start = ofd_begin_trace_span();
+    ofd_apply_syntax_highlighting_without_trace(result_html, text, language);
+    ofd_end_trace_span("Syntax highlighting", span_start, language, text.count);
 }
 
 
 
-ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html, Ofd_Array* result_sections, Ofd_Array* link_references, int* next_section_id, Ofd_Array* log_data)
+ofd_static Ofd_String ofd_get_section_string(Ofd_Array* section_strings, int offset, int count)
 {
-    ///////////////////////////////////////////////////////////////////////////////////////////////
-    // NOTE: result_html and result_sections must be initialised beforehand using ofd_array_init().
-    ///////////////////////////////////////////////////////////////////////////////////////////////
+    Ofd_String result = {section_strings->data + offset, count};
+    return result;
+}
+
+ofd_static Ofd_Section* ofd_add_section(Ofd_Array* sections, Ofd_Array* section_strings, Ofd_String name, int id, int hierarchy, ofd_b8 also_remove_leading_number)
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: this cleans up name, makes its ID and its full ID (the IDs of its parent headers followed by its own ID) and stores all of them
+    // in section_strings. The returned pointer stays valid until the next section is added.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    Ofd_Section* section = ofd_array_add_fast(sections);
+    section->id        = id;
+    section->hierarchy = hierarchy;
+    
+    // Store the name. START
+    section->name_offset = section_strings->count;
+    
+    char* name_memory = ofd_array_add_fast_multiple(section_strings, name.count); // Cleaning up a name never makes it longer.
+    name = ofd_cleanup_section_name(name, name_memory, also_remove_leading_number);
+    
+    section->name_count    = name.count;
+    section_strings->count = section->name_offset + name.count;
+    // Store the name. END
+    
+    
+    // Store the ID. START
+    section->id_offset = section_strings->count;
+    
+    char* id_memory = ofd_array_add_fast_multiple(section_strings, name.count); // Making an ID never makes it longer either.
+    name.data = section_strings->data + section->name_offset; // The string pool may have moved.
+    
+    Ofd_String section_id = ofd_make_section_id(name, id_memory);
+    section->id_count     = section_id.count;
+    
+    if(section_id.count == name.count && ofd_memcmp(section_id.data, name.data, name.count) == 0)
+    { // The ID is the same as the name so we just share it.
+        section->id_offset = section->name_offset;
+    }
+    
+    section_strings->count = section->id_offset + section->id_count;
+    // Store the ID. END
+    
+    
+    section->full_id_offset = section->id_offset;
+    section->full_id_count  = section->id_count;
+    
+    if(hierarchy > 1 && sections->count > 1)
+    {
+        // Get the complete section ID. START
+        Ofd_Section* parents[OFD_MAX_HEADER_LEVEL];
+        int num_parents = 0;
+        int full_count  = section->id_count;
+        
+        int higher_hierarchy = hierarchy - 1;
+        
+        Ofd_Section* current_section     = section - 1;
+        Ofd_Section* section_lower_limit = ofd_cast(sections->data, Ofd_Section*);
+        while(current_section >= section_lower_limit)
+        {
+            if(current_section->hierarchy == 0) break;
+            
+            if(current_section->hierarchy <= higher_hierarchy)
+            {
+                parents[num_parents] = current_section;
+                num_parents++;
+                
+                full_count += current_section->id_count + 1; // '+ 1' for the '-' separator.
+                
+                higher_hierarchy = current_section->hierarchy - 1;
+                if(higher_hierarchy <= 0) break;
+            }
+            
+            current_section--;
+        }
+        
+        if(num_parents)
+        {
+            int full_id_offset = section_strings->count;
+            ofd_array_add_fast_multiple(section_strings, full_count);
+            
+            char* destination = section_strings->data + full_id_offset;
+            for(int i = num_parents - 1; i >= 0; i--)
+            {
+                Ofd_Section* parent = parents[i];
+                ofd_copy(destination, section_strings->data + parent->id_offset, parent->id_count);
+                destination += parent->id_count;
+                
+                *destination = '-';
+                destination++;
+            }
+            
+            ofd_copy(destination, section_strings->data + section->id_offset, section->id_count);
+            
+            section->full_id_offset = full_id_offset;
+            section->full_id_count  = full_count;
+        }
+        // Get the complete section ID. END
+    }
+    
+    
+    return section;
+}
+
+
+ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html, Ofd_Array* result_code_blocks, Ofd_Array* result_sections, Ofd_Array* section_strings, Ofd_Link_Reference_Table* link_references, int* next_section_id, Ofd_Arena* arena, Ofd_Array* log_data)
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: result_html, result_sections and section_strings must be initialised beforehand using ofd_array_init().
+    // Temporary data goes to arena, which must be initialised with ofd_arena_init() and stay alive as long as
+    // link_references is used since link references keep their additional CSS there.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
     
     char* lower_limit = c;
     
@@ -2652,10 +6021,7 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
     
     #define OFD_SPILL_TEXT()\
     {\
-        ofd_b8 was_filtered = ofd_filter_plain_text(&basic_text);\
-        ofd_array_add_string(result_html, basic_text);\
-        if(was_filtered) ofd_free(basic_text.data);\
-        \
+        ofd_array_add_filtered_text(result_html, basic_text);\
         basic_text.count = 0;\
     }
     
@@ -2687,6 +6053,9 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                 // Handle a header. START
                 OFD_SPILL_TEXT();
                 
+                ofd_f64 span_start  = ofd_begin_trace_span();
+                char*   block_start = c;
+                
                 int header_hierarchy = 0;
                 
                 while(c < limit)
@@ -2714,65 +6083,8 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                 {
                     text.count = ofd_min(text.count, OFD_MAX_SECTION_NAME_COUNT);
                     
-                    Ofd_Section* section = ofd_array_add_fast(result_sections);
-                    section->id         = *next_section_id;
-                    section->hierarchy  = header_hierarchy;
-                    
-                    Ofd_String section_name = ofd_cleanup_section_name(text, section->name_memory, ofd_false);
-                    section->name_count = section_name.count;
-                    
-                    ofd_b8 this_is_not_the_root_header = header_hierarchy > 1 && result_sections->count > 1;
-                    
-                    Ofd_String section_id = ofd_make_section_id(section_name, section->id_memory);
-                    section->id_count = section_id.count;
-                    
-                    if(this_is_not_the_root_header)
-                    {
-                        // Get the complete section ID. START
-                        char final_result[OFD_MAX_SECTION_NAME_COUNT];
-                        int final_count = 0;
-                        
-                        int higher_hierarchy = header_hierarchy - 1;
-                        
-                        char* current_destination = final_result + OFD_MAX_SECTION_NAME_COUNT - section_id.count;
-                        ofd_copy(current_destination, section_id.data, section_id.count);
-                        final_count += section_id.count;
-                        
-                        Ofd_Section* current_section     = section - 1;
-                        Ofd_Section* section_lower_limit = ofd_cast(result_sections->data, Ofd_Section*);
-                        while(current_section >= section_lower_limit)
-                        {
-                            if(current_section->hierarchy == 0) break;
-                            
-                            if(current_section->hierarchy <= higher_hierarchy)
-                            {
-                                current_destination--;
-                                *current_destination = '-';
-                                final_count++;
-                                
-                                current_destination -= current_section->id_count;
-                                ofd_copy(current_destination, current_section->id_memory, current_section->id_count);
-                                final_count += current_section->id_count;
-                                
-                                higher_hierarchy = current_section->hierarchy - 1;
-                                if(higher_hierarchy <= 0) break;
-                            }
-                            
-                            current_section--;
-                        }
-                        
-                        ofd_copy(section->full_id_memory, current_destination, final_count);
-                        
-                        section->full_id_count = final_count;
-                        section_id.count       = final_count;
-                        section_id.data        = section->full_id_memory;
-                        // Get the complete section ID. END
-                    }
-                    else
-                    {
-                        ofd_copy(section->full_id_memory, section->id_memory, section->id_count);
-                        section->full_id_count = section->id_count;
-                    }
+                    Ofd_Section* section = ofd_add_section(result_sections, section_strings, text, *next_section_id, header_hierarchy, ofd_false);
+                    Ofd_String section_id = ofd_get_section_string(section_strings, section->full_id_offset, section->full_id_count);
                     
                     (*next_section_id)++;
                     
@@ -2784,7 +6096,7 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                     ofd_array_add_string(result_html, section_id);
                     ofd_array_add_string(result_html, Ofd_String_("'>"));
                     
-                    ofd_parse_markdown(text.data, text.data + text.count, result_html, result_sections, link_references, next_section_id, log_data);
+                    ofd_parse_markdown(text.data, text.data + text.count, result_html, result_code_blocks, result_sections, section_strings, link_references, next_section_id, arena, log_data);
                     ofd_array_add_string(result_html, Ofd_String_("</div>"));
                     // Output HTML. END
                 }
@@ -2794,6 +6106,8 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                     if(*c != '\n' && *c != '\r') break;
                     c++;
                 }
+                
+                ofd_end_trace_span("Header", span_start, text, c - block_start);
                 // Handle a header. END
             } break;
             
@@ -2814,6 +6128,9 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                 
                 if(backtick_count > OFD_MAX_CODE_BLOCK_INDICATOR_COUNT) goto do_the_default_thing; // This does not appear to be a code block.
                 
+                ofd_f64 span_start  = ofd_begin_trace_span();
+                char*   block_start = c;
+                
                 c = tmp_c;
                 
                 ofd_b8 inline_the_block = backtick_count < OFD_MAX_CODE_BLOCK_INDICATOR_COUNT;
@@ -2906,9 +6223,16 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                     
                     if(!language.count)
                     { // This is a simple code block.
-                        ofd_b8 was_filtered = ofd_filter_plain_text(&text);
-                        ofd_array_add_string(result_html, text);
-                        if(was_filtered) ofd_free(text.data);
+                        ofd_array_add_filtered_text(result_html, text);
+                    }
+                    else if(result_code_blocks)
+                    { // This is a code block where the language is indicated, it will be highlighted later.
+                        Ofd_Code_Block* code_block = ofd_array_add_fast(result_code_blocks);
+                        code_block->text        = text;
+                        code_block->language    = language;
+                        code_block->html_offset = result_html->count;
+                        code_block->html.data   = NULL;
+                        code_block->html.count  = 0;
                     }
                     else
                     { // This is a code block where the language is indicated.
@@ -2918,6 +6242,8 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                     ofd_array_add_string(result_html, Ofd_String_("</div>"));
                     // Output HTML. END
                 }
+                
+                if(!inline_the_block) ofd_end_trace_span("Code block", span_start, language, c - block_start);
                 // Handle a code block. END
             } break;
             
@@ -2948,7 +6274,7 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                     
                     // Output HTML. START
                     ofd_array_add_string(result_html, Ofd_String_("<div class='ofd-strike-through'>"));
-                    ofd_parse_markdown(text.data, text.data + text.count, result_html, result_sections, link_references, next_section_id, log_data);
+                    ofd_parse_markdown(text.data, text.data + text.count, result_html, result_code_blocks, result_sections, section_strings, link_references, next_section_id, arena, log_data);
                     ofd_array_add_string(result_html, Ofd_String_("</div>"));
                     // Output HTML. END
                     // Handle strike-through. END
@@ -3048,6 +6374,9 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                     // Handle a quote. START
                     OFD_SPILL_TEXT();
                     
+                    ofd_f64 span_start  = ofd_begin_trace_span();
+                    char*   block_start = c;
+                    
                     tmp_c++;
                     Ofd_String whitespace = {tmp_c, c - tmp_c};
                     
@@ -3072,7 +6401,7 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                         
                         // Parse quote data.
                         ofd_array_add_string(result_html, Ofd_String_("<div class='ofd-quote-line'>"));
-                        ofd_parse_markdown(tmp_c, line_end, result_html, result_sections, link_references, next_section_id, log_data);
+                        ofd_parse_markdown(tmp_c, line_end, result_html, result_code_blocks, result_sections, section_strings, link_references, next_section_id, arena, log_data);
                         ofd_array_add_string(result_html, Ofd_String_("</div>"));
                         ////////////////////
                         
@@ -3102,6 +6431,7 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                     }
                     
                     ofd_array_add_string(result_html, Ofd_String_("</div>"));
+                    ofd_end_trace_span("Quote", span_start, Ofd_String_(""), tmp_c - block_start);
                     // Handle a quote. END
                     
                     c = tmp_c;
@@ -3169,7 +6499,7 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                     ofd_sprintf(buffer, "<div class='ofd-emphasis-%d'>", emphasis_level);
                     
                     ofd_array_add_string(result_html, Ofd_String_(buffer));
-                    ofd_parse_markdown(text.data, text.data + text.count, result_html, result_sections, link_references, next_section_id, log_data);
+                    ofd_parse_markdown(text.data, text.data + text.count, result_html, result_code_blocks, result_sections, section_strings, link_references, next_section_id, arena, log_data);
                     ofd_array_add_string(result_html, Ofd_String_("</div>"));
                     // Output HTML. END
                     // Handle emphasis. END
@@ -3207,6 +6537,9 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                 tmp_c++;
                 
                 // Handle an unordered list. START
+                ofd_f64 span_start  = ofd_begin_trace_span();
+                char*   block_start = tmp_c;
+                
                 if(basic_text.count && basic_text.data < tmp_c)
                 {
                     basic_text.count = tmp_c - basic_text.data;
@@ -3216,7 +6549,8 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                 
                 
                 Ofd_Array whitespaces;
-                ofd_array_init(&whitespaces, sizeof(Ofd_String));
+                ofd_array_init_in_arena(&whitespaces, sizeof(Ofd_String), arena);
+                whitespaces.allocation_tag = OFD_ALLOCATION_LIST_WHITESPACE;
                 
                 Ofd_String* current_whitespace = ofd_array_add_fast(&whitespaces);
                 current_whitespace->data  = tmp_c;
@@ -3260,7 +6594,7 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                     text.count = c - text.data;
                     
                     
-                    ofd_parse_markdown(text.data, text.data + text.count, result_html, result_sections, link_references, next_section_id, log_data);
+                    ofd_parse_markdown(text.data, text.data + text.count, result_html, result_code_blocks, result_sections, section_strings, link_references, next_section_id, arena, log_data);
                     ofd_array_add_string(result_html, Ofd_String_("</li>"));
                     
                     if(c == limit) break;
@@ -3317,6 +6651,8 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                 
                 for(int i = 0; i < whitespaces.count; i++) ofd_array_add_string(result_html, Ofd_String_("</ul>"));
                 ofd_free_array(&whitespaces);
+                
+                ofd_end_trace_span("Unordered list", span_start, Ofd_String_(""), c - block_start);
                 // Handle an unordered list. END
             } break;
             
@@ -3346,6 +6682,9 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                 tmp_c++;
                 
                 // Handle an ordered list. START
+                ofd_f64 span_start  = ofd_begin_trace_span();
+                char*   block_start = tmp_c;
+                
                 if(basic_text.count && basic_text.data < tmp_c)
                 {
                     basic_text.count = tmp_c - basic_text.data;
@@ -3354,7 +6693,8 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                 else basic_text.count = 0;
                 
                 Ofd_Array whitespaces;
-                ofd_array_init(&whitespaces, sizeof(Ofd_String));
+                ofd_array_init_in_arena(&whitespaces, sizeof(Ofd_String), arena);
+                whitespaces.allocation_tag = OFD_ALLOCATION_LIST_WHITESPACE;
                 
                 Ofd_String* current_whitespace = ofd_array_add_fast(&whitespaces);
                 current_whitespace->data  = tmp_c;
@@ -3376,7 +6716,7 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                     text.count = c - text.data;
                     
                     ofd_array_add_string(result_html, Ofd_String_("<li>"));
-                    ofd_parse_markdown(text.data, text.data + text.count, result_html, result_sections, link_references, next_section_id, log_data);
+                    ofd_parse_markdown(text.data, text.data + text.count, result_html, result_code_blocks, result_sections, section_strings, link_references, next_section_id, arena, log_data);
                     ofd_array_add_string(result_html, Ofd_String_("</li>"));
                     
                     if(c == limit) break;
@@ -3448,6 +6788,8 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                 
                 for(int i = 0; i < whitespaces.count; i++) ofd_array_add_string(result_html, Ofd_String_("</ol>"));
                 ofd_free_array(&whitespaces);
+                
+                ofd_end_trace_span("Ordered list", span_start, Ofd_String_(""), c - block_start);
                 // Handle an ordered list. END
             } break;
             
@@ -3461,186 +6803,46 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                 char* original_c = c;
                 
                 // Check if this is a link reference. START
-                char* tmp_c = c;
-                tmp_c++;
-                link_name.data = tmp_c;
-                
-                while(tmp_c < limit)
+                Ofd_Link_Reference definition;
+                char* tmp_c = ofd_parse_link_reference(c, limit, &definition, arena);
+                if(tmp_c)
                 {
-                    char character = *tmp_c;
-                    if(character == ']') break;
-                    tmp_c++;
-                }
-                
-                link_name.count = tmp_c - link_name.data;
-                if(tmp_c + 1 < limit && tmp_c[1] == ':')
-                { // We assume this is a reference.
-                    // Parse a link reference. START
                     OFD_SPILL_TEXT();
                     
-                    link_address.count = 0;
-                    link_title.count   = 0;
-                    ofd_array_init(&additional_css, 1);
-                    
-                    c = tmp_c;
-                    c += 2; // Skip ']:'.
-                    c = ofd_skip_whitespace(c, limit);
-                    
-                    // Retrieve the address. START
-                    link_address.data = c;
-                    while(c < limit)
+                    // References were already gathered by ofd_find_link_references(), we only have to check that this is the definition that was kept.
+                    Ofd_Link_Reference* reference = ofd_find_link_reference(link_references, definition.id);
+                    if(!reference)
                     {
-                        char character = *c;
-                        if(character == ' ' || character == '\t' || character == '\n' || character == '\r') break;
-                        c++;
+                        ofd_add_link_reference(link_references, definition);
                     }
-                    
-                    link_address.count = c - link_address.data;
-                    // Retrieve the address. END
-                    
-                    c = ofd_skip_whitespace(c, limit);
-                    
-                    while(c < limit)
+                    else if(reference->id.data != definition.id.data)
                     {
-                        char character = *c;
-                        if(character == '\n' || character == '\r') break;
-                        
-                        if(character == '"')
-                        {
-                            // Parse a link title. START
-                            c++;
-                            link_title.data = c;
-                            while(c < limit)
-                            {
-                                character = *c;
-                                if(character == '\n' || character == '\r' || character == '"') break;
-                                c++;
-                            }
-                            
-                            link_title.count = c - link_title.data;
-                            if(c < limit && *c =='"') c++;
-                            // Parse a link title. END
-                            
-                            continue;
-                        }
+                        // This reference already exists. START
+                        char c_ref_id[128];
+                        ofd_to_c_string(definition.id, c_ref_id);
                         
-                        if(character == 'w' || character == 'h' || character == 'r')
-                        {
-                            // Parse additional CSS. START
-                            char original_character = character;
-                            
-                            while(c < limit)
-                            {
-                                character = *c;
-                                if(character == '"' || character == '\n' || character == '\r') break;
-                                c++;
-                            }
-                            
-                            if(c == limit) break;
-                            
-                            if(*c == '"')
-                            {
-                                c++;
-                                Ofd_String css = {c};
-                                while(c < limit)
-                                {
-                                    character = *c;
-                                    if(character == '"' || character == '\n' || character == '\r') break;
-                                    c++;
-                                }
-                                
-                                if(c == limit) break;
-                                
-                                if(*c == '"')
-                                {
-                                    css.count = c - css.data;
-                                    switch(original_character)
-                                    {
-                                        case 'w':
-                                        {
-                                            ofd_array_add_string(&additional_css, Ofd_String_("width:"));
-                                        } break;
-                                        
-                                        case 'h':
-                                        {
-                                            ofd_array_add_string(&additional_css, Ofd_String_("height:"));
-                                        } break;
-                                        
-                                        case 'r':
-                                        {
-                                            ofd_array_add_string(&additional_css, Ofd_String_("border-radius:"));
-                                        } break;
-                                    }
-                                    
-                                    ofd_array_add_string(&additional_css, css);
-                                    ofd_array_add_string(&additional_css, Ofd_String_(";"));
-                                    
-                                    c++;
-                                    continue;
-                                }
-                            }
-                            // Parse additional CSS. END
-                        }
+                        char tmp_buffer[512];
+                        ofd_sprintf(tmp_buffer, "A link/image reference named '%s' already exists.", c_ref_id);
                         
-                        c++;
-                    }
-                    
-                    
-                    ofd_b8 this_reference_exists = ofd_false;
-                    for(int i = 0; i < link_references->count; i++)
-                    {
-                        Ofd_Link_Reference* ref = ofd_cast(link_references->data, Ofd_Link_Reference*) + i;
-                        if(ofd_strings_match(ref->id, link_name))
-                        {
-                            // This reference already exists. START
-                            char c_ref_id[128];
-                            ofd_to_c_string(link_name, c_ref_id);
-                            
-                            char tmp_buffer[512];
-                            ofd_sprintf(tmp_buffer, "A link/image reference named '%s' already exists.", c_ref_id);
-                            
-                            Ofd_String line_view = ofd_get_line_view(original_c, lower_limit, limit);
-                            ofd_log_error(log_data, line_view, Ofd_String_(tmp_buffer));
-                            
-                            this_reference_exists = ofd_true;
-                            // This reference already exists. END
-                            
-                            break;
-                        }
-                    }
-                    
-                    if(!this_reference_exists)
-                    {
-                        Ofd_Link_Reference* reference = ofd_array_add_fast(link_references);
-                        reference->id             = link_name;
-                        reference->link_address   = link_address;
-                        reference->link_title     = link_title;
-                        reference->additional_css = additional_css;
-                    }
-                    
-                    c = ofd_skip_whitespace(c, limit);
-                    if(c < limit)
-                    { // Skip new line.
-                        if(*c == '\n')
-                        {
-                            c++;
-                            if(c < limit && *c == '\r') c++;
-                        }
-                        else if(*c == '\r') c++;
+                        Ofd_String line_view = ofd_get_line_view(original_c, lower_limit, limit);
+                        ofd_log_error(log_data, line_view, Ofd_String_(tmp_buffer));
+                        // This reference already exists. END
                     }
-                    // Parse a link reference. END
                     
+                    c = tmp_c;
                     break;
                 }
                 // Check if this is a link reference. END
                 
                 
                 tmp_c = c;
-                tmp_c = ofd_parse_link(tmp_c, limit, link_references, &link_name, &link_address, &link_title, &additional_css, log_data);
+                tmp_c = ofd_parse_link(tmp_c, limit, link_references, &link_name, &link_address, &link_title, &additional_css, arena, log_data);
                 if(tmp_c)
                 { // This is definitely a link.
                     OFD_SPILL_TEXT();
                     
+                    ofd_free_array(&additional_css); // Regular links do not use additional CSS.
+                    
                     // Output HTML. START
                     ofd_b8 this_is_an_external_link = ofd_true;
                     if(!link_address.count || link_address.data[0] == '#' | link_address.data[0] == '/') this_is_an_external_link = ofd_false;
@@ -3664,11 +6866,9 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                     
                     ofd_array_add_string(result_html, Ofd_String_("'>"));
                     
-                    ofd_parse_markdown(link_name.data, link_name.data + link_name.count, result_html, result_sections, link_references, next_section_id, log_data);
+                    ofd_parse_markdown(link_name.data, link_name.data + link_name.count, result_html, result_code_blocks, result_sections, section_strings, link_references, next_section_id, arena, log_data);
                     
                     ofd_array_add_string(result_html, Ofd_String_("</a>"));
-                    
-                    ofd_free(additional_css.data); // Just in case.
                     // Output HTML. END
                     
                     c = tmp_c;
@@ -3692,7 +6892,7 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                     Ofd_String image_name, image_address, image_title;
                     Ofd_Array additional_css;
                     
-                    tmp_c = ofd_parse_link(tmp_c, limit, link_references, &image_name, &image_address, &image_title, &additional_css, log_data);
+                    tmp_c = ofd_parse_link(tmp_c, limit, link_references, &image_name, &image_address, &image_title, &additional_css, arena, log_data);
                     if(tmp_c)
                     { // This is definitely an image.
                         // Output HTML. START
@@ -3707,16 +6907,16 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                             
                             Ofd_String css = {additional_css.data, additional_css.count};
                             ofd_array_add_string(result_html, css);
-                            
-                            ofd_free(additional_css.data);
                         }
                         
+                        ofd_free_array(&additional_css);
+                        
                         ofd_array_add_string(result_html, Ofd_String_("' />"));
                         
                         if(image_title.count)
                         {
                             ofd_array_add_string(result_html, Ofd_String_("<div class='ofd-image-title'>"));
-                            ofd_parse_markdown(image_title.data, image_title.data + image_title.count, result_html, result_sections, link_references, next_section_id, log_data);
+                            ofd_parse_markdown(image_title.data, image_title.data + image_title.count, result_html, result_code_blocks, result_sections, section_strings, link_references, next_section_id, arena, log_data);
                             ofd_array_add_string(result_html, Ofd_String_("</div>"));
                         }
                         
@@ -3744,6 +6944,9 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                 // Handle a table. START
                 OFD_SPILL_TEXT();
                 
+                ofd_f64 span_start  = ofd_begin_trace_span();
+                char*   block_start = c;
+                
                 ofd_array_add_string(result_html, Ofd_String_("<div class='ofd-table-wrapper'><table class='ofd-table'>"));
                 
                 while(c < limit)
@@ -3782,7 +6985,7 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                         cell_content_limit++;
                         ////////////////////////////////
                         
-                        ofd_parse_markdown(c, cell_content_limit, result_html, result_sections, link_references, next_section_id, log_data);
+                        ofd_parse_markdown(c, cell_content_limit, result_html, result_code_blocks, result_sections, section_strings, link_references, next_section_id, arena, log_data);
                         ofd_array_add_string(result_html, Ofd_String_("</td>"));
                         
                         c = cell_limit;
@@ -3813,6 +7016,7 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                 }
                 
                 ofd_array_add_string(result_html, Ofd_String_("</table></div>"));
+                ofd_end_trace_span("Table", span_start, Ofd_String_(""), c - block_start);
                 // Handle a table. END
             } break;
             
@@ -3850,8 +7054,10 @@ ofd_static void ofd_parse_markdown(char* c, char* limit, Ofd_Array* result_html,
                 
                 if(!basic_text.count) basic_text.data = c;
                 
-                basic_text.count++;
-                c++;
+                // Take this character and all the plain text that follows it at once.
+                char* plain_text_end = ofd_find_markdown_special_character(c + 1, limit);
+                basic_text.count += plain_text_end - c;
+                c = plain_text_end;
             } break;
         }
     }
@@ -4117,121 +7323,1083 @@ ofd_static ofd_b8 ofd_parse_fields(char* data, int data_size, Ofd_Field* fields,
         }
         
         
-        // Skip new lines.
-        while(c < limit)
+        // Skip new lines.
+        while(c < limit)
+        {
+            if(*c != '\n' && *c !='\r') break;
+            c++;
+        }
+        //////////////////
+    }
+    
+    
+    return ofd_true;
+}
+
+ofd_static ofd_b8 ofd_parse_theme_data(char* theme_data, int theme_data_size, Ofd_Theme* result, char* error_message)
+{
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: on success this returns ofd_true and ofd_false otherwise. Error messages are written to error_message.
+    // Note that the resulting theme is not initialised here, which means you can provide a default theme and only fields specified in theme_data
+    // will be changed.
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    const int OFD_BACKGROUND_COLOUR              = 0x01;
+    const int OFD_TEXT_COLOUR                    = 0x02;
+    const int OFD_CODE_BLOCK_BACKGROUND_COLOUR   = 0x04;
+    const int OFD_CODE_BLOCK_TEXT_COLOUR         = 0x08;
+    const int OFD_LINK_COLOUR                    = 0x10;
+    const int OFD_IMAGE_TITLE_COLOUR             = 0x20;
+    const int OFD_HORIZONTAL_RULE_COLOUR         = 0x40;
+    const int OFD_QUOTE_BACKGROUND_COLOUR        = 0x80;
+    const int OFD_QUOTE_TEXT_COLOUR              = 0x100;
+    const int OFD_SECTION_LINK_TEXT_COLOUR       = 0x200;
+    const int OFD_SECTION_LINK_BACKGROUND_COLOUR = 0x400;
+    const int OFD_SEPARATOR_COLOUR               = 0x800;
+    const int OFD_SCROLLBAR_COLOUR               = 0x1000;
+    const int OFD_FONT_SIZE                      = 0x2000;
+    
+    const int OFD_SYNTAX_COMMENT_COLOUR   = 0x4000;
+    const int OFD_SYNTAX_STRING_COLOUR    = 0x8000;
+    const int OFD_SYNTAX_NUMBER_COLOUR    = 0x10000;
+    const int OFD_SYNTAX_STRUCTURE_COLOUR = 0x20000;
+    const int OFD_SYNTAX_KEYWORD_COLOUR   = 0x40000;
+    const int OFD_SYNTAX_DIRECTIVE_COLOUR = 0x80000;
+    
+    Ofd_Field fields[] = {
+        {OFD_BACKGROUND_COLOUR,              "background_colour",              &result->background_colour,              OFD_FIELD_COLOUR},
+        {OFD_TEXT_COLOUR,                    "text_colour",                    &result->text_colour,                    OFD_FIELD_COLOUR},
+        {OFD_CODE_BLOCK_BACKGROUND_COLOUR,   "code_block_background_colour",   &result->code_block_background_colour,   OFD_FIELD_COLOUR},
+        {OFD_CODE_BLOCK_TEXT_COLOUR,         "code_block_text_colour",         &result->code_block_text_colour,         OFD_FIELD_COLOUR},
+        {OFD_LINK_COLOUR,                    "link_colour",                    &result->link_colour,                    OFD_FIELD_COLOUR},
+        {OFD_IMAGE_TITLE_COLOUR,             "image_title_colour",             &result->image_title_colour,             OFD_FIELD_COLOUR},
+        {OFD_HORIZONTAL_RULE_COLOUR,         "horizontal_rule_colour",         &result->horizontal_rule_colour,         OFD_FIELD_COLOUR},
+        {OFD_QUOTE_BACKGROUND_COLOUR,        "quote_background_colour",        &result->quote_background_colour,        OFD_FIELD_COLOUR},
+        {OFD_QUOTE_TEXT_COLOUR,              "quote_text_colour",              &result->quote_text_colour,              OFD_FIELD_COLOUR},
+        {OFD_SECTION_LINK_TEXT_COLOUR,       "section_link_text_colour",       &result->section_link_text_colour,       OFD_FIELD_COLOUR},
+        {OFD_SECTION_LINK_BACKGROUND_COLOUR, "section_link_background_colour", &result->section_link_background_colour, OFD_FIELD_COLOUR},
+        {OFD_SEPARATOR_COLOUR,               "separator_colour",               &result->separator_colour,               OFD_FIELD_COLOUR},
+        {OFD_SCROLLBAR_COLOUR,               "scrollbar_colour",               &result->scrollbar_colour,               OFD_FIELD_COLOUR},
+        {OFD_FONT_SIZE,                      "font_size",                      &result->font_size,                      OFD_FIELD_F32},
+        
+        {OFD_SYNTAX_COMMENT_COLOUR,          "syntax_comment_colour",          &result->syntax_comment_colour,          OFD_FIELD_COLOUR},
+        {OFD_SYNTAX_STRING_COLOUR,           "syntax_string_colour",           &result->syntax_string_colour,           OFD_FIELD_COLOUR},
+        {OFD_SYNTAX_NUMBER_COLOUR,           "syntax_number_colour",           &result->syntax_number_colour,           OFD_FIELD_COLOUR},
+        {OFD_SYNTAX_STRUCTURE_COLOUR,        "syntax_structure_colour",        &result->syntax_structure_colour,        OFD_FIELD_COLOUR},
+        {OFD_SYNTAX_KEYWORD_COLOUR,          "syntax_keyword_colour",          &result->syntax_keyword_colour,          OFD_FIELD_COLOUR},
+        {OFD_SYNTAX_DIRECTIVE_COLOUR,        "syntax_directive_colour",        &result->syntax_directive_colour,        OFD_FIELD_COLOUR},
+    };
+    
+    
+    return ofd_parse_fields(theme_data, theme_data_size, fields, ofd_array_count(fields), error_message);
+}
+
+
+ofd_static ofd_b8 ofd_parse_configuration_data(char* data, int data_size, Ofd_Config* result, char* error_message)
+{
+    const int OUTPUT_FIELD = 0x01;
+    const int THEME_FIELD  = 0x02;
+    const int LOGO_FIELD   = 0x04;
+    const int ICON_FIELD   = 0x08;
+    const int TITLE_FIELD     = 0x10;
+    const int LANGUAGES_FIELD = 0x20;
+    
+    Ofd_Field fields[] = {
+        {OUTPUT_FIELD,    "output",    &result->output_filepath,    OFD_FIELD_STRING},
+        {THEME_FIELD,     "theme",     &result->theme_filepath,     OFD_FIELD_STRING},
+        {LOGO_FIELD,      "logo",      &result->logo_path,          OFD_FIELD_STRING},
+        {ICON_FIELD,      "icon",      &result->icon_path,          OFD_FIELD_STRING},
+        {TITLE_FIELD,     "title",     &result->title,              OFD_FIELD_STRING},
+        {LANGUAGES_FIELD, "languages", &result->language_filepaths, OFD_FIELD_STRING},
+    };
+    
+    return ofd_parse_fields(data, data_size, fields, ofd_array_count(fields), error_message);
+}
+
+
+ofd_static Ofd_String ofd_get_next_word(char** c, char* limit)
+{
+    // NOTE: this skips spaces and tabs then returns what comes before the next one. The result is empty when we reach limit.
+    
+    char* at = ofd_skip_whitespace(*c, limit);
+    
+    Ofd_String word = {at};
+    while(at < limit && *at != ' ' && *at != '\t') at++;
+    
+    word.count = at - word.data;
+    *c = at;
+    
+    return word;
+}
+
+ofd_static Ofd_String ofd_get_next_filepath(char** c, char* limit)
+{
+    // NOTE: same as ofd_get_next_word() but a filepath wrapped in single quotes can contain spaces, e.g. 'my languages/lua.txt'.
+    // The quotes are not part of the result.
+    
+    char* at = ofd_skip_whitespace(*c, limit);
+    if(at == limit || *at != '\'') return ofd_get_next_word(c, limit);
+    
+    at++;
+    Ofd_String filepath = {at};
+    while(at < limit && *at != '\'') at++;
+    
+    filepath.count = at - filepath.data;
+    *c = at < limit ? at + 1 : at;
+    
+    return filepath;
+}
+
+ofd_static ofd_b8 ofd_parse_language_definition(char* data, int data_size, Ofd_Language* result, char* error_message)
+{
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: on success this returns ofd_true and ofd_false otherwise. Error messages are written to error_message.
+    // result only needs to be registered afterwards: ofd_register_language() builds its character classes and keyword set once, so the
+    // language is highlighted by the same tables and state machine as the built-in ones.
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    const int ALIASES_FIELD                  = 0x01;
+    const int SINGLE_LINE_COMMENT_FIELD      = 0x02;
+    const int MULTI_LINE_COMMENT_START_FIELD = 0x04;
+    const int MULTI_LINE_COMMENT_END_FIELD   = 0x08;
+    const int NESTED_COMMENTS_FIELD          = 0x10;
+    const int STRINGS_FIELD                  = 0x20;
+    const int NUMBER_CHARACTERS_FIELD        = 0x40;
+    const int DIRECTIVES_FIELD               = 0x80;
+    const int KEYWORDS_FIELD                 = 0x100;
+    
+    Ofd_Language empty_language = {0};
+    *result = empty_language;
+    
+    Ofd_String aliases         = {0};
+    Ofd_String strings         = Ofd_String_("double_quotes single_quotes");
+    Ofd_String keywords        = {0};
+    ofd_f32    nested_comments = 0;
+    ofd_f32    directives      = 1;
+    
+    Ofd_Field fields[] = {
+        {ALIASES_FIELD,                  "aliases",                  &aliases,                           OFD_FIELD_STRING},
+        {SINGLE_LINE_COMMENT_FIELD,      "single_line_comment",      &result->single_line_comment_start, OFD_FIELD_STRING},
+        {MULTI_LINE_COMMENT_START_FIELD, "multi_line_comment_start", &result->multi_line_comment_start,  OFD_FIELD_STRING},
+        {MULTI_LINE_COMMENT_END_FIELD,   "multi_line_comment_end",   &result->multi_line_comment_end,    OFD_FIELD_STRING},
+        {NESTED_COMMENTS_FIELD,          "nested_comments",          &nested_comments,                   OFD_FIELD_F32},
+        {STRINGS_FIELD,                  "strings",                  &strings,                           OFD_FIELD_STRING},
+        {NUMBER_CHARACTERS_FIELD,        "number_characters",        &result->number_characters,         OFD_FIELD_STRING},
+        {DIRECTIVES_FIELD,               "directives",               &directives,                        OFD_FIELD_F32},
+        {KEYWORDS_FIELD,                 "keywords",                 &keywords,                          OFD_FIELD_STRING},
+    };
+    
+    if(!ofd_parse_fields(data, data_size, fields, ofd_array_count(fields), error_message)) return ofd_false;
+    
+    
+    // Get aliases. START
+    int num_aliases = 0;
+    
+    char* c     = aliases.data;
+    char* limit = aliases.data + aliases.count;
+    while(ofd_true)
+    {
+        Ofd_String alias = ofd_get_next_word(&c, limit);
+        if(!alias.count) break;
+        
+        if(num_aliases == OFD_MAX_LANGUAGE_ALIASES)
+        {
+            ofd_sprintf(error_message, "A language cannot have more than %d aliases.", OFD_MAX_LANGUAGE_ALIASES);
+            return ofd_false;
+        }
+        
+        result->aliases[num_aliases] = alias;
+        num_aliases++;
+    }
+    
+    if(!num_aliases)
+    {
+        ofd_sprintf(error_message, "Field 'aliases' is missing, it is how code blocks pick the language.");
+        return ofd_false;
+    }
+    // Get aliases. END
+    
+    
+    // Get string delimiters. START
+    static const char* STRING_DELIMITERS = "\"'`";
+    ofd_b8 delimiters_are_used[3] = {ofd_false, ofd_false, ofd_false};
+    
+    c     = strings.data;
+    limit = strings.data + strings.count;
+    while(ofd_true)
+    {
+        Ofd_String word = ofd_get_next_word(&c, limit);
+        if(!word.count) break;
+        
+        if     (ofd_string_matches(word, "double_quotes")) delimiters_are_used[0] = ofd_true;
+        else if(ofd_string_matches(word, "single_quotes")) delimiters_are_used[1] = ofd_true;
+        else if(ofd_string_matches(word, "backticks"))     delimiters_are_used[2] = ofd_true;
+        else
+        {
+            char word_c_string[64];
+            word.count = ofd_min(word.count, ofd_array_count(word_c_string) - 1);
+            ofd_to_c_string(word, word_c_string);
+            ofd_sprintf(error_message, "Unknown kind of string '%s', use double_quotes, single_quotes or backticks.", word_c_string);
+            return ofd_false;
+        }
+    }
+    // Get string delimiters. END
+    
+    
+    // Get keywords. START
+    int num_keywords = 0;
+    
+    c     = keywords.data;
+    limit = keywords.data + keywords.count;
+    while(ofd_get_next_word(&c, limit).count) num_keywords++;
+    
+    // The delimiters go right after the keywords so that everything we allocate goes away with ofd_free_language_definition().
+    Ofd_String* keyword_strings = ofd_tagged_allocate(num_keywords * sizeof(Ofd_String) + ofd_array_count(delimiters_are_used), OFD_ALLOCATION_LANGUAGES);
+    char* delimiters            = ofd_cast(keyword_strings + num_keywords, char*);
+    
+    c = keywords.data;
+    for(int i = 0; i < num_keywords; i++) keyword_strings[i] = ofd_get_next_word(&c, limit);
+    
+    result->keywords     = keyword_strings;
+    result->num_keywords = num_keywords;
+    // Get keywords. END
+    
+    
+    result->string_delimiters.data = delimiters;
+    for(int i = 0; i < ofd_array_count(delimiters_are_used); i++)
+    {
+        if(delimiters_are_used[i]) result->string_delimiters.data[result->string_delimiters.count++] = STRING_DELIMITERS[i];
+    }
+    
+    int flags = 0;
+    if(nested_comments) flags |= OFD_SUPPORTS_NESTED_MULTI_LINE_COMMENTS;
+    if(!directives)     flags |= OFD_NO_DIRECTIVES;
+    result->flags = ofd_cast(flags, Ofd_Syntax_Flags);
+    
+    return ofd_true;
+}
+
+ofd_static void ofd_free_language_definition(Ofd_Language* language)
+{
+    ofd_tagged_free(ofd_cast(language->keywords, void*));
+    language->keywords     = NULL;
+    language->num_keywords = 0;
+}
+
+#ifndef OFD_NO_FILE_IO
+ofd_static ofd_b8 ofd_load_language_definition(char* filepath, char* error_message)
+{
+    Ofd_String data;
+    if(!ofd_read_whole_file(filepath, &data))
+    {
+        ofd_sprintf(error_message, "Could not read language definition '%s'.", filepath);
+        return ofd_false;
+    }
+    
+    Ofd_Language language;
+    if(!ofd_parse_language_definition(data.data, data.count, &language, error_message))
+    {
+        ofd_tagged_free(data.data);
+        return ofd_false;
+    }
+    
+    if(!ofd_register_language(&language))
+    {
+        ofd_sprintf(error_message, "Could not register the language from '%s', there cannot be more than %d languages.", filepath, OFD_MAX_LANGUAGES);
+        ofd_free_language_definition(&language);
+        ofd_tagged_free(data.data);
+        return ofd_false;
+    }
+    
+    return ofd_true;
+}
+#endif // OFD_NO_FILE_IO
+
+
+ofd_static void ofd_parse_markdown_file(Ofd_Markdown_File* file)
+{
+    //////////////////////////////////////////////////////////////////
+    // NOTE: file->arena and file->link_references must be initialised.
+    //////////////////////////////////////////////////////////////////
+    
+    ofd_array_init(&file->html,            1);
+    ofd_array_init(&file->code_blocks,     sizeof(Ofd_Code_Block));
+    ofd_array_init(&file->sections,        sizeof(Ofd_Section));
+    ofd_array_init(&file->section_strings, 1);
+    ofd_array_init(&file->log_data,        1);
+    
+    file->sections.allocation_tag        = OFD_ALLOCATION_SECTIONS;
+    file->section_strings.allocation_tag = OFD_ALLOCATION_SECTIONS;
+    
+    
+    Ofd_String filename = Ofd_String_(file->filepath);
+    filename = ofd_get_last_item_from_filepath(filename);
+    filename = ofd_strip_file_extension(filename);
+    filename.count = ofd_min(filename.count, OFD_MAX_SECTION_NAME_COUNT);
+    
+    Ofd_Section* section = ofd_add_section(&file->sections, &file->section_strings, filename, 0, 0, ofd_true);
+    Ofd_String section_id = ofd_get_section_string(&file->section_strings, section->full_id_offset, section->full_id_count);
+    
+    
+    ofd_array_add_string(&file->html, Ofd_String_("<div class='ofd-anchor' id='"));
+    ofd_array_add_string(&file->html, section_id);
+    ofd_array_add_string(&file->html, Ofd_String_("'></div>"));
+    
+    
+    file->num_section_ids = 1;
+    
+    ofd_parse_markdown(file->markdown.data, file->markdown.data + file->markdown.count, &file->html, &file->code_blocks, &file->sections, &file->section_strings, &file->link_references, &file->num_section_ids, &file->arena, &file->log_data);
+}
+
+typedef struct
+{
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: what the file cache keeps for a markdown file. This header is followed by the link reference definitions of the file (each is
+    // an Ofd_File_Cache_Definition followed by its additional CSS), the link reference IDs parsing looked up (each is its count as an
+    // ofd_u32 followed by the ID), the HTML with its code blocks highlighted, the sections, the section strings and the errors.
+    // references_hash is what ofd_hash_link_reference_lookup() made of the IDs when the file was parsed, the record is used while it
+    // still matches.
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    ofd_u64 references_hash;
+    ofd_u32 num_section_ids;
+    ofd_u32 num_code_blocks; // They come highlighted in the HTML, this is for the stats.
+    ofd_u32 num_definitions;
+    ofd_u32 definitions_size;
+    ofd_u32 lookups_size;
+    ofd_u32 html_size;
+    ofd_u32 sections_size;
+    ofd_u32 section_strings_size;
+    ofd_u32 log_size;
+} Ofd_File_Cache_Record;
+
+typedef struct
+{
+    ofd_u32 id_offset; // Offsets are into the markdown of the file.
+    ofd_u32 id_count;
+    ofd_u32 address_offset;
+    ofd_u32 address_count;
+    ofd_u32 title_offset;
+    ofd_u32 title_count;
+    ofd_u32 css_count;
+} Ofd_File_Cache_Definition;
+
+ofd_static ofd_u64 ofd_hash_link_reference_lookup(ofd_u64 hash, Ofd_Markdown_File* file, Ofd_String id)
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: this hashes what id resolves to among the references of every file, the parent of the table of file. That is all parsing sees
+    // of other files: the table of file only ever gets IDs its parent does not have. A definition found in file itself only depends on the
+    // content of file, so its offset is enough.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    Ofd_Link_Reference* reference = ofd_find_link_reference(file->link_references.parent, id);
+    
+    ofd_b8 is_in_file = (reference && reference->id.data >= file->markdown.data && reference->id.data < file->markdown.data + file->markdown.count);
+    
+    ofd_u32 header[3] = {ofd_cast(id.count, ofd_u32), 0, 0}; // The count of id, where it was found (0: nowhere, 1: in file, 2: in another file) and its offset.
+    if(reference) header[1] = is_in_file? 1 : 2;
+    if(is_in_file) header[2] = ofd_cast(reference->id.data - file->markdown.data, ofd_u32);
+    
+    hash = ofd_hash_64(hash, header, sizeof(header));
+    hash = ofd_hash_64(hash, id.data, id.count);
+    
+    if(reference && !is_in_file)
+    {
+        hash = ofd_hash_64(hash, reference->link_address.data, reference->link_address.count);
+        hash = ofd_hash_64(hash, "", 1);
+        hash = ofd_hash_64(hash, reference->link_title.data, reference->link_title.count);
+        hash = ofd_hash_64(hash, "", 1);
+        hash = ofd_hash_64(hash, reference->additional_css.data, reference->additional_css.count);
+    }
+    
+    return hash;
+}
+
+ofd_static ofd_b8 ofd_range_is_inside(ofd_u32 offset, ofd_u32 count, ofd_u32 size)
+{
+    return (offset <= size && count <= size - offset);
+}
+
+ofd_static ofd_b8 ofd_read_file_cache_record(Ofd_String blob, int markdown_count, Ofd_File_Cache_Record* result)
+{ // This checks that the record is whole and fits a markdown file of markdown_count bytes, the record can be trusted afterwards.
+    if(blob.count < ofd_cast(sizeof(*result), int)) return ofd_false;
+    ofd_copy(result, blob.data, sizeof(*result));
+    
+    ofd_u64 size = sizeof(*result) + ofd_cast(result->definitions_size, ofd_u64) + result->lookups_size + result->html_size + result->sections_size +
+                   result->section_strings_size + result->log_size;
+    if(size != ofd_cast(blob.count, ofd_u64) || result->sections_size % sizeof(Ofd_Section)) return ofd_false;
+    
+    
+    // Check the definitions. START
+    char* c     = blob.data + sizeof(*result);
+    char* limit = c + result->definitions_size;
+    
+    for(ofd_u32 i = 0; i < result->num_definitions; i++)
+    {
+        Ofd_File_Cache_Definition definition;
+        if(limit - c < ofd_cast(sizeof(definition), int)) return ofd_false;
+        
+        ofd_copy(&definition, c, sizeof(definition));
+        c += sizeof(definition);
+        
+        ofd_b8 is_valid = (ofd_range_is_inside(definition.id_offset,      definition.id_count,      markdown_count) &&
+                           ofd_range_is_inside(definition.address_offset, definition.address_count, markdown_count) &&
+                           ofd_range_is_inside(definition.title_offset,   definition.title_count,   markdown_count) &&
+                           definition.css_count <= ofd_cast(limit - c, ofd_u32));
+        if(!is_valid) return ofd_false;
+        
+        c += definition.css_count;
+    }
+    
+    if(c != limit) return ofd_false;
+    // Check the definitions. END
+    
+    
+    // Check the lookups. START
+    limit += result->lookups_size;
+    while(c < limit)
+    {
+        ofd_u32 count;
+        if(limit - c < ofd_cast(sizeof(count), int)) return ofd_false;
+        
+        ofd_copy(&count, c, sizeof(count));
+        c += sizeof(count);
+        
+        if(count > ofd_cast(limit - c, ofd_u32)) return ofd_false;
+        c += count;
+    }
+    // Check the lookups. END
+    
+    
+    // Check the sections. START
+    c += result->html_size;
+    
+    for(ofd_u32 i = 0; i < result->sections_size / sizeof(Ofd_Section); i++)
+    {
+        Ofd_Section section;
+        ofd_copy(&section, c + i * sizeof(Ofd_Section), sizeof(section));
+        
+        ofd_u32 strings_size = result->section_strings_size;
+        ofd_b8 is_valid = (ofd_range_is_inside(section.name_offset,    section.name_count,    strings_size) &&
+                           ofd_range_is_inside(section.id_offset,      section.id_count,      strings_size) &&
+                           ofd_range_is_inside(section.full_id_offset, section.full_id_count, strings_size));
+        if(!is_valid) return ofd_false;
+    }
+    // Check the sections. END
+    
+    return ofd_true;
+}
+
+ofd_static ofd_b8 ofd_load_file_from_cache(Ofd_Markdown_File* file)
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: this does what ofd_parse_markdown_file() and highlighting would have done from file->cache_record, unless a link reference the
+    // file looked up changed. The code blocks come highlighted in file->cached_html so file->html and file->code_blocks stay empty.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    Ofd_File_Cache_Record record;
+    ofd_copy(&record, file->cache_record.data, sizeof(record)); // ofd_find_file_in_cache() checked it.
+    
+    char* c     = file->cache_record.data + sizeof(record) + record.definitions_size;
+    char* limit = c + record.lookups_size;
+    
+    ofd_u64 references_hash = OFD_HASH_64_START;
+    while(c < limit)
+    {
+        ofd_u32 count;
+        ofd_copy(&count, c, sizeof(count));
+        c += sizeof(count);
+        
+        Ofd_String id = {c, ofd_cast(count, int)};
+        references_hash = ofd_hash_link_reference_lookup(references_hash, file, id);
+        c += count;
+    }
+    
+    if(references_hash != record.references_hash) return ofd_false;
+    
+    
+    ofd_array_init(&file->html,            1);
+    ofd_array_init(&file->code_blocks,     sizeof(Ofd_Code_Block));
+    ofd_array_init(&file->sections,        sizeof(Ofd_Section));
+    ofd_array_init(&file->section_strings, 1);
+    ofd_array_init(&file->log_data,        1);
+    
+    file->sections.allocation_tag        = OFD_ALLOCATION_SECTIONS;
+    file->section_strings.allocation_tag = OFD_ALLOCATION_SECTIONS;
+    
+    Ofd_String html            = {c,                                            ofd_cast(record.html_size,            int)};
+    Ofd_String sections        = {html.data + html.count,                       ofd_cast(record.sections_size,        int)};
+    Ofd_String section_strings = {sections.data + sections.count,               ofd_cast(record.section_strings_size, int)};
+    Ofd_String log_data        = {section_strings.data + section_strings.count, ofd_cast(record.log_size,             int)};
+    
+    file->cached_html = html;
+    ofd_array_add_string(&file->section_strings, section_strings);
+    ofd_array_add_string(&file->log_data,        log_data);
+    
+    void* section_memory = ofd_array_add_fast_multiple(&file->sections, sections.count / sizeof(Ofd_Section));
+    ofd_copy(section_memory, sections.data, sections.count);
+    
+    file->num_section_ids = record.num_section_ids;
+    return ofd_true;
+}
+
+ofd_static void ofd_parse_or_load_markdown_file(Ofd_Markdown_File* file)
+{ // Files the file cache had are loaded from it, the others are parsed.
+    if(file->cache_record.data && ofd_load_file_from_cache(file)) return;
+    
+    Ofd_String no_record = {0};
+    file->cache_record = no_record;
+    
+    #ifndef OFD_NO_FILE_IO
+    if(ofd_file_cache.is_open)
+    {
+        ofd_array_init_in_arena(&file->lookups, sizeof(Ofd_String), &file->arena);
+        file->link_references.lookups = &file->lookups;
+    }
+    #endif // OFD_NO_FILE_IO
+    
+    ofd_parse_markdown_file(file);
+}
+
+#ifndef OFD_NO_FILE_IO
+ofd_static void ofd_get_file_cache_key(Ofd_Markdown_File* file, ofd_u64* result)
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: like the highlight cache key, one pass of ofd_hash_128() over the file since this runs on every file of every build. The
+    // name of the file is in there because it names the first section, the languages because code blocks come highlighted.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    ofd_u64 header[2] = {ofd_cast(OFD_PARSER_VERSION, ofd_u64) << 32 | OFD_HIGHLIGHTER_VERSION, ofd_cast(file->markdown.count, ofd_u32)};
+    #ifndef OFD_COMPACT_SYNTAX_MARKUP
+    header[1] |= 1ull << 63;
+    #endif
+    
+    Ofd_String filename = ofd_get_last_item_from_filepath(Ofd_String_(file->filepath));
+    Ofd_Language_Registry* registry = &ofd_language_registry;
+    
+    result[0] = OFD_HASH_128_START_0;
+    result[1] = OFD_HASH_128_START_1;
+    ofd_mix_hash_128(result, header[0], header[1]);
+    ofd_hash_128(result, filename.data, filename.count);
+    
+    for(int language_index = 0; language_index < registry->num_languages; language_index++)
+    {
+        ofd_mix_hash_128(result, registry->languages[language_index].definition_hash, language_index);
+    }
+    
+    ofd_hash_128(result, file->markdown.data, file->markdown.count);
+}
+
+ofd_static ofd_b8 ofd_find_file_in_cache(Ofd_Markdown_File* file)
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: this sets file->cache_key, and file->cache_record if the file cache has the file. The link reference definitions of file
+    // then come from the record instead of ofd_find_link_references(). file->link_references must be initialised.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    ofd_get_file_cache_key(file, file->cache_key);
+    
+    Ofd_String blob;
+    Ofd_File_Cache_Record record;
+    if(!ofd_get_from_cache(&ofd_file_cache, file->cache_key, &blob) || !ofd_read_file_cache_record(blob, file->markdown.count, &record)) return ofd_false;
+    
+    char* c = blob.data + sizeof(record);
+    for(ofd_u32 i = 0; i < record.num_definitions; i++)
+    {
+        Ofd_File_Cache_Definition definition;
+        ofd_copy(&definition, c, sizeof(definition));
+        c += sizeof(definition);
+        
+        Ofd_Link_Reference reference;
+        reference.id.data            = file->markdown.data + definition.id_offset;
+        reference.id.count           = definition.id_count;
+        reference.link_address.data  = file->markdown.data + definition.address_offset;
+        reference.link_address.count = definition.address_count;
+        reference.link_title.data    = file->markdown.data + definition.title_offset;
+        reference.link_title.count   = definition.title_count;
+        
+        ofd_array_init_in_arena(&reference.additional_css, 1, &file->arena);
+        reference.additional_css.allocation_tag = OFD_ALLOCATION_LINK_CSS;
+        
+        Ofd_String css = {c, ofd_cast(definition.css_count, int)};
+        ofd_array_add_string(&reference.additional_css, css);
+        c += definition.css_count;
+        
+        ofd_add_link_reference(&file->link_references, reference);
+    }
+    
+    file->cache_record = blob;
+    return ofd_true;
+}
+
+ofd_static void ofd_add_file_to_cache(Ofd_Markdown_File* file)
+{ // The code blocks of file must be highlighted, and its sections and lookups not freed yet.
+    Ofd_Array data;
+    ofd_array_init(&data, 1);
+    data.allocation_tag = OFD_ALLOCATION_FILE_CACHE;
+    
+    Ofd_File_Cache_Record record = {0};
+    ofd_array_add_fast_multiple(&data, sizeof(record)); // Written once the sizes are known.
+    
+    
+    // Add the definitions. START
+    for(int i = 0; i < file->definitions.count; i++)
+    {
+        Ofd_Link_Reference* reference = ofd_cast(file->definitions.data, Ofd_Link_Reference*) + i;
+        
+        Ofd_File_Cache_Definition definition;
+        definition.id_offset      = ofd_cast(reference->id.data - file->markdown.data, ofd_u32);
+        definition.id_count       = reference->id.count;
+        definition.address_offset = ofd_cast(reference->link_address.data - file->markdown.data, ofd_u32);
+        definition.address_count  = reference->link_address.count;
+        definition.title_offset   = reference->link_title.count? ofd_cast(reference->link_title.data - file->markdown.data, ofd_u32) : 0; // data is not set without a title.
+        definition.title_count    = reference->link_title.count;
+        definition.css_count      = reference->additional_css.count;
+        
+        Ofd_String definition_data = {ofd_cast(&definition, char*), sizeof(definition)};
+        Ofd_String css             = {reference->additional_css.data, reference->additional_css.count};
+        ofd_array_add_string(&data, definition_data);
+        ofd_array_add_string(&data, css);
+    }
+    
+    record.num_code_blocks  = file->code_blocks.count;
+    record.num_definitions  = file->definitions.count;
+    record.definitions_size = data.count - sizeof(record);
+    // Add the definitions. END
+    
+    
+    // Add the lookups. START
+    int lookups_start = data.count;
+    
+    record.references_hash = OFD_HASH_64_START;
+    for(int i = 0; i < file->lookups.count; i++)
+    {
+        Ofd_String id = ofd_cast(file->lookups.data, Ofd_String*)[i];
+        record.references_hash = ofd_hash_link_reference_lookup(record.references_hash, file, id);
+        
+        ofd_u32 count = id.count;
+        Ofd_String count_data = {ofd_cast(&count, char*), sizeof(count)};
+        ofd_array_add_string(&data, count_data);
+        ofd_array_add_string(&data, id);
+    }
+    
+    record.lookups_size = data.count - lookups_start;
+    // Add the lookups. END
+    
+    
+    // Add the HTML. START
+    int html_start  = data.count;
+    int html_offset = 0;
+    for(int i = 0; i < file->code_blocks.count; i++)
+    { // The highlighted code blocks go back where they belong, like ofd_write_markdown_file_html() does.
+        Ofd_Code_Block* code_block = ofd_cast(file->code_blocks.data, Ofd_Code_Block*) + i;
+        
+        Ofd_String html_before = {file->html.data + html_offset, code_block->html_offset - html_offset};
+        Ofd_String code_html   = {code_block->html.data, code_block->html.count};
+        ofd_array_add_string(&data, html_before);
+        ofd_array_add_string(&data, code_html);
+        
+        html_offset = code_block->html_offset;
+    }
+    
+    Ofd_String html_after = {file->html.data + html_offset, file->html.count - html_offset};
+    ofd_array_add_string(&data, html_after);
+    
+    record.html_size = data.count - html_start;
+    // Add the HTML. END
+    
+    
+    Ofd_String sections = {file->sections.data, file->sections.count * ofd_cast(sizeof(Ofd_Section), int)};
+    ofd_array_add_string(&data, sections);
+    ofd_array_add_array(&data, &file->section_strings);
+    ofd_array_add_array(&data, &file->log_data);
+    
+    record.num_section_ids      = file->num_section_ids;
+    record.sections_size        = sections.count;
+    record.section_strings_size = file->section_strings.count;
+    record.log_size             = file->log_data.count;
+    
+    ofd_copy(data.data, &record, sizeof(record));
+    
+    Ofd_String blob = {data.data, data.count};
+    ofd_add_to_cache(&ofd_file_cache, file->cache_key, blob);
+    
+    ofd_free_array(&data);
+}
+#endif // OFD_NO_FILE_IO
+
+static char* ofd_stats_phase_names[OFD_STATS_PHASE_COUNT] = {"Load", "CSS", "Link references", "Parse", "Highlight", "Stitch", "Sidebar", "Write"};
+
+#ifdef OFD_ALLOCATION_STATS
+static char* ofd_allocation_tag_names[OFD_ALLOCATION_TAG_COUNT] = {"Arrays", "Filter", "Link CSS", "List whitespace", "Sections", "Arenas", "Files", "Highlight cache", "File cache", "Languages"};
+#endif
+
+static Ofd_Stats* ofd_stats; // NULL while stats are off.
+
+ofd_static void ofd_begin_stats(Ofd_Stats* stats)
+{
+    Ofd_Stats empty_stats = {0};
+    *stats = empty_stats;
+    ofd_array_init(&stats->files, sizeof(Ofd_File_Stats));
+    
+    ofd_reset_allocation_stats();
+    ofd_count_allocations(ofd_true);
+    
+    for(int i = 0; i < OFD_HARDWARE_COUNTER_COUNT; i++) stats->has_hardware_counters[i] = ofd_hardware_counter_is_open(ofd_cast(i, Ofd_Hardware_Counter));
+    
+    ofd_stats = stats;
+}
+
+ofd_static void ofd_end_stats(void)
+{
+    if(ofd_stats) ofd_get_allocation_stats(&ofd_stats->allocations);
+    ofd_count_allocations(ofd_false);
+    
+    ofd_stats = NULL;
+}
+
+ofd_static void ofd_free_stats(Ofd_Stats* stats)
+{
+    ofd_free_array(&stats->files);
+}
+
+ofd_static void ofd_begin_phase(void)
+{ // Phases go to the stats and to the trace, whichever are on.
+    if(ofd_trace) ofd_trace->phase_start_time = ofd_get_wall_time();
+    
+    if(ofd_stats)
+    {
+        ofd_stats->phase_wall_start = ofd_get_wall_time();
+        ofd_stats->phase_cpu_start  = ofd_get_cpu_time();
+        
+        for(int i = 0; i < OFD_HARDWARE_COUNTER_COUNT; i++)
         {
-            if(*c != '\n' && *c !='\r') break;
-            c++;
+            if(ofd_stats->has_hardware_counters[i]) ofd_stats->phase_hardware_counters_start[i] = ofd_read_hardware_counter(ofd_cast(i, Ofd_Hardware_Counter));
+        }
+    }
+}
+
+ofd_static void ofd_end_phase(Ofd_Stats_Phase phase)
+{
+    if(ofd_stats)
+    {
+        ofd_stats->wall_seconds[phase] += ofd_get_wall_time() - ofd_stats->phase_wall_start;
+        ofd_stats->cpu_seconds[phase]  += ofd_get_cpu_time()  - ofd_stats->phase_cpu_start;
+        
+        for(int i = 0; i < OFD_HARDWARE_COUNTER_COUNT; i++)
+        {
+            if(!ofd_stats->has_hardware_counters[i]) continue;
+            
+            ofd_u64 count = ofd_read_hardware_counter(ofd_cast(i, Ofd_Hardware_Counter));
+            ofd_u64 start = ofd_stats->phase_hardware_counters_start[i];
+            ofd_stats->hardware_counters[phase][i] += (count > start)? count - start : 0; // Scaling can make a count go down a little.
         }
-        //////////////////
     }
     
+    if(ofd_trace) ofd_end_trace_span(ofd_stats_phase_names[phase], ofd_trace->phase_start_time, Ofd_String_(""), -1);
+}
+
+ofd_static void ofd_add_file_stats(Ofd_Markdown_File* file)
+{ // The code blocks of file must be highlighted and its sections not freed yet.
+    Ofd_File_Stats* stats = ofd_array_add_fast(&ofd_stats->files);
+    
+    stats->filepath               = file->filepath;
+    stats->input_bytes            = file->markdown.count;
+    stats->output_bytes           = file->html.count + file->cached_html.count;
+    stats->num_sections           = file->sections.count;
+    stats->num_code_blocks        = file->code_blocks.count;
+    stats->is_cached              = (file->cache_record.data != NULL);
+    stats->parse_wall_seconds     = file->parse_wall_seconds;
+    stats->parse_cpu_seconds      = file->parse_cpu_seconds;
+    stats->highlight_wall_seconds = 0;
+    stats->highlight_cpu_seconds  = 0;
+    
+    ofd_stats->input_bytes     += file->markdown.count;
+    ofd_stats->num_sections    += file->sections.count;
+    ofd_stats->num_code_blocks += file->code_blocks.count;
+    
+    if(file->cache_record.data)
+    {
+        Ofd_File_Cache_Record record;
+        ofd_copy(&record, file->cache_record.data, sizeof(record));
+        
+        stats->num_code_blocks     = record.num_code_blocks;
+        ofd_stats->num_code_blocks += record.num_code_blocks;
+        ofd_stats->num_cached_files++;
+    }
     
-    return ofd_true;
+    for(int i = 0; i < file->code_blocks.count; i++)
+    {
+        Ofd_Code_Block* code_block = ofd_cast(file->code_blocks.data, Ofd_Code_Block*) + i;
+        
+        stats->output_bytes           += code_block->html.count;
+        stats->highlight_wall_seconds += code_block->highlight_wall_seconds;
+        stats->highlight_cpu_seconds  += code_block->highlight_cpu_seconds;
+    }
 }
 
-ofd_static ofd_b8 ofd_parse_theme_data(char* theme_data, int theme_data_size, Ofd_Theme* result, char* error_message)
+ofd_static void ofd_write_stats_report(Ofd_Stats* stats, int max_slowest_files, Ofd_Array* result)
 {
-    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    // NOTE: on success this returns ofd_true and ofd_false otherwise. Error messages are written to error_message.
-    // Note that the resulting theme is not initialised here, which means you can provide a default theme and only fields specified in theme_data
-    // will be changed.
-    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    char buffer[512];
     
-    const int OFD_BACKGROUND_COLOUR              = 0x01;
-    const int OFD_TEXT_COLOUR                    = 0x02;
-    const int OFD_CODE_BLOCK_BACKGROUND_COLOUR   = 0x04;
-    const int OFD_CODE_BLOCK_TEXT_COLOUR         = 0x08;
-    const int OFD_LINK_COLOUR                    = 0x10;
-    const int OFD_IMAGE_TITLE_COLOUR             = 0x20;
-    const int OFD_HORIZONTAL_RULE_COLOUR         = 0x40;
-    const int OFD_QUOTE_BACKGROUND_COLOUR        = 0x80;
-    const int OFD_QUOTE_TEXT_COLOUR              = 0x100;
-    const int OFD_SECTION_LINK_TEXT_COLOUR       = 0x200;
-    const int OFD_SECTION_LINK_BACKGROUND_COLOUR = 0x400;
-    const int OFD_SEPARATOR_COLOUR               = 0x800;
-    const int OFD_SCROLLBAR_COLOUR               = 0x1000;
-    const int OFD_FONT_SIZE                      = 0x2000;
     
-    const int OFD_SYNTAX_COMMENT_COLOUR   = 0x4000;
-    const int OFD_SYNTAX_STRING_COLOUR    = 0x8000;
-    const int OFD_SYNTAX_NUMBER_COLOUR    = 0x10000;
-    const int OFD_SYNTAX_STRUCTURE_COLOUR = 0x20000;
-    const int OFD_SYNTAX_KEYWORD_COLOUR   = 0x40000;
-    const int OFD_SYNTAX_DIRECTIVE_COLOUR = 0x80000;
+    // Add phases. START
+    ofd_array_add_string(result, Ofd_String_("Phase                 Wall (ms)      CPU (ms)\n"));
     
-    Ofd_Field fields[] = {
-        {OFD_BACKGROUND_COLOUR,              "background_colour",              &result->background_colour,              OFD_FIELD_COLOUR},
-        {OFD_TEXT_COLOUR,                    "text_colour",                    &result->text_colour,                    OFD_FIELD_COLOUR},
-        {OFD_CODE_BLOCK_BACKGROUND_COLOUR,   "code_block_background_colour",   &result->code_block_background_colour,   OFD_FIELD_COLOUR},
-        {OFD_CODE_BLOCK_TEXT_COLOUR,         "code_block_text_colour",         &result->code_block_text_colour,         OFD_FIELD_COLOUR},
-        {OFD_LINK_COLOUR,                    "link_colour",                    &result->link_colour,                    OFD_FIELD_COLOUR},
-        {OFD_IMAGE_TITLE_COLOUR,             "image_title_colour",             &result->image_title_colour,             OFD_FIELD_COLOUR},
-        {OFD_HORIZONTAL_RULE_COLOUR,         "horizontal_rule_colour",         &result->horizontal_rule_colour,         OFD_FIELD_COLOUR},
-        {OFD_QUOTE_BACKGROUND_COLOUR,        "quote_background_colour",        &result->quote_background_colour,        OFD_FIELD_COLOUR},
-        {OFD_QUOTE_TEXT_COLOUR,              "quote_text_colour",              &result->quote_text_colour,              OFD_FIELD_COLOUR},
-        {OFD_SECTION_LINK_TEXT_COLOUR,       "section_link_text_colour",       &result->section_link_text_colour,       OFD_FIELD_COLOUR},
-        {OFD_SECTION_LINK_BACKGROUND_COLOUR, "section_link_background_colour", &result->section_link_background_colour, OFD_FIELD_COLOUR},
-        {OFD_SEPARATOR_COLOUR,               "separator_colour",               &result->separator_colour,               OFD_FIELD_COLOUR},
-        {OFD_SCROLLBAR_COLOUR,               "scrollbar_colour",               &result->scrollbar_colour,               OFD_FIELD_COLOUR},
-        {OFD_FONT_SIZE,                      "font_size",                      &result->font_size,                      OFD_FIELD_F32},
+    ofd_f64 total_wall_seconds = 0;
+    ofd_f64 total_cpu_seconds  = 0;
+    for(int phase = 0; phase < OFD_STATS_PHASE_COUNT; phase++)
+    {
+        ofd_sprintf(buffer, "%-18s %12.3f  %12.3f\n", ofd_stats_phase_names[phase], stats->wall_seconds[phase] * 1000, stats->cpu_seconds[phase] * 1000);
+        ofd_array_add_string(result, Ofd_String_(buffer));
+        
+        total_wall_seconds += stats->wall_seconds[phase];
+        total_cpu_seconds  += stats->cpu_seconds[phase];
+    }
+    
+    ofd_sprintf(buffer, "%-18s %12.3f  %12.3f\n\n", "Total", total_wall_seconds * 1000, total_cpu_seconds * 1000);
+    ofd_array_add_string(result, Ofd_String_(buffer));
+    // Add phases. END
+    
+    
+    // Add counts. START
+    ofd_f64 megabytes_per_second = (total_wall_seconds > 0)? stats->input_bytes / (total_wall_seconds * 1024 * 1024) : 0;
+    
+    ofd_sprintf(buffer, "Input:  %llu bytes in %d files (%.2f MB/s)\nOutput: %llu bytes\n", stats->input_bytes, stats->files.count, megabytes_per_second, stats->output_bytes);
+    ofd_array_add_string(result, Ofd_String_(buffer));
+    
+    ofd_sprintf(buffer, "Sections: %d, link references: %d, code blocks: %d\n", stats->num_sections, stats->num_link_references, stats->num_code_blocks);
+    ofd_array_add_string(result, Ofd_String_(buffer));
+    
+    if(stats->num_cached_files)
+    {
+        ofd_sprintf(buffer, "Files from the file cache: %d\n", stats->num_cached_files);
+        ofd_array_add_string(result, Ofd_String_(buffer));
+    }
+    // Add counts. END
+    
+    
+    // Add slowest files. START
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: files are ranked by parse and highlight wall time, ties go to the file given first. Every rank looks for the slowest file
+    // that comes after the previous rank so nothing needs to be sorted. Files from the file cache were not parsed so they are left out.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    Ofd_File_Stats* files = ofd_cast(stats->files.data, Ofd_File_Stats*);
+    int num_slowest_files = ofd_min(max_slowest_files, stats->files.count - stats->num_cached_files);
+    
+    if(num_slowest_files > 0)
+    {
+        ofd_array_add_string(result, Ofd_String_("\nSlowest files      Parse (ms)  Highlight (ms)      CPU (ms)       Bytes  File\n"));
+    }
+    
+    ofd_f64 previous_seconds = 0;
+    int     previous_index   = -1;
+    for(int rank = 0; rank < num_slowest_files; rank++)
+    {
+        int     slowest_index   = -1;
+        ofd_f64 slowest_seconds = 0;
+        
+        for(int i = 0; i < stats->files.count; i++)
+        {
+            if(files[i].is_cached) continue;
+            
+            ofd_f64 seconds = files[i].parse_wall_seconds + files[i].highlight_wall_seconds;
+            
+            ofd_b8 comes_after_previous = (previous_index < 0) || (seconds < previous_seconds) || (seconds == previous_seconds && i > previous_index);
+            if(comes_after_previous && (slowest_index < 0 || seconds > slowest_seconds))
+            {
+                slowest_index   = i;
+                slowest_seconds = seconds;
+            }
+        }
+        
+        Ofd_File_Stats* file = files + slowest_index;
+        ofd_sprintf(buffer, "%-14d %12.3f  %14.3f  %12.3f  %10d  ", rank + 1, file->parse_wall_seconds * 1000, file->highlight_wall_seconds * 1000,
+                    (file->parse_cpu_seconds + file->highlight_cpu_seconds) * 1000, file->input_bytes);
+        ofd_array_add_string(result, Ofd_String_(buffer));
+        ofd_array_add_string(result, Ofd_String_(file->filepath? file->filepath : ""));
+        ofd_array_add_string(result, Ofd_String_("\n"));
+        
+        previous_index   = slowest_index;
+        previous_seconds = slowest_seconds;
+    }
+    // Add slowest files. END
+    
+    
+    // Add hardware counters. START
+    ofd_b8* has_counters = stats->has_hardware_counters;
+    if(has_counters[OFD_HARDWARE_COUNTER_CYCLES] || has_counters[OFD_HARDWARE_COUNTER_INSTRUCTIONS] ||
+       has_counters[OFD_HARDWARE_COUNTER_BRANCH_MISSES] || has_counters[OFD_HARDWARE_COUNTER_CACHE_MISSES])
+    {
+        ofd_array_add_string(result, Ofd_String_("\nCounters                 Cycles    Instructions     IPC  Branch misses/KB  LLC misses/KB\n"));
+        
+        ofd_f64 input_kilobytes = (stats->input_bytes > 0)? stats->input_bytes / 1024.0 : 1;
+        
+        ofd_u64 total[OFD_HARDWARE_COUNTER_COUNT] = {0};
+        for(int phase = 0; phase <= OFD_STATS_PHASE_COUNT; phase++)
+        {
+            ofd_u64* counters = total;
+            if(phase < OFD_STATS_PHASE_COUNT)
+            {
+                counters = stats->hardware_counters[phase];
+                for(int i = 0; i < OFD_HARDWARE_COUNTER_COUNT; i++) total[i] += counters[i];
+            }
+            
+            char columns[5][32] = {"n/a", "n/a", "n/a", "n/a", "n/a"};
+            if(has_counters[OFD_HARDWARE_COUNTER_CYCLES])        ofd_sprintf(columns[0], "%llu", counters[OFD_HARDWARE_COUNTER_CYCLES]);
+            if(has_counters[OFD_HARDWARE_COUNTER_INSTRUCTIONS])  ofd_sprintf(columns[1], "%llu", counters[OFD_HARDWARE_COUNTER_INSTRUCTIONS]);
+            if(has_counters[OFD_HARDWARE_COUNTER_BRANCH_MISSES]) ofd_sprintf(columns[3], "%.2f", counters[OFD_HARDWARE_COUNTER_BRANCH_MISSES] / input_kilobytes);
+            if(has_counters[OFD_HARDWARE_COUNTER_CACHE_MISSES])  ofd_sprintf(columns[4], "%.2f", counters[OFD_HARDWARE_COUNTER_CACHE_MISSES]  / input_kilobytes);
+            
+            if(has_counters[OFD_HARDWARE_COUNTER_CYCLES] && has_counters[OFD_HARDWARE_COUNTER_INSTRUCTIONS] && counters[OFD_HARDWARE_COUNTER_CYCLES] > 0)
+            {
+                ofd_sprintf(columns[2], "%.2f", ofd_cast(counters[OFD_HARDWARE_COUNTER_INSTRUCTIONS], ofd_f64) / counters[OFD_HARDWARE_COUNTER_CYCLES]);
+            }
+            
+            char* name = (phase < OFD_STATS_PHASE_COUNT)? ofd_stats_phase_names[phase] : ofd_cast("Total", char*);
+            ofd_sprintf(buffer, "%-16s %14s  %14s  %6s  %16s  %13s\n", name, columns[0], columns[1], columns[2], columns[3], columns[4]);
+            ofd_array_add_string(result, Ofd_String_(buffer));
+        }
+    }
+    // Add hardware counters. END
+    
+    
+    #ifdef OFD_ALLOCATION_STATS
+    // Add allocations. START
+    ofd_array_add_string(result, Ofd_String_("\nAllocations        Count         Bytes        Copies  Copied bytes\n"));
+    
+    Ofd_Allocation_Counts total = {0};
+    for(int tag = 0; tag < OFD_ALLOCATION_TAG_COUNT; tag++)
+    {
+        Ofd_Allocation_Counts* counts = stats->allocations.tags + tag;
         
-        {OFD_SYNTAX_COMMENT_COLOUR,          "syntax_comment_colour",          &result->syntax_comment_colour,          OFD_FIELD_COLOUR},
-        {OFD_SYNTAX_STRING_COLOUR,           "syntax_string_colour",           &result->syntax_string_colour,           OFD_FIELD_COLOUR},
-        {OFD_SYNTAX_NUMBER_COLOUR,           "syntax_number_colour",           &result->syntax_number_colour,           OFD_FIELD_COLOUR},
-        {OFD_SYNTAX_STRUCTURE_COLOUR,        "syntax_structure_colour",        &result->syntax_structure_colour,        OFD_FIELD_COLOUR},
-        {OFD_SYNTAX_KEYWORD_COLOUR,          "syntax_keyword_colour",          &result->syntax_keyword_colour,          OFD_FIELD_COLOUR},
-        {OFD_SYNTAX_DIRECTIVE_COLOUR,        "syntax_directive_colour",        &result->syntax_directive_colour,        OFD_FIELD_COLOUR},
-    };
+        ofd_sprintf(buffer, "%-15s %8llu  %12llu  %12llu  %12llu\n", ofd_allocation_tag_names[tag], counts->num_allocations, counts->num_allocated_bytes,
+                    counts->num_copies, counts->num_copied_bytes);
+        ofd_array_add_string(result, Ofd_String_(buffer));
+        
+        total.num_allocations     += counts->num_allocations;
+        total.num_allocated_bytes += counts->num_allocated_bytes;
+        total.num_copies          += counts->num_copies;
+        total.num_copied_bytes    += counts->num_copied_bytes;
+    }
     
+    ofd_sprintf(buffer, "%-15s %8llu  %12llu  %12llu  %12llu\nPeak live bytes: %llu\n", "Total", total.num_allocations, total.num_allocated_bytes,
+                total.num_copies, total.num_copied_bytes, stats->allocations.peak_live_bytes);
+    ofd_array_add_string(result, Ofd_String_(buffer));
+    // Add allocations. END
+    #endif // OFD_ALLOCATION_STATS
     
-    return ofd_parse_fields(theme_data, theme_data_size, fields, ofd_array_count(fields), error_message);
+    char* null_character = ofd_array_add_fast(result);
+    *null_character = 0;
 }
 
+ofd_static void ofd_find_link_references_job(void* user_data, int job_index)
+{
+    Ofd_Markdown_File* file = ofd_cast(user_data, Ofd_Markdown_File*) + job_index;
+    ofd_f64 span_start = ofd_begin_trace_span();
+    
+    ofd_arena_init(&file->arena, OFD_ARENA_DEFAULT_BLOCK_SIZE);
+    ofd_link_reference_table_init(&file->link_references, NULL, &file->arena);
+    
+    Ofd_String no_record = {0};
+    file->cache_record = no_record;
+    file->cached_html  = no_record;
+    
+    #ifndef OFD_NO_FILE_IO
+    if(ofd_file_cache.is_open && ofd_find_file_in_cache(file))
+    {
+        ofd_end_file_trace_span("Find link references", span_start, file->filepath, file->markdown.count);
+        return;
+    }
+    #endif // OFD_NO_FILE_IO
+    
+    ofd_find_link_references(file->markdown.data, file->markdown.data + file->markdown.count, &file->link_references, &file->arena);
+    
+    ofd_end_file_trace_span("Find link references", span_start, file->filepath, file->markdown.count);
+}
 
-ofd_static ofd_b8 ofd_parse_configuration_data(char* data, int data_size, Ofd_Config* result, char* error_message)
+ofd_static void ofd_parse_markdown_file_job(void* user_data, int job_index)
 {
-    const int OUTPUT_FIELD = 0x01;
-    const int THEME_FIELD  = 0x02;
-    const int LOGO_FIELD   = 0x04;
-    const int ICON_FIELD   = 0x08;
-    const int TITLE_FIELD  = 0x10;
+    Ofd_Markdown_File* file = ofd_cast(user_data, Ofd_Markdown_File*) + job_index;
+    ofd_f64 span_start = ofd_begin_trace_span();
     
-    Ofd_Field fields[] = {
-        {OUTPUT_FIELD, "output", &result->output_filepath, OFD_FIELD_STRING},
-        {THEME_FIELD,  "theme",  &result->theme_filepath,  OFD_FIELD_STRING},
-        {LOGO_FIELD,   "logo",   &result->logo_path,       OFD_FIELD_STRING},
-        {ICON_FIELD,   "icon",   &result->icon_path,       OFD_FIELD_STRING},
-        {TITLE_FIELD,  "title",  &result->title,           OFD_FIELD_STRING},
-    };
+    if(!ofd_stats) ofd_parse_or_load_markdown_file(file);
+    else
+    {
+        ofd_f64 wall_start = ofd_get_wall_time();
+        ofd_f64 cpu_start  = ofd_get_thread_cpu_time();
+        
+        ofd_parse_or_load_markdown_file(file);
+        
+        file->parse_wall_seconds = ofd_get_wall_time()       - wall_start;
+        file->parse_cpu_seconds  = ofd_get_thread_cpu_time() - cpu_start;
+    }
     
-    return ofd_parse_fields(data, data_size, fields, ofd_array_count(fields), error_message);
+    ofd_end_file_trace_span(file->cache_record.data? "Load cached file" : "Parse file", span_start, file->filepath, file->markdown.count);
 }
 
+ofd_static void ofd_highlight_code_block(Ofd_Code_Block* code_block)
+{
+    ofd_array_init_with_space(&code_block->html, 1, code_block->text.count * 2);
+    ofd_apply_syntax_highlighting(&code_block->html, code_block->text, code_block->language);
+}
 
-ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_files, char** markdown_filepaths, int num_markdown_files, Ofd_Array* output, Ofd_Theme theme, char* logo_path, char* icon_path, char* title, Ofd_Array* log_data)
+ofd_static void ofd_highlight_code_block_job(void* user_data, int job_index)
 {
-    //////////////////////////////////////////////////////////////
-    // NOTE: it is up to you to free output with ofd_free_array().
-    //////////////////////////////////////////////////////////////
+    Ofd_Code_Block* code_block = ofd_cast(user_data, Ofd_Code_Block**)[job_index];
     
+    if(!ofd_stats)
+    {
+        ofd_highlight_code_block(code_block);
+        return;
+    }
+    
+    ofd_f64 wall_start = ofd_get_wall_time();
+    ofd_f64 cpu_start  = ofd_get_thread_cpu_time();
+    
+    ofd_highlight_code_block(code_block);
+    
+    code_block->highlight_wall_seconds = ofd_get_wall_time()       - wall_start;
+    code_block->highlight_cpu_seconds  = ofd_get_thread_cpu_time() - cpu_start;
+}
+
+ofd_static void ofd_write_markdown_file_html(Ofd_Writer* writer, Ofd_Markdown_File* file)
+{ // This puts the highlighted code blocks back where they belong.
+    if(file->cache_record.data)
+    { // Code blocks come highlighted in the record.
+        ofd_writer_add(writer, file->cached_html.data, file->cached_html.count);
+        return;
+    }
+    
+    int html_offset = 0;
+    for(int i = 0; i < file->code_blocks.count; i++)
+    {
+        Ofd_Code_Block* code_block = ofd_cast(file->code_blocks.data, Ofd_Code_Block*) + i;
+        
+        ofd_writer_add(writer, file->html.data + html_offset, code_block->html_offset - html_offset);
+        ofd_writer_add(writer, code_block->html.data, code_block->html.count);
+        ofd_free_array(&code_block->html);
+        
+        html_offset = code_block->html_offset;
+    }
+    
+    ofd_writer_add(writer, file->html.data + html_offset, file->html.count - html_offset);
+    ofd_free_array(&file->code_blocks);
+}
+
+ofd_static void ofd_write_documentation_head(Ofd_Writer* writer, Ofd_Theme theme, char* icon_path, char* title)
+{
     char buffer[2048];
     char colour_string[64];
     char colour_string2[64];
     char colour_string3[64];
     
+    ofd_begin_phase();
     
-    Ofd_Array html, sections;
-    
-    ofd_array_init(&html,     1);
-    ofd_array_init(&sections, sizeof(Ofd_Section));
-    ofd_array_init(log_data, 1);
-    
-    
-    int next_section_id = 0;
     
     // Add basic HTML stuff. START
-    ofd_array_add_string(&html, Ofd_String_(
+    ofd_writer_add_string(writer, Ofd_String_(
         "<!doctype html>"
         "<html>"
         "<head>"
@@ -4242,7 +8410,7 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
     if(title)
     {
         ofd_sprintf(buffer, "<title>%s</title>", title);
-        ofd_array_add_string(&html, Ofd_String_(buffer));
+        ofd_writer_add_string(writer, Ofd_String_(buffer));
     }
     if(icon_path)
     {
@@ -4258,10 +8426,10 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
             icon_path, icon_path,
             title, icon_path
         );
-        ofd_array_add_string(&html, Ofd_String_(buffer));
+        ofd_writer_add_string(writer, Ofd_String_(buffer));
     }
     
-    ofd_array_add_string(&html, Ofd_String_(
+    ofd_writer_add_string(writer, Ofd_String_(
         "</head>"
         "<body>"
     ));
@@ -4270,7 +8438,7 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
     
     ofd_f32 base_font_size = theme.font_size; // In percentage of the render target height.
     
-    ofd_array_add_string(&html, Ofd_String_("<style>"));
+    ofd_writer_add_string(writer, Ofd_String_("<style>"));
     
     
     // Generate basic style. START
@@ -4379,7 +8547,7 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
         logo_height, logo_height // #ofd-sidebar-toggle
     );
     
-    ofd_array_add_string(&html, Ofd_String_(buffer));
+    ofd_writer_add_string(writer, Ofd_String_(buffer));
     
     ofd_colour_to_string(theme.text_colour, colour_string);
     
@@ -4437,7 +8605,7 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
         colour_string
     );
     
-    ofd_array_add_string(&html, Ofd_String_(buffer));
+    ofd_writer_add_string(writer, Ofd_String_(buffer));
     // Generate basic style. END
     
     
@@ -4469,7 +8637,7 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
         colour_string2, colour_string
     );
     
-    ofd_array_add_string(&html, Ofd_String_(buffer));
+    ofd_writer_add_string(writer, Ofd_String_(buffer));
     // Generate scrollbar style. END
     
     
@@ -4496,7 +8664,7 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
             header_hierarchy, font_size, margin
         );
         
-        ofd_array_add_string(&html, Ofd_String_(buffer));
+        ofd_writer_add_string(writer, Ofd_String_(buffer));
     }
     // Generate header styles. END
     
@@ -4531,7 +8699,7 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
         base_font_size * 0.25f, base_font_size * 0.05f, base_font_size * 0.2f, base_font_size * 0.2f
     );
     
-    ofd_array_add_string(&html, Ofd_String_(buffer));
+    ofd_writer_add_string(writer, Ofd_String_(buffer));
     // Generate code block styles. END
     
     
@@ -4546,7 +8714,7 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
         colour_string
     );
     
-    ofd_array_add_string(&html, Ofd_String_(buffer));
+    ofd_writer_add_string(writer, Ofd_String_(buffer));
     // Generate link style. END
     
     
@@ -4562,7 +8730,7 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
         colour_string
     );
     
-    ofd_array_add_string(&html, Ofd_String_(buffer));
+    ofd_writer_add_string(writer, Ofd_String_(buffer));
     // Generate image title style. END
     
     
@@ -4597,7 +8765,7 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
         rule2_margin, rule2_margin, colour_string2
     );
     
-    ofd_array_add_string(&html, Ofd_String_(buffer));
+    ofd_writer_add_string(writer, Ofd_String_(buffer));
     // Generate horizontal rule style. END
     
     
@@ -4618,7 +8786,7 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
         colour_string, colour_string2, base_font_size
     );
     
-    ofd_array_add_string(&html, Ofd_String_(buffer));
+    ofd_writer_add_string(writer, Ofd_String_(buffer));
     // Generate quote style. END
     
     
@@ -4671,7 +8839,7 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
         colour_string2
     );
     
-    ofd_array_add_string(&html, Ofd_String_(buffer));
+    ofd_writer_add_string(writer, Ofd_String_(buffer));
     // Generate todo-list styles. END
     
     
@@ -4694,7 +8862,7 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
         colour_string,
         colour_string
     );
-    ofd_array_add_string(&html, Ofd_String_(buffer));
+    ofd_writer_add_string(writer, Ofd_String_(buffer));
     
     
     Ofd_Colour subsection_link_colour = theme.section_link_text_colour;
@@ -4714,7 +8882,7 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
             i + 1, ofd_cast(i - 1, ofd_f32) * 5.0f, colour_string
         );
         
-        ofd_array_add_string(&html, Ofd_String_(buffer));
+        ofd_writer_add_string(writer, Ofd_String_(buffer));
     }
     
     
@@ -4744,7 +8912,7 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
         colour_string
     );
     
-    ofd_array_add_string(&html, Ofd_String_(buffer));
+    ofd_writer_add_string(writer, Ofd_String_(buffer));
     
     
     ofd_colour_to_string(theme.section_link_background_colour, colour_string);
@@ -4780,7 +8948,7 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
         dropdown_arrow_size, dropdown_arrow_size, dropdown_arrow_size, colour_string2
     );
     
-    ofd_array_add_string(&html, Ofd_String_(buffer));
+    ofd_writer_add_string(writer, Ofd_String_(buffer));
     // Generate section link styles. END
     
     
@@ -4798,63 +8966,23 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
         colour_string
     );
     
-    ofd_array_add_string(&html, Ofd_String_(buffer));
+    ofd_writer_add_string(writer, Ofd_String_(buffer));
     // Generate table style. END
     
     
     // Generate syntax styles. START
-    ofd_colour_to_string(theme.syntax_comment_colour, colour_string);
-    ofd_colour_to_string(theme.syntax_string_colour,  colour_string2);
-    ofd_colour_to_string(theme.syntax_number_colour,  colour_string3);
-    
-    ofd_sprintf(buffer,
-        ".ofd-syntax-comment {"
-            "color: %s;"
-        "}"
-        
-        ".ofd-syntax-string {"
-            "color: %s;"
-        "}"
-        
-        ".ofd-syntax-number {"
-            "color: %s;"
-        "}"
-        ,
-        colour_string,
-        colour_string2,
-        colour_string3
-    );
-    
-    ofd_array_add_string(&html, Ofd_String_(buffer));
-    
-    
-    ofd_colour_to_string(theme.syntax_structure_colour, colour_string);
-    ofd_colour_to_string(theme.syntax_keyword_colour,   colour_string2);
-    ofd_colour_to_string(theme.syntax_directive_colour, colour_string3);
-    
-    ofd_sprintf(buffer,
-        ".ofd-syntax-structure {"
-            "color: %s;"
-        "}"
-        
-        ".ofd-syntax-keyword {"
-            "color: %s;"
-        "}"
+    Ofd_Colour syntax_colours[OFD_SYNTAX_CLASS_COUNT] = {theme.syntax_comment_colour, theme.syntax_string_colour, theme.syntax_number_colour, theme.syntax_structure_colour, theme.syntax_keyword_colour, theme.syntax_directive_colour};
+    for(int i = 0; i < OFD_SYNTAX_CLASS_COUNT; i++)
+    {
+        ofd_colour_to_string(syntax_colours[i], colour_string);
+        ofd_sprintf(buffer, "%s {color: %s;}", OFD_SYNTAX_CSS_SELECTORS[i], colour_string);
         
-        ".ofd-syntax-directive {"
-            "color: %s;"
-        "}"
-        ,
-        colour_string,
-        colour_string2,
-        colour_string3
-    );
-    
-    ofd_array_add_string(&html, Ofd_String_(buffer));
+        ofd_writer_add_string(writer, Ofd_String_(buffer));
+    }
     // Generate syntax styles. END
     
     
-    ofd_array_add_string(&html, Ofd_String_(
+    ofd_writer_add_string(writer, Ofd_String_(
         "#ofd-menu-part:before {"
             "top: -300%;"
         "}"
@@ -4903,9 +9031,11 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
         "}"
         
         
+        #ifndef OFD_COMPACT_SYNTAX_MARKUP
         ".ofd-syntax {"
             "display: inline;"
         "}"
+        #endif
         
         
         ".ofd-table-wrapper {"
@@ -5007,64 +9137,156 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
         "<input type='checkbox' id='ofd-sidebar-checkbox' style='display: none;' checked/>"
     ));
     
+    ofd_end_phase(OFD_STATS_PHASE_CSS);
+}
+
+ofd_static void ofd_write_documentation_body(Ofd_String* markdown_files, char** markdown_filepaths, int num_markdown_files, Ofd_Writer* writer, Ofd_Theme theme, char* logo_path, Ofd_Array* log_data)
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: the body only uses the text colour, the font size and the background colour of the theme. If that changes,
+    // change ofd_theme_changes_body() too.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    char buffer[2048];
+    char colour_string[64];
+    
+    
+    Ofd_Array sections, section_strings;
+    
+    ofd_array_init(&sections,        sizeof(Ofd_Section));
+    ofd_array_init(&section_strings, 1);
+    ofd_array_init(log_data, 1);
+    
+    sections.allocation_tag        = OFD_ALLOCATION_SECTIONS;
+    section_strings.allocation_tag = OFD_ALLOCATION_SECTIONS;
+    
+    Ofd_Arena arena; // All temporary memory used during this run goes here and gets released at once at the end.
+    ofd_arena_init(&arena, OFD_ARENA_DEFAULT_BLOCK_SIZE);
+    
+    ofd_f32 dropdown_arrow_size = theme.font_size * 0.5f; // Same as in ofd_write_documentation_head().
+    
     
     // Parse markdown files. START
-    Ofd_Array md_html, link_references;
-    ofd_array_init(&md_html, 1);
-    ofd_array_init(&link_references, sizeof(Ofd_Link_Reference));
+    Ofd_Markdown_File* files = ofd_tagged_allocate(ofd_max(num_markdown_files, 1) * sizeof(Ofd_Markdown_File), OFD_ALLOCATION_FILES);
+    for(int file_index = 0; file_index < num_markdown_files; file_index++)
+    {
+        files[file_index].markdown = markdown_files[file_index];
+        files[file_index].filepath = markdown_filepaths[file_index];
+    }
+    
+    // Gather link references first so that links can use references defined anywhere. START
+    ofd_begin_phase();
+    ofd_register_builtin_languages(); // The registry must not be touched by several threads at once, and the file cache hashes it.
+    ofd_run_jobs(ofd_find_link_references_job, files, num_markdown_files);
+    
+    Ofd_Link_Reference_Table link_references;
+    ofd_link_reference_table_init(&link_references, NULL, &arena);
     
     for(int file_index = 0; file_index < num_markdown_files; file_index++)
     {
-        if(file_index > 0) ofd_array_add_string(&md_html, Ofd_String_("<br/><br/><div class='ofd-horizontal-rule'></div><br/>"));
-        
-        
-        Ofd_String filename = Ofd_String_(markdown_filepaths[file_index]);
-        filename = ofd_get_last_item_from_filepath(filename);
-        filename = ofd_strip_file_extension(filename);
-        filename.count = ofd_min(filename.count, OFD_MAX_SECTION_NAME_COUNT);
+        Ofd_Markdown_File* file = files + file_index;
+        for(int i = 0; i < file->link_references.references.count; i++)
+        {
+            Ofd_Link_Reference reference = ofd_cast(file->link_references.references.data, Ofd_Link_Reference*)[i];
+            if(!ofd_find_link_reference(&link_references, reference.id)) ofd_add_link_reference(&link_references, reference);
+        }
         
-        Ofd_Section* section = ofd_array_add_fast(&sections);
-        section->id         = next_section_id;
-        section->hierarchy  = 0;
+        // From now on the file only keeps the references ofd_find_link_references() missed, if any.
+        file->definitions = file->link_references.references;
+        ofd_link_reference_table_init(&file->link_references, &link_references, &file->arena);
+    }
+    
+    if(ofd_stats) ofd_stats->num_link_references += link_references.references.count;
+    ofd_end_phase(OFD_STATS_PHASE_LINK_REFERENCES);
+    // Gather link references first so that links can use references defined anywhere. END
+    
+    ofd_begin_phase();
+    ofd_run_jobs(ofd_parse_markdown_file_job, files, num_markdown_files);
+    ofd_end_phase(OFD_STATS_PHASE_PARSE);
+    // Parse markdown files. END
+    
+    
+    // Highlight code blocks. START
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: this is done apart from parsing so that a single file with lots of code, or one huge code block, does not hold up the rest.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    ofd_begin_phase();
+    
+    int num_code_blocks = 0;
+    for(int file_index = 0; file_index < num_markdown_files; file_index++) num_code_blocks += files[file_index].code_blocks.count;
+    
+    Ofd_Code_Block** code_blocks = ofd_arena_allocate(&arena, ofd_max(num_code_blocks, 1) * sizeof(Ofd_Code_Block*));
+    
+    int code_block_index = 0;
+    for(int file_index = 0; file_index < num_markdown_files; file_index++)
+    {
+        for(int i = 0; i < files[file_index].code_blocks.count; i++)
+        {
+            code_blocks[code_block_index] = ofd_cast(files[file_index].code_blocks.data, Ofd_Code_Block*) + i;
+            code_block_index++;
+        }
+    }
+    
+    ofd_run_jobs(ofd_highlight_code_block_job, code_blocks, num_code_blocks);
+    ofd_end_phase(OFD_STATS_PHASE_HIGHLIGHT);
+    // Highlight code blocks. END
+    
+    
+    // Stitch files together. START
+    ofd_begin_phase();
+    
+    int next_section_id = 0;
+    
+    for(int file_index = 0; file_index < num_markdown_files; file_index++)
+    {
+        Ofd_Markdown_File* file = files + file_index;
         
-        filename = ofd_cleanup_section_name(filename, section->name_memory, ofd_true);
-        section->name_count = filename.count;
         
-        Ofd_String section_id = ofd_make_section_id(filename, section->id_memory);
-        section->id_count = section_id.count;
+        // Renumber sections. START
+        int string_offset = section_strings.count;
+        ofd_array_add_array(&section_strings, &file->section_strings);
         
-        ofd_copy(section->full_id_memory, section->id_memory, section->id_count);
-        section->full_id_count = section->id_count;
+        for(int section_index = 0; section_index < file->sections.count; section_index++)
+        {
+            Ofd_Section* section = ofd_array_add_fast(&sections);
+            *section = ofd_cast(file->sections.data, Ofd_Section*)[section_index];
+            
+            section->id             += next_section_id;
+            section->name_offset    += string_offset;
+            section->id_offset      += string_offset;
+            section->full_id_offset += string_offset;
+        }
         
+        next_section_id += file->num_section_ids;
+        // Renumber sections. END
         
-        ofd_array_add_string(&md_html, Ofd_String_("<div class='ofd-anchor' id='"));
-        ofd_array_add_string(&md_html, section_id);
-        ofd_array_add_string(&md_html, Ofd_String_("'></div>"));
         
+        ofd_array_add_array(log_data, &file->log_data);
         
-        next_section_id++;
+        if(ofd_stats) ofd_add_file_stats(file);
         
+        #ifndef OFD_NO_FILE_IO
+        if(ofd_file_cache.is_open && !file->cache_record.data) ofd_add_file_to_cache(file);
+        #endif // OFD_NO_FILE_IO
         
-        Ofd_String* markdown_data = markdown_files + file_index;
-        ofd_parse_markdown(markdown_data->data, markdown_data->data + markdown_data->count, &md_html, &sections, &link_references, &next_section_id, log_data);
+        ofd_free_array(&file->sections);
+        ofd_free_array(&file->section_strings);
+        ofd_free_array(&file->log_data);
     }
     
+    for(int file_index = 0; file_index < num_markdown_files; file_index++) ofd_free_arena(&files[file_index].arena); // Nothing uses link references anymore.
+    
+    ofd_end_phase(OFD_STATS_PHASE_STITCH);
+    // Stitch files together. END
     
-    // Free link references.
-    for(int i = 0; i < link_references.count; i++)
-    {
-        Ofd_Link_Reference* ref = ofd_cast(link_references.data, Ofd_Link_Reference*) + i;
-        ofd_free_array(&ref->additional_css);
-    }
-    ofd_free_array(&link_references);
-    ////////////////////////
-    // Parse markdown files. END
     
+    ofd_begin_phase();
     
     // Add logo. START
-    ofd_array_add_string(&html, Ofd_String_("<div id='ofd-logo-container'>"));
+    ofd_writer_add_string(writer, Ofd_String_("<div id='ofd-logo-container'>"));
     
-    ofd_array_add_string(&html, Ofd_String_(
+    ofd_writer_add_string(writer, Ofd_String_(
             "<label for='ofd-sidebar-checkbox' id='ofd-sidebar-toggle'>"
                 "<div id='ofd-menu-part'></div>"
             "</label>"
@@ -5073,15 +9295,15 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
     if(logo_path)
     {
         ofd_sprintf(buffer, "<img id='ofd-logo' src='%s' />", logo_path);
-        ofd_array_add_string(&html, Ofd_String_(buffer));
+        ofd_writer_add_string(writer, Ofd_String_(buffer));
     }
     
-    ofd_array_add_string(&html, Ofd_String_("</div>"));
+    ofd_writer_add_string(writer, Ofd_String_("</div>"));
     // Add logo. END
     
     
     // Add sidebar. START
-    ofd_array_add_string(&html, Ofd_String_("<div id='ofd-sidebar' class='ofd-sidebar-element'>"));
+    ofd_writer_add_string(writer, Ofd_String_("<div id='ofd-sidebar' class='ofd-sidebar-element'>"));
     
     // Add sections. START
     Ofd_Section* previous_root_section = NULL;
@@ -5094,23 +9316,23 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
         {
             if(previous_root_section)
             {
-                if(previous_root_section != section - 1) ofd_array_add_string(&html, Ofd_String_("</div>"));
+                if(previous_root_section != section - 1) ofd_writer_add_string(writer, Ofd_String_("</div>"));
             }
             
-            ofd_array_add_string(&html, Ofd_String_("<div class='ofd-horizontal-rule-2'></div>"));
+            ofd_writer_add_string(writer, Ofd_String_("<div class='ofd-horizontal-rule-2'></div>"));
             
             previous_root_section = NULL;
         }
         
         
-        Ofd_String section_name = {section->name_memory, section->name_count};
-        Ofd_String section_id   = {section->full_id_memory, section->full_id_count};
+        Ofd_String section_name = ofd_get_section_string(&section_strings, section->name_offset,    section->name_count);
+        Ofd_String section_id   = ofd_get_section_string(&section_strings, section->full_id_offset, section->full_id_count);
         
         if(previous_root_section)
         {
             if(section->hierarchy == 1)
             {
-                if(previous_root_section != section - 1) ofd_array_add_string(&html, Ofd_String_("</div>"));
+                if(previous_root_section != section - 1) ofd_writer_add_string(writer, Ofd_String_("</div>"));
             }
         }
         
@@ -5148,7 +9370,7 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
                     section->id, section->id,
                     dropdown_arrow_size, dropdown_arrow_size, dropdown_arrow_size, colour_string
                 );
-                ofd_array_add_string(&html, Ofd_String_(buffer));
+                ofd_writer_add_string(writer, Ofd_String_(buffer));
             }
         }
         
@@ -5156,43 +9378,43 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
         if(next_comes_a_subsection)
         {
             ofd_sprintf(buffer, "<input type='checkbox' id='ofd-dropdown-%d' style='display: none;' />", section->id);
-            ofd_array_add_string(&html, Ofd_String_(buffer));
+            ofd_writer_add_string(writer, Ofd_String_(buffer));
         }
         
         ofd_f32 link_width = next_comes_a_subsection? 80 : 93;
         ofd_sprintf(buffer, "<div class='ofd-section-link-wrapper'><a class='ofd-section-link' style='width:%g%%;' href='#", link_width);
-        ofd_array_add_string(&html, Ofd_String_(buffer));
-        ofd_array_add_string(&html, section_id);
+        ofd_writer_add_string(writer, Ofd_String_(buffer));
+        ofd_writer_add_string(writer, section_id);
         
         ofd_sprintf(buffer, "'><div class='ofd-section-link-%d'>", section->hierarchy);
-        ofd_array_add_string(&html, Ofd_String_(buffer));
+        ofd_writer_add_string(writer, Ofd_String_(buffer));
         
-        ofd_array_add_string(&html, section_name);
+        ofd_writer_add_string(writer, section_name);
         
-        ofd_array_add_string(&html, Ofd_String_("</div></a>"));
+        ofd_writer_add_string(writer, Ofd_String_("</div></a>"));
         
         if(next_comes_a_subsection)
         {
             ofd_sprintf(buffer, "<label for='ofd-dropdown-%d' class='ofd-dropdown-button' id='ofd-dropdown-button-%d'><div class='ofd-dropdown-arrow'></div></label></div>", section->id, section->id);
-            ofd_array_add_string(&html, Ofd_String_(buffer));
+            ofd_writer_add_string(writer, Ofd_String_(buffer));
             
             ofd_sprintf(buffer,
                 "<div class='ofd-subsection' id='ofd-subsection-%d'><div class='ofd-subsection-rule'></div>"
                 ,
                 section->id
             );
-            ofd_array_add_string(&html, Ofd_String_(buffer));
+            ofd_writer_add_string(writer, Ofd_String_(buffer));
         }
-        else ofd_array_add_string(&html, Ofd_String_("</div>")); // Closing the section link wrapper.
+        else ofd_writer_add_string(writer, Ofd_String_("</div>")); // Closing the section link wrapper.
         
-        if(section->hierarchy != 1 && section_index + 1 == sections.count && previous_root_section) ofd_array_add_string(&html, Ofd_String_("</div>"));
+        if(section->hierarchy != 1 && section_index + 1 == sections.count && previous_root_section) ofd_writer_add_string(writer, Ofd_String_("</div>"));
     }
     // Add sections. END
     
-    ofd_array_add_string(&html, Ofd_String_("</div>"));
+    ofd_writer_add_string(writer, Ofd_String_("</div>"));
     
     
-    ofd_array_add_string(&html, Ofd_String_("<div id='ofd-repo-link' class='ofd-sidebar-element'>"));
+    ofd_writer_add_string(writer, Ofd_String_("<div id='ofd-repo-link' class='ofd-sidebar-element'>"));
     
     ofd_f32 background_brightness = theme.background_colour.r * 0.2126f + theme.background_colour.g * 0.7152f + theme.background_colour.b * 0.0722f;
     char* logo_source = background_brightness < 0.5f? "https://deliciouslines.com/images/ofd-logo-white.png" : "https://deliciouslines.com/images/ofd-logo-black.png";
@@ -5203,77 +9425,123 @@ ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_file
         ,
         logo_source
     );
-    ofd_array_add_string(&html, Ofd_String_(buffer));
+    ofd_writer_add_string(writer, Ofd_String_(buffer));
     
-    ofd_array_add_string(&html, Ofd_String_("</div>"));
+    ofd_writer_add_string(writer, Ofd_String_("</div>"));
     
     
-    ofd_array_add_string(&html, Ofd_String_("<div id='ofd-sidebar-separator' class='ofd-sidebar-element'></div>"));
-    ofd_array_add_string(&html, Ofd_String_("<div id='ofd-logo-separator'></div>"));
+    ofd_writer_add_string(writer, Ofd_String_("<div id='ofd-sidebar-separator' class='ofd-sidebar-element'></div>"));
+    ofd_writer_add_string(writer, Ofd_String_("<div id='ofd-logo-separator'></div>"));
     // Add sidebar. END
     
+    ofd_end_phase(OFD_STATS_PHASE_SIDEBAR);
+    
+    
+    ofd_begin_phase();
+    
     // Add main content.
-    ofd_array_add_string(&html, Ofd_String_("<div id='ofd-main-content'>"));
-    ofd_array_add_array(&html, &md_html);
+    ofd_writer_add_string(writer, Ofd_String_("<div id='ofd-main-content'>"));
+    for(int file_index = 0; file_index < num_markdown_files; file_index++)
+    {
+        if(file_index > 0) ofd_writer_add_string(writer, Ofd_String_("<br/><br/><div class='ofd-horizontal-rule'></div><br/>"));
+        
+        ofd_write_markdown_file_html(writer, files + file_index);
+        ofd_free_array(&files[file_index].html);
+    }
     
-    ofd_free_array(&md_html);
+    ofd_tagged_free(files);
     
-    ofd_array_add_string(&html, Ofd_String_("<div style='display: block; height: 1vh;'></div></div>"));
+    ofd_writer_add_string(writer, Ofd_String_("<div style='display: block; height: 1vh;'></div></div>"));
     ////////////////////
     
-    ofd_array_add_string(&html, Ofd_String_(
+    ofd_writer_add_string(writer, Ofd_String_(
         "</html>"
         "</body>"
     ));
     
     ofd_free_array(&sections);
-    
-    
-    *output = html;
+    ofd_free_array(&section_strings);
+    ofd_free_arena(&arena);
     
     char* null_character = ofd_array_add_fast(log_data);
     *null_character = 0;
+    
+    ofd_end_phase(OFD_STATS_PHASE_WRITE);
 }
 
-#ifndef OFD_NO_FILE_IO
-ofd_static ofd_b8 ofd_generate_documentation(char** markdown_filepaths, int num_markdown_files, char* output_filepath, char* theme_filepath, char* logo_path, char* icon_path, char* title)
+ofd_static void ofd_generate_documentation_to_writer(Ofd_String* markdown_files, char** markdown_filepaths, int num_markdown_files, Ofd_Writer* writer, Ofd_Theme theme, char* logo_path, char* icon_path, char* title, Ofd_Array* log_data)
 {
-    #define OFD_GEN_DOCS_RETURN(_v)\
-    {\
-        ofd_free_array(&html);\
-        ofd_free_array(&log_data);\
-        \
-        for(int md_index = 0; md_index < markdown_files.count; md_index++)\
-        {\
-            Ofd_String* data = ofd_cast(markdown_files.data, Ofd_String*) + md_index;\
-            ofd_free(data->data);\
-        }\
-        \
-        ofd_free_array(&markdown_files);\
-        return _v;\
-    }
+    ofd_u64 first_num_bytes = writer->num_bytes; // For stats, the writer may have been used before.
+    
+    ofd_write_documentation_head(writer, theme, icon_path, title);
+    ofd_write_documentation_body(markdown_files, markdown_filepaths, num_markdown_files, writer, theme, logo_path, log_data);
+    
+    if(ofd_stats) ofd_stats->output_bytes += writer->num_bytes - first_num_bytes;
+}
+
+ofd_static void ofd_generate_documentation_from_memory(Ofd_String* markdown_files, char** markdown_filepaths, int num_markdown_files, Ofd_Array* output, Ofd_Theme theme, char* logo_path, char* icon_path, char* title, Ofd_Array* log_data)
+{
+    //////////////////////////////////////////////////////////////
+    // NOTE: it is up to you to free output with ofd_free_array().
+    //////////////////////////////////////////////////////////////
     
+    ofd_array_init(output, 1);
     
-    Ofd_Array html     = {0};
-    Ofd_Array log_data = {0};
+    Ofd_Writer writer;
+    ofd_writer_init_with_array(&writer, output);
     
+    ofd_generate_documentation_to_writer(markdown_files, markdown_filepaths, num_markdown_files, &writer, theme, logo_path, icon_path, title, log_data);
     
-    // Load markdown files. START
-    Ofd_Array markdown_files;
-    ofd_array_init_with_space(&markdown_files, sizeof(Ofd_String), num_markdown_files);
+    ofd_close_writer(&writer);
+}
+
+#ifndef OFD_NO_FILE_IO
+ofd_static void ofd_release_markdown_files(Ofd_Array* markdown_files, ofd_b8* markdown_files_are_mapped)
+{
+    for(int md_index = 0; md_index < markdown_files->count; md_index++)
+    {
+        Ofd_String* data = ofd_cast(markdown_files->data, Ofd_String*) + md_index;
+        ofd_release_whole_file(data, markdown_files_are_mapped[md_index]);
+    }
+    
+    ofd_free_array(markdown_files);
+    ofd_tagged_free(markdown_files_are_mapped);
+}
+
+ofd_static ofd_b8 ofd_load_markdown_files(char** markdown_filepaths, int num_markdown_files, ofd_b8 files_can_be_mapped, Ofd_Array* markdown_files, ofd_b8** markdown_files_are_mapped)
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // NOTE: on success, release the files with ofd_release_markdown_files(). Pass files_can_be_mapped as ofd_false when the files may
+    // be edited while we use them: truncating a mapped file makes reading its pages raise SIGBUS, a copy cannot change under us.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    
+    ofd_array_init_with_space(markdown_files, sizeof(Ofd_String), num_markdown_files);
+    *markdown_files_are_mapped = ofd_tagged_allocate(ofd_max(num_markdown_files, 1), OFD_ALLOCATION_FILES);
     for(int file_index = 0; file_index < num_markdown_files; file_index++)
     {
-        Ofd_String* markdown_data = ofd_array_add_fast(&markdown_files);
-        if(!ofd_read_whole_file(markdown_filepaths[file_index], markdown_data))
+        ofd_f64 span_start = ofd_begin_trace_span();
+        
+        Ofd_String* markdown_data = ofd_array_add_fast(markdown_files);
+        (*markdown_files_are_mapped)[file_index] = ofd_false;
+        
+        ofd_b8 status = files_can_be_mapped? ofd_map_whole_file(markdown_filepaths[file_index], markdown_data, *markdown_files_are_mapped + file_index) :
+                                             ofd_read_whole_file(markdown_filepaths[file_index], markdown_data);
+        if(!status)
         {
-            OFD_GEN_DOCS_RETURN(ofd_false);
+            markdown_files->count--;
+            ofd_release_markdown_files(markdown_files, *markdown_files_are_mapped);
+            return ofd_false;
         }
+        
+        ofd_end_file_trace_span("Load file", span_start, markdown_filepaths[file_index], markdown_data->count);
     }
-    // Load markdown files. END
-    
     
-    
-    Ofd_Theme default_theme = {
+    return ofd_true;
+}
+
+ofd_static ofd_b8 ofd_load_theme(char* theme_filepath, Ofd_Theme* result)
+{ // Without a theme file, result is the default theme.
+    Ofd_Theme theme = {
         {0.06f, 0.08f, 0.1f, 1},      // Background colour.
         {0.8f,  0.8f,  0.8f, 1},      // Text colour.
         {0.6f,  0.8f,  1,    0.15f},  // Code block background colour.
@@ -5298,31 +9566,145 @@ ofd_static ofd_b8 ofd_generate_documentation(char** markdown_filepaths, int num_
         {1,    1,     1,    1},    // Directive colour.
     };
     
-    if(theme_filepath)
+    *result = theme;
+    if(!theme_filepath) return ofd_true;
+    
+    
+    // Parse theme file. START
+    ofd_f64 span_start = ofd_begin_trace_span();
+    
+    Ofd_String theme_data; // Read rather than mapped, ofd_update_documentation() loads it while it may be edited.
+    if(!ofd_read_whole_file(theme_filepath, &theme_data)) return ofd_false;
+    
+    char error_message[512];
+    ofd_b8 status = ofd_parse_theme_data(theme_data.data, theme_data.count, result, error_message);
+    ofd_end_file_trace_span("Load theme", span_start, theme_filepath, theme_data.count);
+    
+    ofd_release_whole_file(&theme_data, ofd_false);
+    
+    if(!status) ofd_printf("Failed to parse theme file '%s' with the following error:\n%s\n\n", theme_filepath, error_message);
+    // Parse theme file. END
+    
+    return status;
+}
+
+ofd_static ofd_b8 ofd_generate_documentation(char** markdown_filepaths, int num_markdown_files, char* output_filepath, char* theme_filepath, char* logo_path, char* icon_path, char* title)
+{
+    ofd_begin_phase();
+    
+    Ofd_Array markdown_files;
+    ofd_b8* markdown_files_are_mapped;
+    if(!ofd_load_markdown_files(markdown_filepaths, num_markdown_files, ofd_true, &markdown_files, &markdown_files_are_mapped)) return ofd_false;
+    
+    Ofd_Theme theme;
+    if(!ofd_load_theme(theme_filepath, &theme))
+    {
+        ofd_release_markdown_files(&markdown_files, markdown_files_are_mapped);
+        return ofd_false;
+    }
+    
+    Ofd_Writer writer; // The HTML goes to the output file as it is generated.
+    if(!ofd_writer_init_with_file_replacement(&writer, output_filepath))
+    {
+        ofd_close_writer(&writer);
+        ofd_release_markdown_files(&markdown_files, markdown_files_are_mapped);
+        return ofd_false;
+    }
+    
+    ofd_end_phase(OFD_STATS_PHASE_LOAD);
+    
+    Ofd_Array log_data;
+    ofd_generate_documentation_to_writer(ofd_cast(markdown_files.data, Ofd_String*), markdown_filepaths, markdown_files.count, &writer, theme, logo_path, icon_path, title, &log_data);
+    if(log_data.count > 1) ofd_printf("\n%s", log_data.data);
+    
+    ofd_begin_phase();
+    ofd_b8 status = ofd_close_writer(&writer);
+    ofd_end_phase(OFD_STATS_PHASE_WRITE);
+    if(!status) ofd_printf("Failed to correctly write file '%s'.\n", output_filepath);
+    
+    ofd_free_array(&log_data);
+    ofd_release_markdown_files(&markdown_files, markdown_files_are_mapped);
+    
+    return status;
+}
+
+ofd_static ofd_b8 ofd_theme_changes_body(Ofd_Theme old_theme, Ofd_Theme new_theme)
+{ // See what ofd_write_documentation_body() uses of the theme.
+    return (ofd_memcmp(&old_theme.text_colour,       &new_theme.text_colour,       sizeof(Ofd_Colour)) != 0 ||
+            ofd_memcmp(&old_theme.background_colour, &new_theme.background_colour, sizeof(Ofd_Colour)) != 0 ||
+            old_theme.font_size != new_theme.font_size);
+}
+
+ofd_static ofd_b8 ofd_update_documentation(Ofd_Documentation* documentation, char** markdown_filepaths, int num_markdown_files, char* output_filepath, char* theme_filepath, char* logo_path, char* icon_path, char* title, ofd_b8 files_changed)
+{
+    ofd_begin_phase();
+    
+    Ofd_Theme theme;
+    if(!ofd_load_theme(theme_filepath, &theme)) return ofd_false;
+    
+    ofd_b8 body_is_outdated = (files_changed || !documentation->has_body || ofd_theme_changes_body(documentation->body_theme, theme));
+    
+    Ofd_Array markdown_files;
+    ofd_b8* markdown_files_are_mapped;
+    if(body_is_outdated && !ofd_load_markdown_files(markdown_filepaths, num_markdown_files, ofd_false, &markdown_files, &markdown_files_are_mapped)) return ofd_false; // They are being edited.
+    
+    ofd_end_phase(OFD_STATS_PHASE_LOAD);
+    
+    
+    Ofd_Writer writer;
+    
+    ofd_free_array(&documentation->head);
+    ofd_array_init(&documentation->head, 1);
+    ofd_writer_init_with_array(&writer, &documentation->head);
+    ofd_write_documentation_head(&writer, theme, icon_path, title);
+    ofd_close_writer(&writer);
+    
+    if(body_is_outdated)
     {
-        // Parse theme file. START
-        Ofd_String theme_data;
-        if(!ofd_read_whole_file(theme_filepath, &theme_data)) OFD_GEN_DOCS_RETURN(ofd_false);
+        ofd_begin_cache_run(&ofd_highlight_cache);
+        ofd_begin_cache_run(&ofd_file_cache);
         
-        char error_message[512];
-        ofd_b8 status = ofd_parse_theme_data(theme_data.data, theme_data.count, &default_theme, error_message);
-        ofd_free(theme_data.data);
+        ofd_free_array(&documentation->body);
+        ofd_array_init(&documentation->body, 1);
+        ofd_writer_init_with_array(&writer, &documentation->body);
         
-        if(!status)
-        {
-            ofd_printf("Failed to parse theme file '%s' with the following error:\n%s\n\n", theme_filepath, error_message);
-            OFD_GEN_DOCS_RETURN(ofd_false);
-        }
-        // Parse theme file. END
+        Ofd_Array log_data;
+        ofd_write_documentation_body(ofd_cast(markdown_files.data, Ofd_String*), markdown_filepaths, markdown_files.count, &writer, theme, logo_path, &log_data);
+        ofd_close_writer(&writer);
+        if(log_data.count > 1) ofd_printf("\n%s", log_data.data);
+        
+        ofd_free_array(&log_data);
+        ofd_release_markdown_files(&markdown_files, markdown_files_are_mapped);
+        
+        documentation->body_theme = theme;
+        documentation->has_body   = ofd_true;
     }
     
     
-    ofd_generate_documentation_from_memory(ofd_cast(markdown_files.data, Ofd_String*), markdown_filepaths, markdown_files.count, &html, default_theme, logo_path, icon_path, title, &log_data);
-    if(log_data.count > 1) ofd_printf("\n%s", log_data.data);
+    ofd_begin_phase();
+    
+    ofd_b8 status = ofd_writer_init_with_file_replacement(&writer, output_filepath);
+    ofd_writer_add(&writer, documentation->head.data, documentation->head.count);
+    ofd_writer_add(&writer, documentation->body.data, documentation->body.count);
     
-    ofd_b8 status = ofd_write_whole_file(output_filepath, html.data, html.count);
+    if(!ofd_close_writer(&writer) && status)
+    {
+        ofd_printf("Failed to correctly write file '%s'.\n", output_filepath);
+        status = ofd_false;
+    }
+    
+    if(ofd_stats) ofd_stats->output_bytes += writer.num_bytes;
+    ofd_end_phase(OFD_STATS_PHASE_WRITE);
+    
+    return status;
+}
+
+ofd_static void ofd_free_documentation(Ofd_Documentation* documentation)
+{
+    ofd_free_array(&documentation->head);
+    ofd_free_array(&documentation->body);
     
-    OFD_GEN_DOCS_RETURN(status);
+    documentation->has_body = ofd_false;
 }
 #endif // OFD_NO_FILE_IO
 